@@ -0,0 +1,164 @@
+// job_queue.cpp
+#include "job_queue.h"
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+static const int      JOB_WORKERS      = 2;      // jeden na každé jádro
+static const uint32_t JOB_WORKER_STACK = 8192;   // B, PassInfo + zásobník SGP4 (elementy jsou sdílené)
+static const UBaseType_t JOB_WORKER_PRIO = 1;    // jako loop()
+static const uint32_t JOB_YIELD_MS     = 100;    // nechat běžet IDLE (task WDT)
+
+static JobFn             s_fn    = nullptr;
+static void*             s_ctx   = nullptr;
+static int               s_count = 0;
+static std::atomic<int>  s_next(0);
+static TaskHandle_t      s_workers[JOB_WORKERS];
+static SemaphoreHandle_t s_done  = nullptr;
+static bool              s_ready = false;
+static bool              s_failed = false;   // start selhal, dál jen inline
+
+static void drainJobs(){
+  uint32_t lastYield=millis();
+  int i;
+  while((i=s_next.fetch_add(1))<s_count){
+    s_fn(s_ctx,i);
+    if(millis()-lastYield>JOB_YIELD_MS){ vTaskDelay(1); lastYield=millis(); }
+  }
+}
+
+static void jobWorkerTask(void*){
+  for(;;){
+    ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+    drainJobs();
+    xSemaphoreGive(s_done);
+  }
+}
+
+static bool startWorkers(){
+  s_done=xSemaphoreCreateCounting(JOB_WORKERS,0);
+  if(!s_done) return false;
+  for(int w=0;w<JOB_WORKERS;w++){
+    char name[12]; snprintf(name,sizeof(name),"jobs%d",w);
+    if(xTaskCreatePinnedToCore(jobWorkerTask,name,JOB_WORKER_STACK,nullptr,
+                               JOB_WORKER_PRIO,&s_workers[w],w)!=pdPASS){
+      // uklidit: už vytvořené tasky čekají na notifikaci, nic nedrží
+      for(int k=0;k<w;k++){ vTaskDelete(s_workers[k]); s_workers[k]=nullptr; }
+      vSemaphoreDelete(s_done);
+      s_done=nullptr;
+      return false;
+    }
+  }
+  return true;
+}
+
+void runJobs(JobFn fn, void* ctx, int jobCount){
+  if(jobCount<=0) return;
+  if(!s_ready && !s_failed){
+    s_ready=startWorkers();
+    s_failed=!s_ready;
+    if(s_failed) Serial.println("[JOBS] worker start failed, running inline");
+  }
+
+  s_fn=fn; s_ctx=ctx; s_count=jobCount; s_next.store(0);
+
+  if(!s_ready){ drainJobs(); return; }
+
+  for(int w=0;w<JOB_WORKERS;w++) xTaskNotifyGive(s_workers[w]);
+  for(int w=0;w<JOB_WORKERS;w++) xSemaphoreTake(s_done,portMAX_DELAY);
+}
+
+int  jobWorkerCount(){ return JOB_WORKERS; }
+void setJobWorkerCount(int){}
+
+#else  // native
+
+// Persistent pool: threads are started on the first runJobs() (or after the
+// worker count changes) and sleep on a condition variable between runs, so
+// host tools can call runJobs() per batch without thread start-up costs.
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <stdlib.h>
+
+static int                      s_workerCount = 0;   // 0 = hardware concurrency
+static std::vector<std::thread> s_pool;
+static std::mutex               s_mutex;
+static std::condition_variable  s_wake, s_idle;
+static JobFn                    s_fn    = nullptr;
+static void*                    s_ctx   = nullptr;
+static int                      s_count = 0;
+static std::atomic<int>         s_next(0);
+static unsigned                 s_gen   = 0;   // číslo běhu, budí workery
+static int                      s_busy  = 0;   // workery v aktuálním běhu
+static bool                     s_stop  = false;
+
+int jobWorkerCount(){
+  if(s_workerCount>0) return s_workerCount;
+  unsigned n=std::thread::hardware_concurrency();
+  return n>0 ? (int)n : 2;
+}
+
+// seen = s_gen when the worker was created (before the run that starts it
+// increments it), so a restarted pool does not take an old run for new
+static void jobWorker(unsigned seen){
+  for(;;){
+    {
+      std::unique_lock<std::mutex> lk(s_mutex);
+      s_wake.wait(lk,[&]{ return s_stop || s_gen!=seen; });
+      if(s_stop) return;
+      seen=s_gen;
+    }
+    int i;
+    while((i=s_next.fetch_add(1))<s_count) s_fn(s_ctx,i);
+    std::lock_guard<std::mutex> lk(s_mutex);
+    if(--s_busy==0) s_idle.notify_all();
+  }
+}
+
+static void stopWorkers(){
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+    s_stop=true;
+  }
+  s_wake.notify_all();
+  for(auto &t:s_pool) t.join();
+  s_pool.clear();
+  s_stop=false;
+}
+
+void setJobWorkerCount(int n){
+  if(n==s_workerCount) return;
+  stopWorkers();
+  s_workerCount=n;
+}
+
+void runJobs(JobFn fn, void* ctx, int jobCount){
+  if(jobCount<=0) return;
+  if(s_pool.empty()){
+    static bool atExit=false;
+    if(!atExit){ atexit(stopWorkers); atExit=true; }
+    int workers=jobWorkerCount();
+    unsigned gen;
+    {
+      std::lock_guard<std::mutex> lk(s_mutex);
+      gen=s_gen;
+    }
+    for(int w=0;w<workers;w++) s_pool.emplace_back(jobWorker,gen);
+  }
+
+  std::unique_lock<std::mutex> lk(s_mutex);
+  s_fn=fn; s_ctx=ctx; s_count=jobCount; s_next.store(0);
+  s_busy=(int)s_pool.size();
+  s_gen++;
+  s_wake.notify_all();
+  s_idle.wait(lk,[]{ return s_busy==0; });
+}
+
+#endif
@@ -0,0 +1,18 @@
+// job_queue.h
+// Runs a list of independent jobs on all CPU cores. Workers pull job indices
+// from one shared atomic counter until the list is empty, so a slow job only
+// delays its own worker. ESP32: two FreeRTOS tasks pinned to core 0 and 1;
+// other targets (native build): a persistent std::thread pool.
+#pragma once
+#include <stdint.h>
+
+typedef void (*JobFn)(void* ctx, int jobIdx);
+
+// Runs fn(ctx,0..jobCount-1) and returns when all jobs have finished.
+// The calling task only waits; it does not run jobs itself.
+void runJobs(JobFn fn, void* ctx, int jobCount);
+
+int  jobWorkerCount();
+// native build only: number of pool threads for the following runJobs() calls
+// (0 = hardware concurrency)
+void setJobWorkerCount(int n);
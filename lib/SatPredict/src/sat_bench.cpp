@@ -0,0 +1,1096 @@
+// sat_bench.cpp
+#include "sat_bench.h"
+#include "job_queue.h"
+#include "sgp4_batch.h"
+#include "sat_track.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#include <xtensa/hal.h>
+
+double   benchNowUs(){ return (double)esp_timer_get_time(); }
+uint32_t benchCycles(){ return xthal_get_ccount(); }
+static const char* BENCH_TARGET = "esp32";
+#else
+#include <chrono>
+
+double benchNowUs(){
+  using namespace std::chrono;
+  return duration<double,std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+uint32_t benchCycles(){ return 0; }
+static const char* BENCH_TARGET = "native";
+#endif
+
+static const int BENCH_SAT_COUNTS[] = {1,4,12,128};
+static const int BENCH_REFINE_SATS  = 12;   // zdroj průletů pro refine/track
+
+void benchDefaults(BenchConfig &cfg, bool quick){
+  cfg.findsatCalls=quick?2000:20000;
+  cfg.hours=quick?6:24;
+  cfg.prefilter=true;
+  cfg.minElDeg=10.0f;
+  cfg.latDeg=49.7501; cfg.lonDeg=13.38; cfg.altM=310.0;
+  cfg.tleL1=nullptr; cfg.tleL2=nullptr; cfg.tleCount=0;
+}
+
+// Satellite i of the run. Synthetic sets are LEO orbits with spread
+// inclination, node, phase and mean motion, so 128 of them give a mix of
+// pass geometries similar to a real amateur catalog.
+static void benchTle(const BenchConfig &cfg, int i, char* name, char* l1, char* l2){
+  snprintf(name,12,"B%03d",i);
+  if(cfg.tleCount>0){
+    int k=i%cfg.tleCount;
+    strncpy(l1,cfg.tleL1[k],TLE_LINE_MAX-1); l1[TLE_LINE_MAX-1]='\0';
+    strncpy(l2,cfg.tleL2[k],TLE_LINE_MAX-1); l2[TLE_LINE_MAX-1]='\0';
+    return;
+  }
+  double inc=45+(i*7)%55, raan=(i*37)%360, ma=(i*53)%360, n=13.2+(i%23)*0.1;
+  snprintf(l1,TLE_LINE_MAX,"1 %05dU 98067A   25320.50000000  .00001000  00000-0  10000-3 0  9990",40000+i);
+  snprintf(l2,TLE_LINE_MAX,"2 %05d %8.4f %8.4f 0010000 %8.4f %8.4f %11.8f 99990",40000+i,inc,raan,90.0,ma,n);
+}
+
+// pevný start: epocha prvního TLE + 12 h, výsledky nezávisí na hodinách
+static time_t benchStart(const BenchConfig &cfg){
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  return (time_t)tleEpochUtc(l1)+12*3600;
+}
+
+static BenchResult& benchAdd(BenchResult* out, int &n, const char* name, int sats){
+  BenchResult &r=out[n++];
+  memset(&r,0,sizeof(r));
+  snprintf(r.name,sizeof(r.name),"%s",name);
+  r.sats=sats;
+  return r;
+}
+
+// ---- findsat ----
+static void benchFindsat(const BenchConfig &cfg, time_t start, BenchResult &r){
+  static Sgp4 sat;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  sat.site(cfg.latDeg,cfg.lonDeg,cfg.altM);
+  initSgp4(sat,name,l1,l2);
+
+  const double jd0=start/86400.0+2440587.5;
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    uint32_t c0=benchCycles();
+    sat.findsat(jd0+i*(10.0/86400.0));
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=cfg.findsatCalls;
+  r.sgp4Calls=cfg.findsatCalls;
+}
+
+// ---- sgp4_library, sgp4_propagate ----
+// Position and velocity at the findsat times: the library's sgp4() on the
+// satrec it updates, and sgp4Propagate() from read-only elements.
+static void benchSgp4Library(const BenchConfig &cfg, time_t start, BenchResult &r){
+  static Sgp4 sat;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  initSgp4(sat,name,l1,l2);
+
+  const double tsince0=(start/86400.0+2440587.5-sat.satrec.jdsatepoch)*1440.0;
+  volatile double sink=0;
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    uint32_t c0=benchCycles();
+    double rd[3], vd[3];
+    sgp4(wgs72,sat.satrec,tsince0+i*(10.0/60.0),rd,vd);
+    sink=sink+rd[0]+vd[0];
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=cfg.findsatCalls;
+  r.sgp4Calls=cfg.findsatCalls;
+}
+
+template<typename T>
+static void benchSgp4Propagate(const BenchConfig &cfg, time_t start, BenchResult &r){
+  static Sgp4Elements el;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  if(!sgp4ElementsFromTle(el,l1,l2)) return;
+
+  const double tsince0=(start/86400.0+2440587.5-el.rec.jdsatepoch)*1440.0;
+  volatile T sink=0;
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    uint32_t c0=benchCycles();
+    Sgp4State<T> st=sgp4Propagate<T>(el,tsince0+i*(10.0/60.0));
+    sink=sink+st.r[0]+st.v[0];
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=cfg.findsatCalls;
+  r.sgp4Calls=cfg.findsatCalls;
+}
+
+// ---- sgp4_propagate_deep, sgp4_propagate_deep_seq ----
+// Deep space with 12 h resonance (Molnija 08195 of the Vallado set) a week
+// from epoch, at the findsat step: without a cursor every call integrates
+// the resonance from epoch (14 steps of 720 min), with an Sgp4Resonance
+// it continues from the previous call.
+static const char* const BENCH_DEEP_L1 =
+  "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813";
+static const char* const BENCH_DEEP_L2 =
+  "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656";
+
+static void benchSgp4Deep(const BenchConfig &cfg, bool cursor, BenchResult &r){
+  static Sgp4Elements el;
+  if(!sgp4ElementsFromTle(el,BENCH_DEEP_L1,BENCH_DEEP_L2)) return;
+
+  const double tsince0=7.0*1440.0;
+  Sgp4Resonance res={0.0,0.0,0.0};
+  volatile double sink=0;
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    uint32_t c0=benchCycles();
+    Sgp4State<double> st=sgp4Propagate<double>(el,tsince0+i*(10.0/60.0),cursor?&res:nullptr);
+    sink=sink+st.r[0]+st.v[0];
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=cfg.findsatCalls;
+  r.sgp4Calls=cfg.findsatCalls;
+}
+
+// ---- sat_state ----
+// The live display's sample: az/el/range at the same times as findsat, and
+// with withVis the on-demand illumination from a shared SunCache on top.
+static void benchSatState(const BenchConfig &cfg, time_t start, bool withVis, BenchResult &r){
+  static Sgp4Elements sat;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  if(!sgp4ElementsFromTle(sat,l1,l2)) return;
+  SiteFrame site;
+  initSiteFrame(site,cfg.latDeg,cfg.lonDeg,cfg.altM);
+  SunCache sun;
+  sunCacheReset(sun);
+
+  volatile int visSum=0;
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    uint32_t c0=benchCycles();
+    SatState s{};
+    double t=(double)start+i*10.0;
+    r.sgp4Calls+=propagateSeries<double>(sat,site,t,0.0,1,&s.az,&s.el,&s.distKm);
+    if(withVis){
+      visSum+=satVisibility(sat,site,sun,t,s.el);
+      if(s.el>=0.0f) r.sgp4Calls++;
+    }
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=cfg.findsatCalls;
+}
+
+// ---- propagate_series ----
+// The same samples as findsat through the batch kernel, in runs of
+// BENCH_SERIES_RUN (one pass track), in double and in float.
+static const int BENCH_SERIES_RUN = 120;
+
+template<typename T>
+static void benchSeries(const BenchConfig &cfg, time_t start, BenchResult &r){
+  static Sgp4Elements sat;
+  static float az[BENCH_SERIES_RUN], el[BENCH_SERIES_RUN], rng[BENCH_SERIES_RUN];
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  if(!sgp4ElementsFromTle(sat,l1,l2)) return;
+  SiteFrame site;
+  initSiteFrame(site,cfg.latDeg,cfg.lonDeg,cfg.altM);
+
+  double t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i+=BENCH_SERIES_RUN){
+    int n=cfg.findsatCalls-i<BENCH_SERIES_RUN?cfg.findsatCalls-i:BENCH_SERIES_RUN;
+    uint32_t c0=benchCycles();
+    r.sgp4Calls+=propagateSeries<T>(sat,site,(double)start+i*10.0,10.0,n,az,el,rng);
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=r.sgp4Calls;
+}
+
+// ---- ephem_fit, ephem_state ----
+// Chebyshev ephemeris of satellite 0 over the window (fit cost per
+// segment), then the sat_state samples evaluated from it.
+static const int BENCH_EPHEM_SEGS = 256;
+
+static void benchEphem(const BenchConfig &cfg, time_t start, BenchResult &fit, BenchResult &state){
+  static Sgp4Elements sat;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,0,name,l1,l2);
+  if(!sgp4ElementsFromTle(sat,l1,l2)) return;
+  SiteFrame site;
+  initSiteFrame(site,cfg.latDeg,cfg.lonDeg,cfg.altM);
+  ChebSeg* seg=(ChebSeg*)malloc(BENCH_EPHEM_SEGS*sizeof(ChebSeg));
+  if(!seg) return;
+
+  ChebEphem e;
+  double t0=benchNowUs();
+  uint32_t c0=benchCycles();
+  chebFit(e,sat,(double)start,(double)start+cfg.hours*3600.0,seg,BENCH_EPHEM_SEGS);
+  fit.cycles+=(uint32_t)(benchCycles()-c0);
+  fit.us=benchNowUs()-t0;
+  fit.ops=e.segCount;
+  fit.sgp4Calls=e.fitCalls;
+
+  t0=benchNowUs();
+  for(int i=0;i<cfg.findsatCalls;i++){
+    c0=benchCycles();
+    SatState s{};
+    double t=(double)start+(i*10)%(cfg.hours*3600);
+    ephemSeries<double>(e,site,t,0.0,1,&s.az,&s.el,&s.distKm);
+    state.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  state.us=benchNowUs()-t0;
+  state.ops=cfg.findsatCalls;
+  free(seg);
+}
+
+// ---- catalog_state, catalog_soa, catalog_simd ----
+// Az/el/range of a whole catalog at one time, step after step: one
+// computeSatellite()-style propagateSeries() per satellite, then the
+// struct-of-arrays batch (sgp4_batch.h) with scalar lanes and with the best
+// ISA of the CPU, in double and float. Orbits the batch does not take
+// (deep space) go through propagateSeries() inside the batch timing too.
+#if defined(ARDUINO_ARCH_ESP32)
+static const int BENCH_CATALOG_SATS = 16;
+#else
+static const int BENCH_CATALOG_SATS = 128;
+#endif
+
+struct BenchCatalog {
+  Sgp4Elements* sats;  // [BENCH_CATALOG_SATS]
+  Sgp4Batch batch;
+  int       rest[BENCH_CATALOG_SATS];   // mimo dávku
+  int       restCount;
+  float     *az, *el, *rng;
+  uint8_t*  err;
+};
+
+static bool benchCatalogInit(const BenchConfig &cfg, BenchCatalog &c){
+  memset(&c,0,sizeof(c));
+  c.sats=new Sgp4Elements[BENCH_CATALOG_SATS];
+  c.az=(float*)malloc(BENCH_CATALOG_SATS*sizeof(float));
+  c.el=(float*)malloc(BENCH_CATALOG_SATS*sizeof(float));
+  c.rng=(float*)malloc(BENCH_CATALOG_SATS*sizeof(float));
+  c.err=(uint8_t*)malloc(BENCH_CATALOG_SATS);
+  bool ok=c.az && c.el && c.rng && c.err && sgp4BatchInit(c.batch,BENCH_CATALOG_SATS);
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  for(int i=0;ok && i<BENCH_CATALOG_SATS;i++){
+    benchTle(cfg,i,name,l1,l2);
+    if(!sgp4ElementsFromTle(c.sats[i],l1,l2) || sgp4BatchAdd(c.batch,c.sats[i])<0)
+      c.rest[c.restCount++]=i;
+  }
+  return ok;
+}
+
+static void benchCatalogFree(BenchCatalog &c){
+  delete[] c.sats;
+  sgp4BatchFree(c.batch);
+  free(c.az); free(c.el); free(c.rng); free(c.err);
+}
+
+// isa 0xff = per-satellite path
+template<typename T>
+static void benchCatalogRun(const BenchConfig &cfg, BenchCatalog &c, time_t start, uint8_t isa,
+                            BenchResult &r){
+  SiteFrame site;
+  initSiteFrame(site,cfg.latDeg,cfg.lonDeg,cfg.altM);
+  const int steps=cfg.findsatCalls/50;
+  c.batch.isa=isa;
+  double t0=benchNowUs();
+  for(int k=0;k<steps;k++){
+    const double t=(double)start+k*10.0;
+    uint32_t c0=benchCycles();
+    if(isa==0xff){
+      for(int i=0;i<BENCH_CATALOG_SATS;i++)
+        r.sgp4Calls+=propagateSeries<double>(c.sats[i],site,t,0.0,1,c.az+i,c.el+i,c.rng+i);
+    } else {
+      sgp4BatchLook<T>(c.batch,site,t,c.az,c.el,c.rng,c.err);
+      r.sgp4Calls+=c.batch.count;
+      for(int j=0;j<c.restCount;j++){
+        int i=c.rest[j];
+        r.sgp4Calls+=propagateSeries<double>(c.sats[i],site,t,0.0,1,c.az+i,c.el+i,c.rng+i);
+      }
+    }
+    r.cycles+=(uint32_t)(benchCycles()-c0);
+  }
+  r.us=benchNowUs()-t0;
+  r.ops=steps*BENCH_CATALOG_SATS;
+}
+
+static void benchCatalog(const BenchConfig &cfg, time_t start, BenchResult* out, int &n){
+  BenchCatalog c;
+  if(!benchCatalogInit(cfg,c)){ benchCatalogFree(c); return; }
+  const uint8_t best=sgp4BatchBestIsa();
+  benchCatalogRun<double>(cfg,c,start,0xff,benchAdd(out,n,"catalog_state",BENCH_CATALOG_SATS));
+  benchCatalogRun<double>(cfg,c,start,SGP4_ISA_SCALAR,benchAdd(out,n,"catalog_soa",BENCH_CATALOG_SATS));
+  benchCatalogRun<double>(cfg,c,start,best,benchAdd(out,n,"catalog_simd",BENCH_CATALOG_SATS));
+  benchCatalogRun<float>(cfg,c,start,best,benchAdd(out,n,"catalog_simd_f32",BENCH_CATALOG_SATS));
+  benchCatalogFree(c);
+}
+
+// ---- predict_passes ----
+struct BenchPredict {
+  const BenchConfig* cfg;
+  time_t    start;
+  int       outMax;
+  uint32_t* passes;   // [sats]
+  uint32_t* calls;    // [sats]
+};
+
+static void benchPredictJob(void* ctx, int jobIdx){
+  BenchPredict &b=*(BenchPredict*)ctx;
+  const BenchConfig &cfg=*b.cfg;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  benchTle(cfg,jobIdx,name,l1,l2);
+
+  PassInfo* buf=(PassInfo*)malloc(b.outMax*sizeof(PassInfo));
+  if(!buf) return;
+  Sgp4Elements sat;
+  PassSearch ps;
+  if(!sgp4ElementsFromTle(sat,l1,l2)){ free(buf); return; }
+  initPassSearch(ps,sat,l1,l2,(uint8_t)jobIdx,cfg.minElDeg,cfg.latDeg,cfg.lonDeg,
+                 cfg.altM,cfg.prefilter,b.start);
+  ps.out=buf;
+  ps.outMax=b.outMax;
+  b.passes[jobIdx]=searchSatWindow(ps,b.start-PASS_LOOKBACK,b.start+(time_t)cfg.hours*3600);
+  b.calls[jobIdx]=ps.searchCalls+ps.refineEvals;
+  free(buf);
+}
+
+static bool benchPredict(const BenchConfig &cfg, time_t start, int sats, BenchResult &r){
+  BenchPredict b;
+  b.cfg=&cfg;
+  b.start=start;
+  b.outMax=(int)((cfg.hours*3600+PASS_LOOKBACK)/PASS_JOB_CHUNK+2)*PASS_JOB_MAX;
+  b.passes=(uint32_t*)calloc(sats,sizeof(uint32_t));
+  b.calls=(uint32_t*)calloc(sats,sizeof(uint32_t));
+  if(!b.passes||!b.calls){ free(b.passes); free(b.calls); return false; }
+
+  double t0=benchNowUs();
+  runJobs(benchPredictJob,&b,sats);
+  r.us=benchNowUs()-t0;
+  for(int i=0;i<sats;i++){ r.ops+=b.passes[i]; r.sgp4Calls+=b.calls[i]; }
+
+  free(b.passes); free(b.calls);
+  return true;
+}
+
+// ---- refine_pass_max, pass_track ----
+// Passes of the first satellites are found untimed, then each one is
+// refined again from its coarse (in-pass step) maximum and sampled for the
+// radar trail; only those two calls are timed.
+static void benchRefineTrack(const BenchConfig &cfg, time_t start,
+                             BenchResult &refine, BenchResult &track){
+  static PassSearch   ps;
+  static Sgp4Elements sat;
+  static PassInfo     passes[BENCH_PASS_MAX];
+  static float        trackAz[BENCH_TRACK_LEN], trackEl[BENCH_TRACK_LEN];
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+
+  for(int si=0;si<BENCH_REFINE_SATS && (int)refine.ops<BENCH_PASS_MAX;si++){
+    benchTle(cfg,si,name,l1,l2);
+    if(!sgp4ElementsFromTle(sat,l1,l2)) continue;
+    initPassSearch(ps,sat,l1,l2,(uint8_t)si,cfg.minElDeg,cfg.latDeg,cfg.lonDeg,
+                   cfg.altM,cfg.prefilter,start);
+    ps.out=passes;
+    ps.outMax=BENCH_PASS_MAX-(int)refine.ops;
+    int n=searchSatWindow(ps,start-PASS_LOOKBACK,start+(time_t)cfg.hours*3600);
+
+    for(int k=0;k<n;k++){
+      PassInfo q=passes[k];
+      time_t stepIn=(time_t)PASS_STEP_IN_PASS;
+      q.tMax=q.aos+((q.tMax-q.aos)/stepIn)*stepIn;
+
+      double t0=benchNowUs();
+      uint32_t c0=benchCycles();
+      int evals=refinePassMax(ps,q);
+      refine.cycles+=(uint32_t)(benchCycles()-c0);
+      refine.us+=benchNowUs()-t0;
+      refine.ops++;
+      refine.sgp4Calls+=evals;
+
+      t0=benchNowUs();
+      c0=benchCycles();
+      int m=samplePassTrack(sat,ps.site,passes[k].aos,passes[k].los,trackAz,trackEl,BENCH_TRACK_LEN);
+      track.cycles+=(uint32_t)(benchCycles()-c0);
+      track.us+=benchNowUs()-t0;
+      track.ops++;
+      track.sgp4Calls+=m;
+    }
+  }
+}
+
+// ---- track_direct, track_interp ----
+// Live tracking at BENCH_TRACK_HZ through the passes of the first
+// satellites: trackLook() (one SGP4 per sample) and trackAt() (SGP4 only
+// per anchor, Hermite between). ops = samples, sgp4_calls = anchors.
+static const int BENCH_TRACK_HZ = 10;
+#if defined(ARDUINO_ARCH_ESP32)
+static const int BENCH_TRACK_PASSES = 2;
+#else
+static const int BENCH_TRACK_PASSES = 16;
+#endif
+
+static void benchRateTrack(const BenchConfig &cfg, time_t start, BenchResult &direct,
+                           BenchResult &interp){
+  static PassSearch   ps;
+  static PassInfo     passes[BENCH_TRACK_PASSES];
+  static Sgp4Elements el;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  int done=0;
+
+  for(int si=0;si<BENCH_REFINE_SATS && done<BENCH_TRACK_PASSES;si++){
+    benchTle(cfg,si,name,l1,l2);
+    if(!sgp4ElementsFromTle(el,l1,l2)) continue;
+    initPassSearch(ps,el,l1,l2,(uint8_t)si,cfg.minElDeg,cfg.latDeg,cfg.lonDeg,
+                   cfg.altM,cfg.prefilter,start);
+    ps.out=passes;
+    ps.outMax=BENCH_TRACK_PASSES-done;
+    int n=searchSatWindow(ps,start-PASS_LOOKBACK,start+(time_t)cfg.hours*3600);
+
+    for(int k=0;k<n;k++,done++){
+      const PassInfo &p=passes[k];
+      const int m=(int)(p.los-p.aos)*BENCH_TRACK_HZ;
+      volatile float sink=0;
+      TrackLook o;
+
+      double t0=benchNowUs();
+      uint32_t c0=benchCycles();
+      for(int i=0;i<m;i++)
+        if(trackLook(el,ps.site,p.aos+i/(double)BENCH_TRACK_HZ,o)) sink=sink+o.az;
+      direct.cycles+=(uint32_t)(benchCycles()-c0);
+      direct.us+=benchNowUs()-t0;
+      direct.ops+=m;
+      direct.sgp4Calls+=m;
+
+      TrackInterp tr;
+      trackBegin(tr,el,ps.site);
+      t0=benchNowUs();
+      c0=benchCycles();
+      for(int i=0;i<m;i++)
+        if(trackAt(tr,p.aos+i/(double)BENCH_TRACK_HZ,o)) sink=sink+o.az;
+      interp.cycles+=(uint32_t)(benchCycles()-c0);
+      interp.us+=benchNowUs()-t0;
+      interp.ops+=m;
+      interp.sgp4Calls+=tr.anchors;
+    }
+  }
+}
+
+// ---- elevation profiles ----
+// build: search at the horizon and sample every arc (ops = arcs); passes:
+// the same arcs re-thresholded at cfg.minElDeg (ops = arcs, no SGP4)
+static void benchProfile(const BenchConfig &cfg, time_t start, BenchResult &build,
+                         BenchResult &passes){
+  static PassSearch    ps;
+  static Sgp4Elements  sat;
+  static PassInfo      found[BENCH_PASS_MAX];
+  static ProfileArc    arcs[BENCH_PASS_MAX];
+  const int sampleMax=BENCH_PASS_MAX*PROFILE_ARC_SAMPLES;
+  ProfileSample* samples=(ProfileSample*)malloc(sampleMax*sizeof(ProfileSample));
+  if(!samples) return;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  const time_t from=start-PASS_LOOKBACK;
+  int nArc=0, used=0;
+
+  for(int si=0;si<BENCH_REFINE_SATS && nArc<BENCH_PASS_MAX;si++){
+    benchTle(cfg,si,name,l1,l2);
+    double t0=benchNowUs();
+    uint32_t c0=benchCycles();
+    if(!sgp4ElementsFromTle(sat,l1,l2)) continue;
+    initPassSearch(ps,sat,l1,l2,(uint8_t)si,PROFILE_BASE_EL_DEG,cfg.latDeg,cfg.lonDeg,
+                   cfg.altM,cfg.prefilter,start);
+    ps.out=found;
+    ps.outMax=BENCH_PASS_MAX-nArc;
+    int n=searchSatWindow(ps,from,start+(time_t)cfg.hours*3600);
+    uint32_t calls=ps.searchCalls+ps.refineEvals;
+    for(int k=0;k<n;k++){
+      ProfileArc &arc=arcs[nArc];
+      int m=sampleProfileArc(sat,ps.site,found[k],from,arc,samples+used,
+                             sampleMax-used,&calls);
+      if(m==0) continue;
+      arc.first=(uint16_t)used;
+      used+=m;
+      nArc++;
+    }
+    build.cycles+=(uint32_t)(benchCycles()-c0);
+    build.us+=benchNowUs()-t0;
+    build.sgp4Calls+=calls;
+  }
+  build.ops=nArc;
+
+  PassInfo p[PASS_JOB_MAX];
+  double t0=benchNowUs();
+  uint32_t c0=benchCycles();
+  for(int k=0;k<nArc;k++) profilePasses(arcs[k],samples,from,cfg.minElDeg,p,PASS_JOB_MAX);
+  passes.cycles=(uint32_t)(benchCycles()-c0);
+  passes.us=benchNowUs()-t0;
+  passes.ops=nArc;
+  free(samples);
+}
+
+int runBenchSuite(const BenchConfig &cfg, BenchResult* out, int outMax){
+  if(outMax<BENCH_MAX_RESULTS) return 0;
+  const time_t start=benchStart(cfg);
+  int n=0;
+
+  benchFindsat(cfg,start,benchAdd(out,n,"findsat",1));
+  benchSgp4Library(cfg,start,benchAdd(out,n,"sgp4_library",1));
+  benchSgp4Propagate<double>(cfg,start,benchAdd(out,n,"sgp4_propagate",1));
+  benchSgp4Propagate<float>(cfg,start,benchAdd(out,n,"sgp4_propagate_f32",1));
+  benchSgp4Deep(cfg,false,benchAdd(out,n,"sgp4_propagate_deep",1));
+  benchSgp4Deep(cfg,true,benchAdd(out,n,"sgp4_propagate_deep_seq",1));
+  benchSatState(cfg,start,false,benchAdd(out,n,"sat_state",1));
+  benchSatState(cfg,start,true,benchAdd(out,n,"sat_state_vis",1));
+  benchSeries<double>(cfg,start,benchAdd(out,n,"propagate_series",1));
+  benchSeries<float>(cfg,start,benchAdd(out,n,"propagate_series_f32",1));
+  BenchResult &fit=benchAdd(out,n,"ephem_fit",1);
+  benchEphem(cfg,start,fit,benchAdd(out,n,"ephem_state",1));
+  benchCatalog(cfg,start,out,n);
+
+  for(int sats:BENCH_SAT_COUNTS){
+    BenchResult &r=benchAdd(out,n,"predict_passes",sats);
+    if(!benchPredict(cfg,start,sats,r)) n--;
+  }
+
+  BenchResult &refine=benchAdd(out,n,"refine_pass_max",BENCH_REFINE_SATS);
+  BenchResult &track=benchAdd(out,n,"pass_track",BENCH_REFINE_SATS);
+  benchRefineTrack(cfg,start,refine,track);
+  BenchResult &direct=benchAdd(out,n,"track_direct",1);
+  benchRateTrack(cfg,start,direct,benchAdd(out,n,"track_interp",1));
+
+  BenchResult &build=benchAdd(out,n,"profile_build",BENCH_REFINE_SATS);
+  benchProfile(cfg,start,build,benchAdd(out,n,"profile_passes",BENCH_REFINE_SATS));
+  return n;
+}
+
+// ---- float vs double validation ----
+static float dirErrDeg(float az1, float el1, float az2, float el2){
+  const double d2r=M_PI/180.0;
+  double c=sin(el1*d2r)*sin(el2*d2r)+cos(el1*d2r)*cos(el2*d2r)*cos((az1-az2)*d2r);
+  if(c>1.0) c=1.0;
+  return (float)(acos(c)/d2r);
+}
+
+static int absDiff(time_t a, time_t b){ return (int)(a>b?a-b:b-a); }
+
+void runPrecisionCheck(const BenchConfig &cfg, int sats, PrecisionReport &rep){
+  static PassSearch ps;
+  static Sgp4Elements el;
+  static float azF[BENCH_SERIES_RUN], elF[BENCH_SERIES_RUN], rgF[BENCH_SERIES_RUN];
+  static float azD[BENCH_SERIES_RUN], elD[BENCH_SERIES_RUN], rgD[BENCH_SERIES_RUN];
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+
+  memset(&rep,0,sizeof(rep));
+  rep.sats=sats;
+  const time_t start=benchStart(cfg);
+  const time_t end=start+(time_t)cfg.hours*3600;
+  const int outMax=(int)((cfg.hours*3600+PASS_LOOKBACK)/PASS_JOB_CHUNK+2)*PASS_JOB_MAX;
+  PassInfo* pf=(PassInfo*)malloc(outMax*sizeof(PassInfo));
+  PassInfo* pd=(PassInfo*)malloc(outMax*sizeof(PassInfo));
+  if(!pf||!pd){ free(pf); free(pd); return; }
+
+  for(int si=0;si<sats;si++){
+    benchTle(cfg,si,name,l1,l2);
+    if(!sgp4ElementsFromTle(el,l1,l2)) continue;
+    initPassSearch(ps,el,l1,l2,(uint8_t)si,cfg.minElDeg,cfg.latDeg,cfg.lonDeg,
+                   cfg.altM,cfg.prefilter,start);
+
+    // vzorky po 10 s přes celé okno
+    for(time_t t=start;t<end;t+=BENCH_SERIES_RUN*10){
+      int nf=propagateSeries<float>(el,ps.site,(double)t,10.0,BENCH_SERIES_RUN,azF,elF,rgF);
+      int nd=propagateSeries<double>(el,ps.site,(double)t,10.0,BENCH_SERIES_RUN,azD,elD,rgD);
+      int n=nf<nd?nf:nd;
+      for(int i=0;i<n;i++){
+        if(elD[i]<0) continue;
+        rep.samples++;
+        float e=dirErrDeg(azF[i],elF[i],azD[i],elD[i]);
+        if(e>rep.maxDirErrDeg) rep.maxDirErrDeg=e;
+        float dr=fabsf(rgF[i]-rgD[i]);
+        if(dr>rep.maxRangeErrKm) rep.maxRangeErrKm=dr;
+      }
+    }
+
+    ps.out=pd; ps.outMax=outMax; ps.coarseF32=false;
+    int nd=searchSatWindow(ps,start-PASS_LOOKBACK,end);
+    ps.out=pf; ps.outMax=outMax; ps.coarseF32=true;
+    int nf=searchSatWindow(ps,start-PASS_LOOKBACK,end);
+    rep.passesF32+=nf;
+    rep.passesF64+=nd;
+
+    // sledování: první průlet po 0.1 s, interpolace vs přímo SGP4
+    if(nd>0){
+      TrackInterp tr;
+      trackBegin(tr,el,ps.site);
+      const int m=(int)(pd[0].los-pd[0].aos)*BENCH_TRACK_HZ;
+      for(int i=0;i<m;i++){
+        const double t=pd[0].aos+i/(double)BENCH_TRACK_HZ;
+        TrackLook o, d;
+        if(!trackAt(tr,t,o) || !trackLook(el,ps.site,t,d)) break;
+        rep.trackSamples++;
+        float e=dirErrDeg(o.az,o.el,d.az,d.el);
+        if(e>rep.maxTrackDirErrDeg) rep.maxTrackDirErrDeg=e;
+        float dr=fabsf(o.rangeKm-d.rangeKm);
+        if(dr>rep.maxTrackRangeErrKm) rep.maxTrackRangeErrKm=dr;
+        float dv=fabsf(o.rangeRate-d.rangeRate);
+        if(dv>rep.maxTrackRateErrKms) rep.maxTrackRateErrKms=dv;
+      }
+    }
+
+    // obě řady jsou seřazené podle AOS
+    int i=0, j=0;
+    while(i<nf || j<nd){
+      if(i<nf && j<nd && absDiff(pf[i].aos,pd[j].aos)<=60){
+        int da=absDiff(pf[i].aos,pd[j].aos), dl=absDiff(pf[i].los,pd[j].los);
+        int dm=absDiff(pf[i].tMax,pd[j].tMax);
+        float de=fabsf(pf[i].maxEl-pd[j].maxEl);
+        if(da>rep.maxAosErrS) rep.maxAosErrS=da;
+        if(dl>rep.maxLosErrS) rep.maxLosErrS=dl;
+        if(dm>rep.maxTmaxErrS) rep.maxTmaxErrS=dm;
+        if(de>rep.maxElErrDeg) rep.maxElErrDeg=de;
+        i++; j++;
+      } else {
+        rep.unmatched++;
+        if(j>=nd || (i<nf && pf[i].aos<pd[j].aos)) i++; else j++;
+      }
+    }
+  }
+  free(pf); free(pd);
+
+  // batch (best ISA) in double and float vs propagateSeries<double>, every
+  // 10 min over the window
+  BenchCatalog c;
+  if(benchCatalogInit(cfg,c)){
+    SiteFrame site;
+    initSiteFrame(site,cfg.latDeg,cfg.lonDeg,cfg.altM);
+    for(int prec=0;prec<2;prec++){
+      for(time_t t=start;t<end;t+=600){
+        if(prec) sgp4BatchLook<float>(c.batch,site,(double)t,c.az,c.el,c.rng,c.err);
+        else     sgp4BatchLook<double>(c.batch,site,(double)t,c.az,c.el,c.rng,c.err);
+        for(int i=0,lane=0;i<BENCH_CATALOG_SATS;i++){
+          bool batched=true;
+          for(int j=0;j<c.restCount;j++) if(c.rest[j]==i) batched=false;
+          if(!batched) continue;
+          float az, el, rg;
+          int ok=propagateSeries<double>(c.sats[i],site,(double)t,0.0,1,&az,&el,&rg);
+          const int k=lane++;
+          if((ok==1)!=(c.err[k]==0)){ rep.batchErrors++; continue; }
+          if(ok!=1 || el<0) continue;
+          rep.batchSamples++;
+          float e=dirErrDeg(c.az[k],c.el[k],az,el);
+          if(e>rep.maxBatchDirErrDeg) rep.maxBatchDirErrDeg=e;
+          float dr=fabsf(c.rng[k]-rg);
+          if(dr>rep.maxBatchRangeErrKm) rep.maxBatchRangeErrKm=dr;
+        }
+      }
+    }
+  }
+  benchCatalogFree(c);
+
+  rep.ok=rep.unmatched==0 && rep.maxDirErrDeg<=PREC_DIR_TOL_DEG &&
+         rep.maxRangeErrKm<=PREC_RANGE_TOL_KM && rep.maxAosErrS<=PREC_TIME_TOL_S &&
+         rep.maxLosErrS<=PREC_TIME_TOL_S && rep.maxTmaxErrS<=PREC_TIME_TOL_S &&
+         rep.maxElErrDeg<=PREC_EL_TOL_DEG && rep.batchErrors==0 &&
+         rep.maxBatchDirErrDeg<=PREC_DIR_TOL_DEG && rep.maxBatchRangeErrKm<=PREC_RANGE_TOL_KM &&
+         rep.maxTrackDirErrDeg<=PREC_DIR_TOL_DEG && rep.maxTrackRangeErrKm<=PREC_RANGE_TOL_KM &&
+         rep.maxTrackRateErrKms<=PREC_RATE_TOL_KMS;
+}
+
+// ---- brute-force reference check ----
+struct AccPredictor {
+  const char* name;
+  bool        prefilter;
+  bool        coarseF32;
+  bool        sliced;      // passSearchAdvance() přerušené po každém kroku
+  bool        profile;     // průlety z profilů nad obzorem (hledání + vzorky se počítají)
+};
+static const AccPredictor ACC_PREDICTORS[] = {
+  {"search",             true,  true,  false, false},
+  {"search_f64",         true,  false, false, false},
+  {"search_no_prefilter",false, true,  false, false},
+  {"search_sliced",      true,  true,  true,  false},
+  {"search_profile",     true,  true,  false, true},
+};
+
+// Clock that is always past the deadline: every passSearchAdvance() call
+// makes a single step, the worst case for suspend/resume.
+static uint32_t expiredClockUs(){ return 0; }
+
+// searchSatWindow() through passSearchAdvance(), suspended after every step
+static int slicedSatWindow(PassSearch &ps, time_t horizonUtc, time_t endUtc){
+  PassInfo* out=ps.out;
+  const int outMax=ps.outMax;
+  int count=0;
+
+  time_t h=horizonUtc;
+  while(h<endUtc && count<outMax){
+    time_t e=(h+PASS_JOB_CHUNK<endUtc)?h+PASS_JOB_CHUNK:endUtc;
+    ps.out=out+count;
+    ps.outMax=(outMax-count<PASS_JOB_MAX)?outMax-count:PASS_JOB_MAX;
+    ps.outCount=0;
+    ps.overflowAos=0;
+    passSearchBegin(ps,h,e);
+    while(!passSearchAdvance(ps,expiredClockUs,0)){}
+    count+=ps.outCount;
+    h=(ps.overflowAos!=0)?ps.overflowAos-1:e;
+  }
+
+  ps.out=out;
+  ps.outMax=outMax;
+  ps.outCount=count;
+  return count;
+}
+static const int ACC_PREDICTOR_COUNT = sizeof(ACC_PREDICTORS)/sizeof(ACC_PREDICTORS[0]);
+
+// Passes of the window derived from the profile at minEl, as the firmware
+// re-thresholds its table: arcs from a search at PROFILE_BASE_EL_DEG, then
+// profilePasses() for AOS in [arc window) that end after ps.nowUtc.
+static int profileSatWindow(PassSearch &ps, time_t horizonUtc, time_t endUtc, float minEl,
+                            ProfileArc* arcs, ProfileSample* samples, int sampleMax){
+  const int nArc=searchSatWindow(ps,horizonUtc,endUtc);
+  int used=0, count=0;
+  uint32_t calls=0;
+  for(int a=0;a<nArc;a++){
+    ProfileArc &arc=arcs[a];
+    int n=sampleProfileArc(*ps.sat,ps.site,ps.out[a],horizonUtc,arc,
+                           samples+used,sampleMax-used,&calls);
+    arc.first=(uint16_t)used;
+    arc.count=(uint8_t)n;
+    used+=n;
+  }
+  for(int a=0;a<nArc && count<ps.outMax;a++){
+    PassInfo p[PASS_JOB_MAX];
+    int n=profilePasses(arcs[a],samples,horizonUtc,minEl,p,PASS_JOB_MAX);
+    for(int i=0;i<n && count<ps.outMax;i++)
+      if(p[i].aos<endUtc && p[i].los>ps.nowUtc) ps.out[count++]=p[i];
+  }
+  ps.searchCalls+=calls;
+  ps.outCount=count;
+  return count;
+}
+
+static float refEl(Sgp4 &sat, time_t t, uint32_t &calls){
+  sat.findsat((double)t/86400.0+2440587.5);
+  calls++;
+  return (float)sat.satEl;
+}
+
+// Passes with AOS in [from,end) like searchSatWindow(): a pass already in
+// progress at from is skipped, LOS is followed up to PASS_OVERRUN_MAX past
+// end, passes shorter than PASS_MIN_DURATION or over before nowUtc are
+// dropped.
+static int referencePasses(Sgp4 &sat, uint8_t satIdx, float minEl, time_t from, time_t end,
+                           time_t nowUtc, PassInfo* out, int outMax, uint32_t &calls){
+  const time_t stop=end+(time_t)PASS_OVERRUN_MAX;
+  int n=0;
+  time_t t=from;
+  float el=refEl(sat,t,calls);
+  while(t<end){
+    time_t tn=t+ACC_REF_STEP_S;
+    float en=refEl(sat,tn,calls);
+    if(en<=minEl || el>minEl){ t=tn; el=en; continue; }
+
+    // AOS v (t,tn] po 1 s, pak celý průlet po 1 s
+    time_t a=t+1;
+    float ea=refEl(sat,a,calls);
+    while(ea<=minEl && a<tn){ a++; ea=refEl(sat,a,calls); }
+    float az=(float)sat.satAz;
+    PassInfo p={a,a,a,ea,az,az,az,satIdx};
+    for(time_t x=a+1;x<=stop;x++){
+      float ex=refEl(sat,x,calls);
+      if(ex<=minEl) break;
+      p.los=x; p.losAz=(float)sat.satAz;
+      if(ex>p.maxEl){ p.maxEl=ex; p.tMax=x; p.maxAz=p.losAz; }
+    }
+    if((double)(p.los-p.aos)>=PASS_MIN_DURATION && p.los>nowUtc){
+      if(n>=outMax) return n;
+      out[n++]=p;
+    }
+    t=p.los+1;
+    el=refEl(sat,t,calls);
+  }
+  return n;
+}
+
+static void accListAdd(AccuracyReport &rep, int k, int q, int si, bool missed, const PassInfo &p){
+  if(rep.listCount>=ACC_LIST_MAX) return;
+  AccuracyMiss &m=rep.list[rep.listCount++];
+  m.predictor=(uint8_t)k; m.qth=(uint8_t)q; m.sat=(uint16_t)si; m.missed=missed; m.pass=p;
+}
+
+void runAccuracyCheck(const BenchConfig &cfg, int sats, const AccuracyQth* qths, int qthCount,
+                      AccuracyReport &rep){
+  static Sgp4         ref;
+  static Sgp4Elements sat;
+  static PassSearch   ps;
+  char name[12], l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+
+  memset(&rep,0,sizeof(rep));
+  rep.sats=sats; rep.qths=qthCount; rep.hours=cfg.hours;
+  rep.count=ACC_PREDICTOR_COUNT<ACC_MAX_PREDICTORS?ACC_PREDICTOR_COUNT:ACC_MAX_PREDICTORS;
+  for(int k=0;k<rep.count;k++)
+    snprintf(rep.res[k].name,sizeof(rep.res[k].name),"%s",ACC_PREDICTORS[k].name);
+
+  const time_t start=benchStart(cfg);
+  const time_t from=start-PASS_LOOKBACK;
+  const time_t end=start+(time_t)cfg.hours*3600;
+  const time_t stop=end+(time_t)PASS_OVERRUN_MAX;
+  const int outMax=(int)((cfg.hours*3600+PASS_LOOKBACK)/PASS_JOB_CHUNK+2)*PASS_JOB_MAX;
+  PassInfo* pr=(PassInfo*)malloc(outMax*sizeof(PassInfo));
+  PassInfo* pf=(PassInfo*)malloc(outMax*sizeof(PassInfo));
+  if(!pr||!pf){ free(pr); free(pf); return; }
+  const int sampleMax=outMax*PROFILE_ARC_SAMPLES;
+  ProfileArc* arcs=(ProfileArc*)malloc(outMax*sizeof(ProfileArc));
+  ProfileSample* samples=(ProfileSample*)malloc(sampleMax*sizeof(ProfileSample));
+  if(!arcs||!samples){ free(pr); free(pf); free(arcs); free(samples); return; }
+
+  for(int q=0;q<qthCount;q++){
+    const AccuracyQth &qth=qths[q];
+    for(int si=0;si<sats;si++){
+      benchTle(cfg,si,name,l1,l2);
+      ref.site(qth.latDeg,qth.lonDeg,qth.altM);
+      initSgp4(ref,name,l1,l2);
+      if(!sgp4ElementsFromTle(sat,l1,l2)) continue;
+      double t0=benchNowUs();
+      int nr=referencePasses(ref,(uint8_t)si,qth.minElDeg,from,end,start,pr,outMax,rep.refCalls);
+      rep.refUs+=benchNowUs()-t0;
+      rep.refPasses+=nr;
+
+      for(int k=0;k<rep.count;k++){
+        AccuracyResult &r=rep.res[k];
+        const AccPredictor &pk=ACC_PREDICTORS[k];
+        initPassSearch(ps,sat,l1,l2,(uint8_t)si,pk.profile?PROFILE_BASE_EL_DEG:qth.minElDeg,
+                       qth.latDeg,qth.lonDeg,qth.altM,pk.prefilter,start);
+        ps.coarseF32=pk.coarseF32;
+        ps.out=pf; ps.outMax=outMax;
+        t0=benchNowUs();
+        int nf=pk.profile?profileSatWindow(ps,from,end,qth.minElDeg,arcs,samples,sampleMax):
+               pk.sliced?slicedSatWindow(ps,from,end):searchSatWindow(ps,from,end);
+        r.us+=benchNowUs()-t0;
+        r.sgp4Calls+=ps.searchCalls+ps.refineEvals;
+        r.passes+=nf;
+
+        // obě řady jsou seřazené podle AOS; na krajích okna může průlet
+        // o sekundu přeskočit hranici, takové se nepočítají
+        int i=0, j=0;
+        while(i<nr || j<nf){
+          if(i<nr && j<nf && absDiff(pr[i].aos,pf[j].aos)<=60){
+            int da=absDiff(pr[i].aos,pf[j].aos), dl=absDiff(pr[i].los,pf[j].los);
+            int dm=absDiff(pr[i].tMax,pf[j].tMax);
+            float de=fabsf(pr[i].maxEl-pf[j].maxEl);
+            float dd=pr[i].maxEl-pf[j].maxEl;
+            // elevace reference v tMax prediktoru (do času se nepočítá)
+            uint32_t extraCalls=0;
+            float dt=pr[i].maxEl-refEl(ref,pf[j].tMax,extraCalls);
+            if(da>r.maxAosErrS) r.maxAosErrS=da;
+            if(dl>r.maxLosErrS && pr[i].los<stop) r.maxLosErrS=dl;
+            if(dm>r.maxTmaxErrS) r.maxTmaxErrS=dm;
+            if(de>r.maxElErrDeg) r.maxElErrDeg=de;
+            if(dd>r.maxElDeficitDeg) r.maxElDeficitDeg=dd;
+            if(dt>r.maxTmaxDeficitDeg) r.maxTmaxDeficitDeg=dt;
+            r.matched++;
+            i++; j++;
+          } else if(j>=nf || (i<nr && pr[i].aos<pf[j].aos)){
+            const PassInfo &p=pr[i++];
+            if(absDiff(p.aos,from)<=ACC_TIME_TOL_S || absDiff(p.aos,end)<=ACC_TIME_TOL_S) continue;
+            r.missed++;
+            accListAdd(rep,k,q,si,true,p);
+          } else {
+            const PassInfo &p=pf[j++];
+            if(absDiff(p.aos,from)<=ACC_TIME_TOL_S || absDiff(p.aos,end)<=ACC_TIME_TOL_S) continue;
+            if(p.los-p.aos<2*ACC_REF_STEP_S){ r.extraShort++; continue; }
+            r.extra++;
+            accListAdd(rep,k,q,si,false,p);
+          }
+        }
+      }
+    }
+  }
+  free(pr); free(pf); free(arcs); free(samples);
+
+  rep.ok=true;
+  for(int k=0;k<rep.count;k++){
+    AccuracyResult &r=rep.res[k];
+    r.speedup=r.us>0?(float)(rep.refUs/r.us):0.0f;
+    r.ok=r.missed==0 && r.extra==0 && r.maxAosErrS<=ACC_TIME_TOL_S &&
+         r.maxLosErrS<=ACC_TIME_TOL_S && r.maxElDeficitDeg<=ACC_EL_TOL_DEG &&
+         r.maxTmaxDeficitDeg<=ACC_EL_TOL_DEG;
+    if(!r.ok) rep.ok=false;
+  }
+}
+
+// ---- SGP4 verification ----
+// From SGP4-VER.TLE / tcppver.out (Vallado et al., AIAA 2006-6753).
+static const char* const VER_L1[] = {
+  "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+  "1 06251U 62025E   06176.82412014  .00008885  00000-0  12808-3 0  3985",
+  "1 28057U 03049A   06177.78615833  .00000060  00000-0  35940-4 0  1836",
+  "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+  "1 11801U          80230.29629788  .01431103  00000-0  14311-1       13",
+  "1 28872U 05037B   05333.02012661  .25992681  00000-0  24476-3 0  1534",
+};
+static const char* const VER_L2[] = {
+  "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667",
+  "2 06251  58.0579  54.0425 0030035 139.1568 221.1854 15.56387291  6774",
+  "2 28057  98.4283 247.6961 0000884  88.1964 271.9322 14.35478080140550",
+  "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656",
+  "2 11801  46.7916 230.4354 7318036  47.4722  10.4117  2.28537848    13",
+  "2 28872  96.4736 157.9986 0303955 244.0492 110.6523 16.46015938 10708",
+};
+// 08195 = Molnija, 12 h rezonance; 11801 = deep space bez rezonance;
+// 28872 se rozpadne mezi 50 a 60 min (chyba 6)
+static const Sgp4Vector VER_VECTORS[] = {
+  {5,     0.0, { 7022.46529266,-1400.08296755,    0.03995155},{ 1.893841015, 6.405893759, 4.534807250},0},
+  {5,   360.0, {-7154.03120202,-3783.17682504,-3536.19412294},{ 4.741887409,-4.151817765,-2.093935425},0},
+  {5,   720.0, {-7134.59340119, 6531.68641334, 3260.27186483},{-4.113793027,-2.911922039,-2.557327851},0},
+  {6251,  0.0, { 3988.31022699, 5498.96657235,    0.90055879},{-3.290032738, 2.357652820, 6.496623475},0},
+  {28057, 0.0, {-2715.28237486,-6619.26436889,   -0.01341443},{-1.008587273, 0.422782003, 7.385272942},0},
+  {8195,  0.0, { 2349.89483350,-14785.93811562,   0.02119378},{ 2.721488096,-3.256811655, 4.498416672},0},
+  {8195,120.0, {15223.91713658,-17852.95881133,25280.39558242},{ 1.079041732, 0.875187372, 2.485682813},0},
+  {11801, 0.0, { 7473.37102491,  428.94748312, 5828.74846783},{ 5.107155391, 6.444680305,-0.186133297},0},
+  {28872,60.0, {0.0,0.0,0.0},{0.0,0.0,0.0},6},
+};
+
+int sgp4VerBuiltin(const char* const* &l1, const char* const* &l2, const Sgp4Vector* &vec,
+                   int &vecCount){
+  l1=VER_L1; l2=VER_L2;
+  vec=VER_VECTORS;
+  vecCount=(int)(sizeof(VER_VECTORS)/sizeof(VER_VECTORS[0]));
+  return (int)(sizeof(VER_L1)/sizeof(VER_L1[0]));
+}
+
+static double dist3(const double a[3], const double b[3]){
+  double dx=a[0]-b[0], dy=a[1]-b[1], dz=a[2]-b[2];
+  return sqrt(dx*dx+dy*dy+dz*dz);
+}
+
+void runSgp4Verify(const char* const* l1, const char* const* l2, int tleCount,
+                   const Sgp4Vector* vec, int vecCount, Sgp4VerifyReport &rep){
+  static Sgp4Elements el;
+  memset(&rep,0,sizeof(rep));
+  long cur=-1;
+  bool have=false;
+  for(int i=0;i<vecCount;i++){
+    const Sgp4Vector &x=vec[i];
+    if(x.satnum!=cur){
+      // SGP4-VER.TLE má za 69. sloupcem start/stop/krok, ty se odříznou
+      cur=x.satnum;
+      have=false;
+      for(int k=0;k<tleCount && !have;k++){
+        if(atol(l1[k]+2)!=cur) continue;
+        char a[TLE_LINE_MAX], b[TLE_LINE_MAX];
+        snprintf(a,sizeof(a),"%.69s",l1[k]);
+        snprintf(b,sizeof(b),"%.69s",l2[k]);
+        have=sgp4ElementsFromTle(el,a,b);
+      }
+      if(have) rep.sats++;
+    }
+    rep.vectors++;
+    if(!have){ rep.noTle++; continue; }
+
+    Sgp4State<double> d=sgp4Propagate<double>(el,x.tsince);
+    Sgp4State<float>  f=sgp4Propagate<float>(el,x.tsince);
+    if(x.error){
+      if(d.error!=x.error || f.error!=x.error) rep.failed++;
+      continue;
+    }
+    if(d.error){ rep.failed++; continue; }
+    double ep=dist3(d.r,x.r), ev=dist3(d.v,x.v);
+    double rf[3]={f.r[0],f.r[1],f.r[2]};
+    float  ef=f.error?INFINITY:(float)dist3(rf,x.r);
+    if(ep>rep.maxPosErrKm){ rep.maxPosErrKm=ep; rep.worstSat=x.satnum; rep.worstTsince=x.tsince; }
+    if(ev>rep.maxVelErrKms) rep.maxVelErrKms=ev;
+    if(ef>rep.maxPosErrF32Km) rep.maxPosErrF32Km=ef;
+    if(ep>VER_POS_TOL_KM || ev>VER_VEL_TOL_KMS || ef>VER_F32_TOL_KM) rep.failed++;
+  }
+  rep.ok=rep.vectors>0 && rep.failed==0 && rep.noTle==0;
+}
+
+static void jsonPut(char* buf, size_t len, size_t &pos, const char* fmt, ...){
+  if(pos>=len) return;
+  va_list ap;
+  va_start(ap,fmt);
+  int w=vsnprintf(buf+pos,len-pos,fmt,ap);
+  va_end(ap);
+  if(w>0) pos+=w;
+}
+
+int benchJson(char* buf, size_t len, const BenchResult* r, int n, const char* target){
+  size_t pos=0;
+  jsonPut(buf,len,pos,"{\"bench\":\"sat_predict\",\"target\":\"%s\",\"threads\":%d,\"simd\":\"%s\","
+      "\"results\":[",target?target:BENCH_TARGET,jobWorkerCount(),sgp4BatchIsaName(sgp4BatchBestIsa()));
+  for(int i=0;i<n;i++){
+    const BenchResult &b=r[i];
+    double us=b.us>0?b.us:1e-3;
+    jsonPut(buf,len,pos,"%s{\"name\":\"%s\",\"sats\":%d,\"ops\":%lu,\"sgp4_calls\":%lu,\"us\":%.0f,"
+        "\"us_per_op\":%.3f,\"ops_per_s\":%.1f,\"sgp4_per_s\":%.0f",
+        i?",":"",b.name,b.sats,(unsigned long)b.ops,(unsigned long)b.sgp4Calls,b.us,
+        b.ops?b.us/b.ops:0.0,b.ops*1e6/us,b.sgp4Calls*1e6/us);
+    if(b.cycles && b.ops) jsonPut(buf,len,pos,",\"cycles_per_op\":%.0f",(double)b.cycles/b.ops);
+    jsonPut(buf,len,pos,"}");
+  }
+  jsonPut(buf,len,pos,"]}");
+  return (int)(pos<len?pos:len-1);
+}
+
+int precisionJson(char* buf, size_t len, const PrecisionReport &rep, const char* target){
+  size_t pos=0;
+  jsonPut(buf,len,pos,"{\"check\":\"precision_f32\",\"target\":\"%s\",\"sats\":%d,"
+      "\"samples\":%lu,\"max_dir_err_deg\":%.5f,\"max_range_err_km\":%.4f,"
+      "\"passes_f32\":%d,\"passes_f64\":%d,\"unmatched\":%d,"
+      "\"max_aos_err_s\":%d,\"max_los_err_s\":%d,\"max_tmax_err_s\":%d,"
+      "\"max_el_err_deg\":%.4f,\"simd\":\"%s\",\"batch_samples\":%lu,\"batch_errors\":%d,"
+      "\"max_batch_dir_err_deg\":%.5f,\"max_batch_range_err_km\":%.4f,\"track_samples\":%lu,"
+      "\"max_track_dir_err_deg\":%.5f,\"max_track_range_err_km\":%.4f,"
+      "\"max_track_rate_err_kms\":%.6f,\"ok\":%s}",
+      target?target:BENCH_TARGET,rep.sats,(unsigned long)rep.samples,rep.maxDirErrDeg,
+      rep.maxRangeErrKm,rep.passesF32,rep.passesF64,rep.unmatched,rep.maxAosErrS,
+      rep.maxLosErrS,rep.maxTmaxErrS,rep.maxElErrDeg,sgp4BatchIsaName(sgp4BatchBestIsa()),
+      (unsigned long)rep.batchSamples,rep.batchErrors,rep.maxBatchDirErrDeg,rep.maxBatchRangeErrKm,
+      (unsigned long)rep.trackSamples,rep.maxTrackDirErrDeg,rep.maxTrackRangeErrKm,
+      rep.maxTrackRateErrKms,rep.ok?"true":"false");
+  return (int)(pos<len?pos:len-1);
+}
+
+int accuracyJson(char* buf, size_t len, const AccuracyReport &rep, const char* target){
+  size_t pos=0;
+  jsonPut(buf,len,pos,"{\"check\":\"reference\",\"target\":\"%s\",\"sats\":%d,\"qths\":%d,"
+      "\"hours\":%d,\"ref_passes\":%d,\"ref_sgp4_calls\":%lu,\"ref_us\":%.0f,\"predictors\":[",
+      target?target:BENCH_TARGET,rep.sats,rep.qths,rep.hours,rep.refPasses,
+      (unsigned long)rep.refCalls,rep.refUs);
+  for(int k=0;k<rep.count;k++){
+    const AccuracyResult &r=rep.res[k];
+    jsonPut(buf,len,pos,"%s{\"name\":\"%s\",\"passes\":%d,\"matched\":%d,\"missed\":%d,"
+        "\"extra\":%d,\"extra_short\":%d,\"max_aos_err_s\":%d,\"max_los_err_s\":%d,"
+        "\"max_tmax_err_s\":%d,\"max_el_err_deg\":%.4f,\"max_el_deficit_deg\":%.4f,"
+        "\"max_tmax_deficit_deg\":%.4f,\"sgp4_calls\":%lu,\"us\":%.0f,\"speedup\":%.1f,\"ok\":%s}",
+        k?",":"",r.name,r.passes,r.matched,r.missed,r.extra,r.extraShort,r.maxAosErrS,
+        r.maxLosErrS,r.maxTmaxErrS,r.maxElErrDeg,r.maxElDeficitDeg,r.maxTmaxDeficitDeg,
+        (unsigned long)r.sgp4Calls,r.us,r.speedup,r.ok?"true":"false");
+  }
+  jsonPut(buf,len,pos,"],\"ok\":%s}",rep.ok?"true":"false");
+  return (int)(pos<len?pos:len-1);
+}
+
+int sgp4VerifyJson(char* buf, size_t len, const Sgp4VerifyReport &rep, const char* target){
+  size_t pos=0;
+  jsonPut(buf,len,pos,"{\"check\":\"sgp4_vallado\",\"target\":\"%s\",\"sats\":%d,"
+      "\"vectors\":%d,\"failed\":%d,\"no_tle\":%d,\"max_pos_err_km\":%.3e,"
+      "\"max_vel_err_kms\":%.3e,\"max_pos_err_f32_km\":%.4f,\"worst_sat\":%ld,"
+      "\"worst_tsince\":%.2f,\"ok\":%s}",
+      target?target:BENCH_TARGET,rep.sats,rep.vectors,rep.failed,rep.noTle,rep.maxPosErrKm,
+      rep.maxVelErrKms,rep.maxPosErrF32Km,rep.worstSat,rep.worstTsince,rep.ok?"true":"false");
+  return (int)(pos<len?pos:len-1);
+}
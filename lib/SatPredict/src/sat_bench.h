@@ -0,0 +1,199 @@
+// sat_bench.h
+// Benchmark kernels of the prediction core. The same code runs natively
+// (pio run -e bench, src/bench/) and on the device (serial "bench"), and
+// both print one JSON object, so results can be compared between commits.
+#pragma once
+#include <stddef.h>
+#include "sat_predict.h"
+#include "sgp4_core.h"
+
+const int BENCH_MAX_RESULTS = 26;
+const int BENCH_TRACK_LEN   = 120;   // = TRAIL_LEN ve firmware
+const int BENCH_PASS_MAX    = 32;    // průlety pro refine/track kernely
+
+struct BenchResult {
+  char     name[24];
+  int      sats;
+  uint32_t ops;        // měřené operace: volání, průlety, stopy
+  uint32_t sgp4Calls;
+  double   us;         // wall time
+  uint64_t cycles;     // ESP32: CPU cycles (single-core kernels), jinak 0
+};
+
+struct BenchConfig {
+  int    findsatCalls;
+  int    hours;        // okno predikce
+  bool   prefilter;
+  float  minElDeg;
+  double latDeg, lonDeg, altM;
+  // vlastní TLE (host --tle), jinak syntetické LEO dráhy; satelit i
+  // bere sadu i % tleCount
+  const char* const* tleL1;
+  const char* const* tleL2;
+  int    tleCount;
+};
+
+void benchDefaults(BenchConfig &cfg, bool quick);
+
+// Runs all kernels: findsat, sgp4_library, sgp4_propagate and
+// sgp4_propagate_f32 (position and velocity from the library's sgp4() and
+// from the reentrant sgp4Propagate()), sgp4_propagate_deep and
+// sgp4_propagate_deep_seq (a 12 h resonant orbit a week from epoch, without
+// / with the caller's resonance cursor), sat_state and sat_state_vis (the
+// live sample without / with lazy illumination), propagate_series and
+// propagate_series_f32 (the same samples through the batch kernel),
+// ephem_fit and ephem_state (Chebyshev ephemeris fit per segment, and the
+// sat_state samples evaluated from it), catalog_state, catalog_soa,
+// catalog_simd and catalog_simd_f32 (az/el of a catalog per time step, per
+// satellite and through the struct-of-arrays batch), predict_passes for 1/4/12/128 satellites (job queue on all cores, like
+// the firmware's engine), refine_pass_max, pass_track, track_direct and
+// track_interp (10 Hz live tracking, SGP4 per sample / interpolated
+// between anchors, sat_track.h), and profile_build
+// and profile_passes (elevation profiles sampled at the horizon, and
+// passes re-thresholded from them without SGP4). Returns the number of
+// results written.
+int runBenchSuite(const BenchConfig &cfg, BenchResult* out, int outMax);
+
+// {"bench":"sat_predict","target":...,"threads":...,"results":[...]}
+int benchJson(char* buf, size_t len, const BenchResult* r, int n, const char* target);
+
+// ---- float vs double validation ----
+// The coarse scan runs SGP4 in float (PassSearch::coarseF32). This check
+// propagates the bench satellites over the window in both precisions and
+// runs the pass search both ways, and reports the largest differences.
+// It also compares the struct-of-arrays batch (sgp4_batch.h, best ISA, in
+// double and float) with the per-satellite double path, and the 10 Hz
+// interpolated tracking (trackAt()) with SGP4 at every sample over the first
+// pass of each satellite.
+const float PREC_DIR_TOL_DEG  = 0.05f;  // směr float vs double, nad obzorem
+const float PREC_RANGE_TOL_KM = 0.5f;
+const float PREC_RATE_TOL_KMS = 0.001f; // range rate sledování, 1 m/s ~ 1.5 Hz Doppler na 435 MHz
+const int   PREC_TIME_TOL_S   = 1;      // AOS/LOS/tMax
+const float PREC_EL_TOL_DEG   = 0.01f;  // maxEl
+
+struct PrecisionReport {
+  int      sats;
+  uint32_t samples;        // vzorky nad obzorem
+  float    maxDirErrDeg;
+  float    maxRangeErrKm;
+  int      passesF32, passesF64;
+  int      unmatched;      // průlety bez protějšku do 60 s
+  int      maxAosErrS, maxLosErrS, maxTmaxErrS;
+  float    maxElErrDeg;
+  uint32_t batchSamples;   // dávka: vzorky nad obzorem
+  int      batchErrors;    // chyba SGP4 jen v jedné z cest
+  float    maxBatchDirErrDeg;
+  float    maxBatchRangeErrKm;
+  uint32_t trackSamples;   // sledování 10 Hz, vzorky prvního průletu
+  float    maxTrackDirErrDeg;
+  float    maxTrackRangeErrKm;
+  float    maxTrackRateErrKms;
+  bool     ok;
+};
+
+void runPrecisionCheck(const BenchConfig &cfg, int sats, PrecisionReport &rep);
+int  precisionJson(char* buf, size_t len, const PrecisionReport &rep, const char* target);
+
+double   benchNowUs();
+uint32_t benchCycles();   // 0 mimo ESP32
+
+// ---- brute-force reference check ----
+// Reference = the original predictPasses(): findsat() every 10 s, and from
+// the first sample above minEl every 1 s until the pass ends (AOS, LOS,
+// tMax and maxEl to 1 s). Every fast predictor (ACC_PREDICTORS) searches
+// the same satellites, QTHs and window and is compared pass by pass.
+// The maximum is judged by elevation, not by seconds: a HEO maximum is flat
+// for minutes, and 1 s samples under-read a near-zenith peak, so only a
+// predictor's maxEl below the reference's, or a tMax whose elevation is
+// below the reference maximum, count as errors.
+const int    ACC_REF_STEP_S    = 10;
+const int    ACC_TIME_TOL_S    = 2;      // AOS/LOS: reference má rozlišení 1 s
+const float  ACC_EL_TOL_DEG    = 0.05f;  // maxEl a elevace v tMax pod referencí
+const int    ACC_MAX_PREDICTORS = 6;
+const int    ACC_LIST_MAX      = 32;     // vypsané chybějící/přebývající průlety
+
+struct AccuracyQth {
+  char   name[24];
+  double latDeg, lonDeg, altM;
+  float  minElDeg;
+};
+
+struct AccuracyResult {
+  char     name[24];       // prediktor
+  int      passes, matched;
+  int      missed;         // v referenci, prediktor nenašel
+  int      extra;          // prediktor navíc (kratší než 2 kroky reference se tolerují)
+  int      extraShort;
+  int      maxAosErrS, maxLosErrS, maxTmaxErrS;   // LOS bez průletů useknutých PASS_OVERRUN_MAX
+  float    maxElErrDeg;        // |maxEl - reference|
+  float    maxElDeficitDeg;    // o kolik je maxEl pod referencí
+  float    maxTmaxDeficitDeg;  // o kolik je elevace v tMax pod maximem reference
+  uint32_t sgp4Calls;
+  double   us;
+  float    speedup;            // čas reference / čas prediktoru
+  bool     ok;
+};
+
+struct AccuracyMiss {
+  uint8_t  predictor, qth;
+  uint16_t sat;            // index TLE sady
+  bool     missed;         // false = extra
+  PassInfo pass;
+};
+
+struct AccuracyReport {
+  int      sats, qths, hours;
+  int      refPasses;
+  uint32_t refCalls;
+  double   refUs;
+  AccuracyResult res[ACC_MAX_PREDICTORS];
+  int      count;
+  AccuracyMiss list[ACC_LIST_MAX];
+  int      listCount;      // uložené (počet všech je v missed/extra)
+  bool     ok;
+};
+
+// Runs the reference and all predictors over every QTH and the first sats
+// satellites of cfg (TLE sets or synthetic) for cfg.hours from the first
+// TLE's epoch + 12 h, single-threaded so the times compare.
+void runAccuracyCheck(const BenchConfig &cfg, int sats, const AccuracyQth* qths, int qthCount,
+                      AccuracyReport &rep);
+int  accuracyJson(char* buf, size_t len, const AccuracyReport &rep, const char* target);
+
+// ---- SGP4 verification ----
+// sgp4Propagate() against Vallado's test vectors (SGP4-VER.TLE and
+// tcppver.out from "Revisiting Spacetrack Report #3"). The built-in set is
+// a subset of that file (near-earth, deep space with and without 12 h
+// resonance, the 28872 decay) and also runs on the device (serial
+// "bench sgp4"); the host checks the complete files with
+// --verify --tle SGP4-VER.TLE --vectors tcppver.out.
+const double VER_POS_TOL_KM   = 1.0e-4;
+const double VER_VEL_TOL_KMS  = 1.0e-7;
+const float  VER_F32_TOL_KM   = PREC_RANGE_TOL_KM;   // float varianta
+
+struct Sgp4Vector {
+  long   satnum;
+  double tsince;       // min od epochy
+  double r[3], v[3];   // TEME km, km/s
+  int    error;        // očekávaná chyba SGP4, r/v se pak neporovnávají
+};
+
+struct Sgp4VerifyReport {
+  int    sats, vectors;
+  int    failed;             // nad tolerancí nebo chyba SGP4
+  int    noTle;              // vektory bez TLE sady
+  double maxPosErrKm, maxVelErrKms;
+  float  maxPosErrF32Km;
+  long   worstSat;           // největší chyba polohy (double)
+  double worstTsince;
+  bool   ok;
+};
+
+// Built-in cases (TLE lines and vectors), for runSgp4Verify().
+int sgp4VerBuiltin(const char* const* &l1, const char* const* &l2, const Sgp4Vector* &vec,
+                   int &vecCount);
+// Each vector is propagated from the TLE set with its catalog number, in
+// double and in float.
+void runSgp4Verify(const char* const* l1, const char* const* l2, int tleCount,
+                   const Sgp4Vector* vec, int vecCount, Sgp4VerifyReport &rep);
+int  sgp4VerifyJson(char* buf, size_t len, const Sgp4VerifyReport &rep, const char* target);
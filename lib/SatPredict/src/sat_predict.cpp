@@ -0,0 +1,1365 @@
+// sat_predict.cpp
+#include "sat_predict.h"
+#include "sgp4_core.h"
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static inline double clampd(double v, double lo, double hi){ return v<lo?lo:(v>hi?hi:v); }
+static inline double deg2rad(double d){ return d*(M_PI/180.0); }
+static inline double rad2deg(double r){ return r*(180.0/M_PI); }
+
+uint8_t quantAz(float az){
+  int q=(int)lroundf(az*(256.0f/360.0f));
+  return (uint8_t)(q&0xFF);
+}
+float dequantAz(uint8_t q){ return q*(360.0f/256.0f); }
+
+PassRec encodePass(const PassInfo &p, time_t base){
+  PassRec r;
+  long dur=(long)(p.los-p.aos), maxOff=(long)(p.tMax-p.aos);
+  int  elQ=(int)lroundf(p.maxEl*2.0f);
+  r.aosOff=(uint32_t)(p.aos-base);
+  r.dur=(uint16_t)(dur<0?0:(dur>65535?65535:dur));
+  r.maxOff=(uint16_t)(maxOff<0?0:(maxOff>r.dur?r.dur:maxOff));
+  r.maxElQ=(uint8_t)(elQ<0?0:(elQ>180?180:elQ));
+  r.aosAzQ=quantAz(p.aosAz);
+  r.maxAzQ=quantAz(p.maxAz);
+  r.losAzQ=quantAz(p.losAz);
+  r.satIdx=p.satIdx;
+  return r;
+}
+
+PassInfo decodePass(const PassRec &r, time_t base){
+  PassInfo p;
+  p.aos=base+(time_t)r.aosOff;
+  p.los=p.aos+r.dur;
+  p.tMax=p.aos+r.maxOff;
+  p.maxEl=r.maxElQ*0.5f;
+  p.aosAz=dequantAz(r.aosAzQ);
+  p.maxAz=dequantAz(r.maxAzQ);
+  p.losAz=dequantAz(r.losAzQ);
+  p.satIdx=r.satIdx;
+  return p;
+}
+
+// pevné sloupce TLE -> double
+double tleField(const char* line, int col, int len){
+  char buf[16];
+  if(len>(int)sizeof(buf)-1) len=sizeof(buf)-1;
+  memcpy(buf,line+col,len); buf[len]='\0';
+  return atof(buf);
+}
+
+PassStepBound passStepBound(const char* l2, double minElDeg, double qthAltM){
+  // high-orbit fields 0 = unknown until set below
+  PassStepBound b{1.0,2.0,0.1,180.0, 0.0,0.0,0.0, 0.0, 0.0, 0.0};
+  if(strlen(l2)<63) return b;
+  double revPerDay=tleField(l2,52,11);
+  double ecc=tleField(l2,26,7)*1e-7;
+  if(revPerDay<=0.0 || ecc<0.0 || ecc>=1.0) return b;
+
+  double n=revPerDay*2.0*M_PI/86400.0;
+  double a=cbrt(EARTH_MU_KM3S2/(n*n));
+  double rp=a*(1.0-ecc), ra=a*(1.0+ecc);
+  double ro=EARTH_RE_KM+qthAltM/1000.0;
+  if(rp<=ro) return b;
+
+  double vp=sqrt(EARTH_MU_KM3S2*(2.0/rp-1.0/a));
+  // perigee speed + rotation of the Earth-fixed frame at apogee radius
+  double vMax=vp+EARTH_OMEGA*ra;
+
+  double el=deg2rad(minElDeg);
+  double rangeMinEl=sqrt(rp*rp-ro*ro*cos(el)*cos(el))-ro*sin(el);
+  double rangeZenith=rp-ro;
+
+  b.elBelowDps=rad2deg(vMax/rangeMinEl)*EL_RATE_SAFETY;
+  b.elAboveDps=rad2deg(vMax/rangeZenith)*EL_RATE_SAFETY;
+  b.psiDps=rad2deg(vp/rp+EARTH_OMEGA)*EL_RATE_SAFETY;
+  b.psiVisDeg=rad2deg(acos(ro*cos(el)/ra)-el);
+
+  b.aKm=a; b.rpKm=rp; b.raKm=ra; b.roKm=ro;
+  b.vrMaxKms=ecc*sqrt(EARTH_MU_KM3S2/(a*(1.0-ecc*ecc)));
+  if(orbitRegime(revPerDay,ecc)==ORBIT_GEO){
+    // ECEF speed to first order in the drift, e and i; 2x rezerva
+    double incl=deg2rad(tleField(l2,8,8));
+    b.geoKms=2.0*a*(fabs(n-EARTH_OMEGA)+n*(2.0*ecc+sin(incl)));
+  }
+  return b;
+}
+
+// ---- orbit regimes ----
+uint8_t orbitRegime(double revPerDay, double ecc){
+  if(revPerDay<=0.0) return ORBIT_LEO;
+  if(fabs(revPerDay-GEO_REV_PER_DAY)<GEO_REV_TOL && ecc<GEO_ECC_MAX) return ORBIT_GEO;
+  if(ecc>=PREFILTER_ECC_MAX || 86400.0/revPerDay>=PREFILTER_PERIOD_MAX) return ORBIT_HEO;
+  return ORBIT_LEO;
+}
+
+uint8_t orbitRegime(const char* l2){
+  if(strlen(l2)<63) return ORBIT_LEO;
+  return orbitRegime(tleField(l2,52,11),tleField(l2,26,7)*1e-7);
+}
+
+uint8_t orbitRegime(const TleRecord &r){
+  if(!r.valid) return ORBIT_LEO;
+  return orbitRegime(r.meanMotion*1e-8,r.ecc*1e-7);
+}
+
+const char* orbitRegimeName(uint8_t regime){
+  switch(regime){
+    case ORBIT_HEO: return "HEO";
+    case ORBIT_GEO: return "GEO";
+    default:        return "LEO";
+  }
+}
+
+// ---- analytic pass prefilter ----
+// Mean elements with the secular J2 rates SGP4 uses. They give the
+// satellite's argument of latitude in closed form, which is enough to tell
+// when the ground track can come near the QTH. predictPasses() then runs
+// SGP4 only inside those windows.
+// TLE epoch (line 1, cols 19-32) as UNIX time
+double tleEpochUtc(const char* l1){
+  int yy=(int)tleField(l1,18,2);
+  double doy=tleField(l1,20,12);
+  int year=(yy<57)?2000+yy:1900+yy;
+  long days=365L*(year-1970)+(year-1969)/4;
+  return (days+doy-1.0)*86400.0;
+}
+
+OrbitMean orbitMeanFromTle(const char* l1, const char* l2){
+  OrbitMean o{};
+  if(strlen(l1)<63 || strlen(l2)<63) return o;
+
+  double n0=tleField(l2,52,11)*2.0*M_PI/86400.0;  // rad/s
+  o.ecc=tleField(l2,26,7)*1e-7;
+  if(n0<=0.0 || o.ecc>=PREFILTER_ECC_MAX) return o;
+  if(2.0*M_PI/n0>=PREFILTER_PERIOD_MAX) return o;
+
+  o.epochUtc=tleEpochUtc(l1);
+  o.incl=deg2rad(tleField(l2,8,8));
+  o.raan0=deg2rad(tleField(l2,17,8));
+  o.argp0=deg2rad(tleField(l2,34,8));
+  o.ma0=deg2rad(tleField(l2,43,8));
+  o.maDdot=tleField(l1,33,10)*2.0*M_PI/(86400.0*86400.0);
+
+  // Kozai -> Brouwer mean motion and the secular rates, as in SGP4 init
+  double cosi=cos(o.incl), cosi2=cosi*cosi;
+  double omeosq=1.0-o.ecc*o.ecc, rteosq=sqrt(omeosq);
+  double a1=cbrt(EARTH_MU_KM3S2/(n0*n0))/SGP4_RE_KM;
+  double d1=0.75*SGP4_J2*(3.0*cosi2-1.0)/(rteosq*omeosq);
+  double del=d1/(a1*a1);
+  double adel=a1*(1.0-del*del-del*(1.0/3.0+134.0*del*del/81.0));
+  del=d1/(adel*adel);
+  double n=n0/(1.0+del);
+  double ao=cbrt(EARTH_MU_KM3S2/(n*n))/SGP4_RE_KM;
+  double po=ao*omeosq;
+  double temp1=1.5*SGP4_J2*n/(po*po);
+
+  o.maDot=n+0.5*temp1*rteosq*(3.0*cosi2-1.0);
+  o.argpDot=-0.5*temp1*(1.0-5.0*cosi2);
+  o.raanDot=-temp1*cosi;
+  o.valid=true;
+  return o;
+}
+
+// Greenwich mean sidereal angle (rad) for UNIX time
+double gmstRad(double utc){
+  double d=utc/86400.0-10957.5;   // dny od J2000.0
+  double g=fmod(280.46061837+360.98564736629*d,360.0);
+  if(g<0) g+=360.0;
+  return deg2rad(g);
+}
+
+double wrapPi(double a){
+  a=fmod(a+M_PI,2.0*M_PI);
+  if(a<0) a+=2.0*M_PI;
+  return a-M_PI;
+}
+
+// Angle between the satellite and the QTH projection in the orbit plane
+// (dU, rad) and the QTH's angle from the orbit plane (beta, rad) at utc.
+void orbitQthGeometry(const OrbitMean &o, double latRad, double lonRad, double utc,
+                      double &dU, double &beta){
+  double tau=utc-o.epochUtc;
+  double ma=o.ma0+o.maDot*tau+o.maDdot*tau*tau;
+  double nu=ma+2.0*o.ecc*sin(ma)+1.25*o.ecc*o.ecc*sin(2.0*ma);
+  double u=o.argp0+o.argpDot*tau+nu;
+  double raan=o.raan0+o.raanDot*tau;
+
+  double x=gmstRad(utc)+lonRad-raan;   // QTH longitude from the ascending node
+  double cp=cos(latRad), sp=sin(latRad);
+  double ci=cos(o.incl), si=sin(o.incl);
+  double qn=cp*cos(x);
+  double qm=cp*ci*sin(x)+sp*si;
+  double qN=-cp*si*sin(x)+sp*ci;
+
+  dU=wrapPi(u-atan2(qm,qn));
+  beta=asin(clampd(qN,-1.0,1.0));
+}
+
+// Coarse time windows inside [t0,t1] where the sub-satellite point can be
+// within limitDeg of the QTH. Per revolution: find the time the satellite
+// passes the QTH's projection into the orbit plane (secant method on dU),
+// then keep it if the QTH is within the limit of the plane there. Returns the
+// number of windows, or -1 when there are more than maxWin.
+int prefilterWindows(const OrbitMean &o, double latDeg, double lonDeg, double limitDeg,
+                     double t0, double t1, double *winStart, double *winEnd, int maxWin){
+  const double latRad=deg2rad(latDeg), lonRad=deg2rad(lonDeg);
+  const double uRate=o.maDot+o.argpDot;
+  const double relRate=uRate-EARTH_OMEGA;     // nejpomalejší relativní pohyb
+  const double synodic=2.0*M_PI/uRate;
+
+  double ageDays=fabs(0.5*(t0+t1)-o.epochUtc)/86400.0;
+  double lim=deg2rad(limitDeg+PREFILTER_MARGIN_DEG+PREFILTER_MARGIN_DEG_DAY*ageDays);
+  if(lim>=0.5*M_PI) return -1;
+
+  int count=0;
+  double tPrev=-1e18;
+  double t=t0-synodic;
+  while(true){
+    // secant on dU(t)=0, starting from the linear estimate
+    double fa, fb, beta;
+    orbitQthGeometry(o,latRad,lonRad,t,fa,beta);
+    double ta=t-fa/uRate;
+    orbitQthGeometry(o,latRad,lonRad,ta,fa,beta);
+    double tb=ta+60.0;
+    orbitQthGeometry(o,latRad,lonRad,tb,fb,beta);
+    for(int it=0;it<8 && fabs(fb)>1e-4 && fb!=fa;it++){
+      double tn=tb-fb*(tb-ta)/(fb-fa);
+      ta=tb; fa=fb; tb=tn;
+      orbitQthGeometry(o,latRad,lonRad,tb,fb,beta);
+    }
+    double tc=tb;
+    if(tc<tPrev+0.5*synodic){      // sklouzlo zpět na předchozí kořen
+      t=tPrev+synodic;
+      tPrev+=0.25*synodic;
+      continue;
+    }
+    tPrev=tc;
+
+    if(fabs(beta)<lim){
+      double du=acos(clampd(cos(lim)/cos(beta),-1.0,1.0));
+      double w=du/relRate+PREFILTER_TIME_MARGIN;
+      double a=tc-w, b=tc+w;
+      if(b>t0 && a<t1){
+        if(a<t0) a=t0;
+        if(b>t1) b=t1;
+        if(count>0 && a<=winEnd[count-1]){
+          if(b>winEnd[count-1]) winEnd[count-1]=b;
+        } else {
+          if(count>=maxWin) return -1;
+          winStart[count]=a; winEnd[count]=b; count++;
+        }
+      }
+    }
+
+    if(tc>t1+synodic) break;
+    t=tc+synodic;
+  }
+  return count;
+}
+
+bool initSgp4(Sgp4 &sat, const char* name, const char* l1, const char* l2){
+  char b1[TLE_LINE_MAX], b2[TLE_LINE_MAX];
+  strncpy(b1,l1,sizeof(b1)-1); b1[sizeof(b1)-1]='\0';
+  strncpy(b2,l2,sizeof(b2)-1); b2[sizeof(b2)-1]='\0';
+  return sat.init(name,b1,b2);
+}
+
+// ---- compact TLE record ----
+// Fixed-point TLE field: optional sign, digits and an optional decimal
+// point, scaled to `decimals` places. Blanks are skipped; false when the
+// field holds anything else or has more places than `decimals`.
+static bool tleFixed(const char* line, int col, int len, int decimals, int64_t &out){
+  int64_t v=0;
+  bool neg=false, digits=false, point=false;
+  int places=0;
+  for(int i=col;i<col+len;i++){
+    char c=line[i];
+    if(c==' ') continue;
+    if((c=='-'||c=='+') && !digits && !point){ neg=(c=='-'); continue; }
+    if(c=='.' && !point){ point=true; continue; }
+    if(c<'0'||c>'9') return false;
+    if(point && ++places>decimals) return false;
+    v=v*10+(c-'0');
+    digits=true;
+  }
+  if(!digits) return false;
+  for(;places<decimals;places++) v*=10;
+  out=neg?-v:v;
+  return true;
+}
+
+// "±ddddd±e" (nddot, bstar): mantissa 0.ddddd, exponent e kept as written
+// (a zero exponent is "-0" or "+0" depending on the source)
+static bool tleExpField(const char* line, int col, int32_t &mant, char exp[2]){
+  int64_t m, e;
+  if(!tleFixed(line,col,6,0,m) || !tleFixed(line,col+6,2,0,e)) return false;
+  if(line[col+6]!='-' && line[col+6]!='+') return false;
+  mant=(int32_t)m;
+  exp[0]=line[col+6]; exp[1]=line[col+7];
+  return true;
+}
+
+static char tleChecksum(const char* line){
+  int sum=0;
+  for(int i=0;i<68 && line[i];i++){
+    if(line[i]>='0' && line[i]<='9') sum+=line[i]-'0';
+    else if(line[i]=='-') sum++;
+  }
+  return (char)('0'+sum%10);
+}
+
+bool tleRecordFromLines(TleRecord &r, const char* l1, const char* l2){
+  memset(&r,0,sizeof(r));
+  if(strlen(l1)<68 || strlen(l2)<68 || l1[0]!='1' || l2[0]!='2') return false;
+
+  int64_t yy, day, frac, ndot, elnum, incl, raan, ecc, argp, ma, mm, rev;
+  if(!tleFixed(l1,18,2,0,yy) || !tleFixed(l1,20,3,0,day) || l1[23]!='.' ||
+     !tleFixed(l1,24,8,0,frac) || !tleFixed(l1,33,10,8,ndot) ||
+     !tleExpField(l1,44,r.nddotMant,r.nddotExp) || !tleExpField(l1,53,r.bstarMant,r.bstarExp) ||
+     !tleFixed(l1,64,4,0,elnum)) return false;
+  if(!tleFixed(l2,8,8,4,incl) || !tleFixed(l2,17,8,4,raan) || !tleFixed(l2,26,7,0,ecc) ||
+     !tleFixed(l2,34,8,4,argp) || !tleFixed(l2,43,8,4,ma) || !tleFixed(l2,52,11,8,mm))
+    return false;
+  // číslo oběhu chybí u některých zdrojů
+  if(!tleFixed(l2,63,5,0,rev)) rev=0;
+  if(incl<0 || raan<0 || ecc<0 || argp<0 || ma<0 || mm<=0 || mm>0xFFFFFFFFLL) return false;
+
+  memcpy(r.satnum,l1+2,5);
+  r.cls=l1[7];
+  memcpy(r.desig,l1+9,8);
+  r.ephType=l1[62];
+  r.epochYear=(uint8_t)yy;
+  r.epochDay=(uint16_t)day;
+  r.epochFrac=(uint32_t)frac;
+  r.ndot=(int32_t)ndot;
+  r.elnum=(uint16_t)elnum;
+  r.incl=(uint32_t)incl; r.raan=(uint32_t)raan; r.ecc=(uint32_t)ecc;
+  r.argp=(uint32_t)argp; r.ma=(uint32_t)ma;
+  r.meanMotion=(uint32_t)mm;
+  r.revnum=(uint32_t)rev;
+  r.valid=true;
+  return true;
+}
+
+void tleRecordLines(const TleRecord &r, char* l1, char* l2){
+  if(!r.valid){ l1[0]='\0'; l2[0]='\0'; return; }
+  long nd=(long)r.ndot;
+  snprintf(l1,TLE_LINE_MAX,"1 %.5s%c %.8s %02u%03u.%08lu %c.%08ld %c%05ld%c%c %c%05ld%c%c %c %4u ",
+           r.satnum,r.cls,r.desig,(unsigned)r.epochYear,(unsigned)r.epochDay,(unsigned long)r.epochFrac,
+           nd<0?'-':' ',labs(nd),
+           r.nddotMant<0?'-':' ',labs((long)r.nddotMant),r.nddotExp[0],r.nddotExp[1],
+           r.bstarMant<0?'-':' ',labs((long)r.bstarMant),r.bstarExp[0],r.bstarExp[1],
+           r.ephType,(unsigned)r.elnum);
+  l1[68]=tleChecksum(l1);
+  snprintf(l2,TLE_LINE_MAX,"2 %.5s %3lu.%04lu %3lu.%04lu %07lu %3lu.%04lu %3lu.%04lu %2lu.%08lu%5lu ",
+           r.satnum,
+           (unsigned long)(r.incl/10000),(unsigned long)(r.incl%10000),
+           (unsigned long)(r.raan/10000),(unsigned long)(r.raan%10000),
+           (unsigned long)r.ecc,
+           (unsigned long)(r.argp/10000),(unsigned long)(r.argp%10000),
+           (unsigned long)(r.ma/10000),(unsigned long)(r.ma%10000),
+           (unsigned long)(r.meanMotion/100000000),(unsigned long)(r.meanMotion%100000000),
+           (unsigned long)(r.revnum%100000));
+  l2[68]=tleChecksum(l2);
+}
+
+bool initElements(Sgp4Elements &sat, const TleRecord &r){
+  char l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  if(!r.valid) return false;
+  tleRecordLines(r,l1,l2);
+  return sgp4ElementsFromTle(sat,l1,l2);
+}
+
+void initSiteFrame(SiteFrame &site, double latDeg, double lonDeg, double altM){
+  const double RE=6378.137, E2=0.006694385;   // WGS-84, jako site() v knihovně
+  double lat=deg2rad(latDeg), lon=deg2rad(lonDeg), h=altM/1000.0;
+  site.sinLat=sin(lat); site.cosLat=cos(lat);
+  site.sinLon=sin(lon); site.cosLon=cos(lon);
+  double c=RE/sqrt(1.0-E2*site.sinLat*site.sinLat);
+  site.ecef[0]=(c+h)*site.cosLat*site.cosLon;
+  site.ecef[1]=(c+h)*site.cosLat*site.sinLon;
+  site.ecef[2]=((1.0-E2)*c+h)*site.sinLat;
+
+  double (*m)[3]=site.sez;
+  m[0][0]= site.sinLat*site.cosLon; m[0][1]= site.sinLat*site.sinLon; m[0][2]=-site.cosLat;
+  m[1][0]=-site.sinLon;             m[1][1]= site.cosLon;             m[1][2]= 0.0;
+  m[2][0]= site.cosLat*site.cosLon; m[2][1]= site.cosLat*site.sinLon; m[2][2]= site.sinLat;
+}
+
+// TEME positions from pos(i,r) -> az/el/range; the series kernel of
+// propagateSeries() and ephemSeries()
+template<typename T, typename PosFn>
+static int topoSeries(PosFn pos, const SiteFrame &site, double t0, double dt, int n,
+                      float* az, float* el, float* rangeKm){
+  const double jd0=t0/86400.0+2440587.5;
+  T m[3][3];
+  for(int i=0;i<3;i++) for(int j=0;j<3;j++) m[i][j]=(T)site.sez[i][j];
+  const T sx=(T)site.ecef[0], sy=(T)site.ecef[1], sz=(T)site.ecef[2];
+
+  // rotace Země: GMST jednou, dál pevné pootočení o krok (v double, chyba
+  // roste jen jako n*eps)
+  const double gm0=gstime(jd0);
+  double cg=cos(gm0), sg=sin(gm0), cd=1.0, sd=0.0;
+  if(n>1){
+    double dg=wrapPi(gstime(jd0+dt/86400.0)-gm0);
+    cd=cos(dg); sd=sin(dg);
+  }
+
+  for(int i=0;i<n;i++){
+    T r[3];
+    if(!pos(i,r)) return i;
+
+    // TEME -> ECEF (bez pohybu pólu) -> SEZ
+    const T c=(T)cg, s=(T)sg;
+    T dx= c*r[0]+s*r[1]-sx;
+    T dy=-s*r[0]+c*r[1]-sy;
+    T dz=r[2]-sz;
+    T tS=m[0][0]*dx+m[0][1]*dy+m[0][2]*dz;
+    T tE=m[1][0]*dx+m[1][1]*dy;
+    T tZ=m[2][0]*dx+m[2][1]*dy+m[2][2]*dz;
+    T rho=sgpm::sqrt(tS*tS+tE*tE+tZ*tZ);
+    T sinEl=tZ/rho;
+    if(sinEl>(T)1) sinEl=(T)1;
+    if(sinEl<(T)-1) sinEl=(T)-1;
+
+    T a=sgpm::atan2(tE,-tS);
+    if(a<0) a+=(T)(2.0*M_PI);
+    az[i]=(float)(a*(T)(180.0/M_PI));
+    el[i]=(float)(sgpm::asin(sinEl)*(T)(180.0/M_PI));
+    if(rangeKm) rangeKm[i]=(float)rho;
+
+    double cn=cg*cd-sg*sd;
+    sg=sg*cd+cg*sd; cg=cn;
+  }
+  return n;
+}
+
+// SGP4 position only (velocity is computed, but not needed here)
+template<typename T>
+static inline bool sgp4Pos(const Sgp4Elements &sat, double tsince, T r[3], Sgp4Resonance* res){
+  Sgp4State<T> st=sgp4Propagate<T>(sat,tsince,res);
+  if(st.error) return false;
+  r[0]=st.r[0]; r[1]=st.r[1]; r[2]=st.r[2];
+  return true;
+}
+
+static double tsinceMin(const Sgp4Elements &sat, double utc){
+  return (utc/86400.0+2440587.5-sat.rec.jdsatepoch)*1440.0;
+}
+
+template<typename T>
+int propagateSeries(const Sgp4Elements &sat, const SiteFrame &site, double t0, double dt, int n,
+                    float* az, float* el, float* rangeKm, Sgp4Resonance* res){
+  const double tsince0=tsinceMin(sat,t0);   // min od epochy
+  return topoSeries<T>([&](int i, T r[3]){ return sgp4Pos<T>(sat,tsince0+i*(dt/60.0),r,res); },
+                       site,t0,dt,n,az,el,rangeKm);
+}
+
+template int propagateSeries<float>(const Sgp4Elements&, const SiteFrame&, double, double, int,
+                                    float*, float*, float*, Sgp4Resonance*);
+template int propagateSeries<double>(const Sgp4Elements&, const SiteFrame&, double, double, int,
+                                     float*, float*, float*, Sgp4Resonance*);
+
+// počet vzorků a krok stopy průletu
+static int passTrackSteps(time_t aos, time_t los, int maxPts, double &step){
+  time_t dur=los-aos;
+  if(dur<=0 || maxPts<=0) return 0;
+  step=dur/(double)maxPts; if(step<PASS_TRACK_STEP_MIN) step=PASS_TRACK_STEP_MIN;
+  int n=(int)(dur/step)+1;
+  return n>maxPts?maxPts:n;
+}
+
+int samplePassTrack(const Sgp4Elements &sat, const SiteFrame &site, time_t aos, time_t los,
+                    float* az, float* el, int maxPts){
+  double step=0.0;
+  int n=passTrackSteps(aos,los,maxPts,step);
+  return n?propagateSeries<double>(sat,site,(double)aos,step,n,az,el,nullptr):0;
+}
+
+// ---- Chebyshev ephemeris ----
+// Clenshaw: sum c[k]*T_k(x), k=0..CHEB_DEG
+template<typename T>
+static inline T chebSum(const float* c, T x){
+  T b1=0, b2=0;
+  const T x2=x+x;
+  for(int k=CHEB_DEG;k>=1;k--){
+    T b=x2*b1-b2+(T)c[k];
+    b2=b1; b1=b;
+  }
+  return x*b1-b2+(T)c[0];
+}
+
+void chebBegin(ChebEphem &e, const Sgp4Elements &sat, double t0, ChebSeg* seg, int segMax){
+  e.t0=t0;
+  e.span=0;
+  e.seg=seg;
+  e.segMax=segMax;
+  e.segCount=0;
+  double period=(sat.rec.no>0.0)?2.0*M_PI/sat.rec.no*60.0:(double)CHEB_SEG_MAX_S;
+  e.lenMax=(uint32_t)clampd(period,(double)CHEB_SEG_MIN_S,(double)CHEB_SEG_MAX_S);
+  e.lenNext=e.lenMax;
+  e.errKm=0.0f;
+  e.fitCalls=0;
+  e.failed=false;
+  e.res=Sgp4Resonance{0.0,0.0,0.0};
+}
+
+// Fits seg over [e.t0+start, +len]; returns its error (km), <0 when SGP4 failed.
+static double chebFitSeg(ChebEphem &e, const Sgp4Elements &sat, ChebSeg &seg){
+  const int N=CHEB_DEG+1;
+  const double a=e.t0+seg.start, h=0.5*seg.len;
+  double f[N][3];
+  for(int j=0;j<N;j++){
+    double x=cos(M_PI*(j+0.5)/N);
+    e.fitCalls++;
+    if(!sgp4Pos<double>(sat,tsinceMin(sat,a+h*(x+1.0)),f[j],&e.res)) return -1.0;
+  }
+  for(int ax=0;ax<3;ax++){
+    for(int k=0;k<N;k++){
+      double sum=0.0;
+      for(int j=0;j<N;j++) sum+=f[j][ax]*cos(M_PI*k*(j+0.5)/N);
+      seg.c[ax][k]=(float)(sum*((k==0)?1.0:2.0)/N);
+    }
+  }
+
+  // kontrola: konce segmentu a středy mezi uzly
+  double err=0.0;
+  for(int j=-1;j<N;j++){
+    double x=(j<0)?1.0:(j==N-1)?-1.0:cos(M_PI*(j+1)/N);
+    double r[3];
+    e.fitCalls++;
+    if(!sgp4Pos<double>(sat,tsinceMin(sat,a+h*(x+1.0)),r,&e.res)) return -1.0;
+    double d2=0.0;
+    for(int ax=0;ax<3;ax++){
+      double d=(double)chebSum<float>(seg.c[ax],(float)x)-r[ax];
+      d2+=d*d;
+    }
+    if(d2>err*err) err=sqrt(d2);
+  }
+  // ocas řady + zaokrouhlení float Clenshawa mezi kontrolními body
+  double tail=0.0, sumAbs=0.0;
+  for(int ax=0;ax<3;ax++){
+    tail+=(double)seg.c[ax][CHEB_DEG]*seg.c[ax][CHEB_DEG];
+    for(int k=0;k<N;k++) sumAbs+=fabs((double)seg.c[ax][k]);
+  }
+  return err+sqrt(tail)+4.0*FLT_EPSILON*sumAbs;
+}
+
+bool chebFitStep(ChebEphem &e, const Sgp4Elements &sat, double tEnd){
+  if(e.failed || e.segCount>=e.segMax || e.t0+(double)e.span>=tEnd) return false;
+  ChebSeg &seg=e.seg[e.segCount];
+  seg.start=e.span;
+  uint32_t left=(uint32_t)ceil(tEnd-(e.t0+(double)e.span));
+  uint32_t len=(e.lenNext<left)?e.lenNext:left;
+  if(len<1) len=1;
+
+  double err;
+  while(true){
+    seg.len=len;
+    err=chebFitSeg(e,sat,seg);
+    if(err<0.0){ e.failed=true; return false; }
+    if(err<=CHEB_TOL_KM || len<=CHEB_SEG_MIN_S) break;
+    len/=2;
+    if(len<CHEB_SEG_MIN_S) len=CHEB_SEG_MIN_S;
+  }
+  if(err>e.errKm) e.errKm=(float)err;
+  e.span+=len;
+  e.segCount++;
+  // prošel napoprvé: další segment zkusí dvojnásobek
+  e.lenNext=(len*2<e.lenMax)?len*2:e.lenMax;
+  return e.t0+(double)e.span<tEnd && e.segCount<e.segMax;
+}
+
+bool chebFit(ChebEphem &e, const Sgp4Elements &sat, double t0, double tEnd, ChebSeg* seg, int segMax){
+  chebBegin(e,sat,t0,seg,segMax);
+  while(chebFitStep(e,sat,tEnd)){}
+  return chebCovers(e,tEnd);
+}
+
+template<typename T>
+bool chebPosition(const ChebEphem &e, double t, T r[3]){
+  if(!chebCovers(e,t)) return false;
+  double off=t-e.t0;
+  // poslední segment se start <= off
+  int lo=0, hi=e.segCount-1;
+  while(lo<hi){
+    int mid=(lo+hi+1)/2;
+    if((double)e.seg[mid].start<=off) lo=mid; else hi=mid-1;
+  }
+  const ChebSeg &seg=e.seg[lo];
+  T x=(T)(2.0*(off-seg.start)/seg.len-1.0);
+  r[0]=chebSum<T>(seg.c[0],x);
+  r[1]=chebSum<T>(seg.c[1],x);
+  r[2]=chebSum<T>(seg.c[2],x);
+  return true;
+}
+
+template bool chebPosition<float>(const ChebEphem&, double, float*);
+template bool chebPosition<double>(const ChebEphem&, double, double*);
+
+template<typename T>
+int ephemSeries(const ChebEphem &e, const SiteFrame &site, double t0, double dt, int n,
+                float* az, float* el, float* rangeKm){
+  return topoSeries<T>([&](int i, T r[3]){ return chebPosition<T>(e,t0+i*dt,r); },
+                       site,t0,dt,n,az,el,rangeKm);
+}
+
+template int ephemSeries<float>(const ChebEphem&, const SiteFrame&, double, double, int, float*, float*, float*);
+template int ephemSeries<double>(const ChebEphem&, const SiteFrame&, double, double, int, float*, float*, float*);
+
+int samplePassTrack(const ChebEphem &e, const SiteFrame &site, time_t aos, time_t los,
+                    float* az, float* el, int maxPts){
+  double step=0.0;
+  int n=passTrackSteps(aos,los,maxPts,step);
+  return n?ephemSeries<double>(e,site,(double)aos,step,n,az,el,nullptr):0;
+}
+
+// ---- illumination ----
+void sunCacheReset(SunCache &c){
+  c.minute=-1;
+  c.eci[0]=c.eci[1]=c.eci[2]=0.0;
+}
+
+void sunEci(double utc, double r[3]){
+  const double AU_KM=149597870.7;
+  double tut1=(utc/86400.0-10957.5)/36525.0;   // století od J2000.0
+  double meanLong=fmod(280.460+36000.77*tut1,360.0);
+  double meanAnom=deg2rad(fmod(357.5277233+35999.05034*tut1,360.0));
+  double eclLong=deg2rad(meanLong+1.914666471*sin(meanAnom)+0.019994643*sin(2.0*meanAnom));
+  double obliq=deg2rad(23.439291-0.0130042*tut1);
+  double mag=(1.000140612-0.016708617*cos(meanAnom)-0.000139589*cos(2.0*meanAnom))*AU_KM;
+  r[0]=mag*cos(eclLong);
+  r[1]=mag*cos(obliq)*sin(eclLong);
+  r[2]=mag*sin(obliq)*sin(eclLong);
+}
+
+const double* sunCached(SunCache &c, double utc){
+  int32_t minute=(int32_t)floor(utc/60.0);
+  if(minute!=c.minute){
+    sunEci(minute*60.0+30.0,c.eci);   // střed minuty
+    c.minute=minute;
+  }
+  return c.eci;
+}
+
+double sunElevationDeg(const SiteFrame &site, const double sunEciKm[3], double utc){
+  double gm=gstime(utc/86400.0+2440587.5);
+  double cg=cos(gm), sg=sin(gm);
+  double dx= cg*sunEciKm[0]+sg*sunEciKm[1]-site.ecef[0];
+  double dy=-sg*sunEciKm[0]+cg*sunEciKm[1]-site.ecef[1];
+  double dz=sunEciKm[2]-site.ecef[2];
+  const double (*m)[3]=site.sez;
+  double tZ=m[2][0]*dx+m[2][1]*dy+m[2][2]*dz;
+  double rho=sqrt(dx*dx+dy*dy+dz*dz);
+  return rad2deg(asin(clampd(tZ/rho,-1.0,1.0)));
+}
+
+// cylindrical Earth shadow (umbra/penumbra not distinguished)
+bool satSunlit(const double r[3], const double sun[3]){
+  double sn=sqrt(sun[0]*sun[0]+sun[1]*sun[1]+sun[2]*sun[2]);
+  double p=(r[0]*sun[0]+r[1]*sun[1]+r[2]*sun[2])/sn;
+  if(p>=0.0) return true;
+  double perp2=r[0]*r[0]+r[1]*r[1]+r[2]*r[2]-p*p;
+  return perp2>=EARTH_RE_KM*EARTH_RE_KM;
+}
+
+// pos(r) is called only when the QTH is dark
+template<typename PosFn>
+static int visibility(PosFn pos, const SiteFrame &site, SunCache &sun, double utc, float elDeg){
+  if(elDeg<0.0f) return SAT_VIS_BELOW;
+  const double* s=sunCached(sun,utc);
+  if(sunElevationDeg(site,s,utc)>SUN_DARK_EL_DEG) return SAT_VIS_DAY;
+  double r[3];
+  if(!pos(r)) return SAT_VIS_BELOW;
+  return satSunlit(r,s)?SAT_VIS_SUNLIT:SAT_VIS_ECLIPSED;
+}
+
+int satVisibility(const Sgp4Elements &sat, const SiteFrame &site, SunCache &sun, double utc, float elDeg){
+  return visibility([&](double r[3]){ return sgp4Pos<double>(sat,tsinceMin(sat,utc),r,nullptr); },
+                    site,sun,utc,elDeg);
+}
+
+int satVisibility(const ChebEphem &e, const SiteFrame &site, SunCache &sun, double utc, float elDeg){
+  return visibility([&](double r[3]){ return chebPosition<double>(e,utc,r); },site,sun,utc,elDeg);
+}
+
+// ---- optical passes ----
+const char* opticalClassName(uint8_t cls){
+  switch(cls){
+    case OPT_BRIGHT:  return "bright";
+    case OPT_VISIBLE: return "visible";
+    default:          return "faint";
+  }
+}
+
+struct OptSample {
+  bool  visible;   // osvětlený satelit a tmavá QTH
+  float el;        // deg (jen když visible)
+  float mag;
+};
+
+// pos(t,r) is called only when the QTH is dark
+template<typename PosFn>
+static OptSample opticalSample(PosFn pos, const SiteFrame &site, SunCache &sun, double t,
+                               float stdMag, uint32_t &calls){
+  OptSample o={false,-90.0f,99.0f};
+  const double* sv=sunCached(sun,t);
+  if(sunElevationDeg(site,sv,t)>SUN_DARK_EL_DEG) return o;
+  double r[3];
+  calls++;
+  if(!pos(t,r)) return o;
+  if(!satSunlit(r,sv)) return o;
+
+  // QTH a její zenit v TEME
+  double gm=gstime(t/86400.0+2440587.5), cg=cos(gm), sg=sin(gm);
+  const double* e=site.ecef;
+  const double* z=site.sez[2];
+  double d[3]={r[0]-(cg*e[0]-sg*e[1]), r[1]-(sg*e[0]+cg*e[1]), r[2]-e[2]};
+  double zt[3]={cg*z[0]-sg*z[1], sg*z[0]+cg*z[1], z[2]};
+  double rho=sqrt(d[0]*d[0]+d[1]*d[1]+d[2]*d[2]);
+  o.el=(float)rad2deg(asin(clampd((d[0]*zt[0]+d[1]*zt[1]+d[2]*zt[2])/rho,-1.0,1.0)));
+
+  // fázový úhel u satelitu: Slunce vs pozorovatel
+  double u[3]={sv[0]-r[0], sv[1]-r[1], sv[2]-r[2]};
+  double un=sqrt(u[0]*u[0]+u[1]*u[1]+u[2]*u[2]);
+  double ph=acos(clampd(-(u[0]*d[0]+u[1]*d[1]+u[2]*d[2])/(un*rho),-1.0,1.0));
+  double f=sin(ph)+(M_PI-ph)*cos(ph);   // difúzní koule, 1 při fázi 90°
+  o.mag=(f>1e-6)?(float)(stdMag+5.0*log10(rho/1000.0)-2.5*log10(f)):99.0f;
+  o.visible=true;
+  return o;
+}
+
+static uint8_t opticalClass(float mag){
+  if(mag<=OPT_MAG_BRIGHT) return OPT_BRIGHT;
+  if(mag<=OPT_MAG_VISIBLE) return OPT_VISIBLE;
+  return OPT_FAINT;
+}
+
+template<typename PosFn>
+static int opticalPassWindows(PosFn pos, const SiteFrame &site, SunCache &sun, const PassInfo &p,
+                              float stdMag, OpticalWindow* out, int maxOut, uint32_t* evals){
+  if(p.los<=p.aos || maxOut<=0) return 0;
+  const double ta=(double)p.aos, tb=(double)p.los;
+  // celý průlet ve dne (do hodiny se Slunce neotočí): bez SGP4
+  if(tb-ta<=3600.0 &&
+     sunElevationDeg(site,sunCached(sun,ta),ta)>SUN_DARK_EL_DEG &&
+     sunElevationDeg(site,sunCached(sun,tb),tb)>SUN_DARK_EL_DEG) return 0;
+
+  uint32_t calls=0;
+  int n=0;
+  OpticalWindow w={};
+  double tPrev=ta;
+  OptSample prev=opticalSample(pos,site,sun,ta,stdMag,calls);
+  if(prev.visible){ w.start=p.aos; w.peak=p.aos; w.peakEl=prev.el; w.peakMag=prev.mag; }
+
+  for(double t=ta;t<tb;){
+    t=(t+OPT_STEP_S<tb)?t+OPT_STEP_S:tb;
+    OptSample cur=opticalSample(pos,site,sun,t,stdMag,calls);
+    if(cur.visible!=prev.visible){
+      // hranice (stín, soumrak) na OPT_TOL_S
+      double lo=tPrev, hi=t;
+      OptSample sHi=cur;
+      while(hi-lo>OPT_TOL_S){
+        double mid=0.5*(lo+hi);
+        OptSample m=opticalSample(pos,site,sun,mid,stdMag,calls);
+        if(m.visible==prev.visible) lo=mid; else { hi=mid; sHi=m; }
+      }
+      if(cur.visible){
+        w.start=(time_t)ceil(hi); w.peak=w.start; w.peakEl=sHi.el; w.peakMag=sHi.mag;
+      } else {
+        w.end=(time_t)floor(lo);
+        if(n<maxOut && w.end>w.start){ w.cls=opticalClass(w.peakMag); out[n++]=w; }
+      }
+    }
+    if(cur.visible && cur.mag<w.peakMag){ w.peak=(time_t)lround(t); w.peakEl=cur.el; w.peakMag=cur.mag; }
+    tPrev=t; prev=cur;
+  }
+  if(prev.visible && n<maxOut){
+    w.end=p.los;
+    if(w.end>w.start){ w.cls=opticalClass(w.peakMag); out[n++]=w; }
+  }
+
+  // maximum průletu bývá nejjasnější, vzorkování po OPT_STEP_S ho mine
+  for(int i=0;i<n;i++){
+    if(p.tMax<out[i].start || p.tMax>out[i].end) continue;
+    OptSample m=opticalSample(pos,site,sun,(double)p.tMax,stdMag,calls);
+    if(m.visible && m.mag<out[i].peakMag){
+      out[i].peak=p.tMax; out[i].peakEl=m.el; out[i].peakMag=m.mag;
+      out[i].cls=opticalClass(m.mag);
+    }
+  }
+  if(evals) *evals+=calls;
+  return n;
+}
+
+int opticalWindows(const Sgp4Elements &sat, const SiteFrame &site, SunCache &sun, const PassInfo &p,
+                   float stdMag, OpticalWindow* out, int maxOut, uint32_t* sgp4Calls){
+  return opticalPassWindows([&](double t, double r[3]){ return sgp4Pos<double>(sat,tsinceMin(sat,t),r,nullptr); },
+                            site,sun,p,stdMag,out,maxOut,sgp4Calls);
+}
+
+int opticalWindows(const ChebEphem &e, const SiteFrame &site, SunCache &sun, const PassInfo &p,
+                   float stdMag, OpticalWindow* out, int maxOut, uint32_t* evals){
+  return opticalPassWindows([&](double t, double r[3]){ return chebPosition<double>(e,t,r); },
+                            site,sun,p,stdMag,out,maxOut,evals);
+}
+
+// PassRangeState::phase a výsledek rangeStep()
+enum { PR_INIT, PR_BACKTRACK, PR_SCAN, PR_FINISH, PR_DONE };
+enum { RANGE_MORE, RANGE_DONE, RANGE_FULL };
+
+void initPassSearch(PassSearch &ps, const Sgp4Elements &sat, const char* l1, const char* l2,
+                    uint8_t satIdx, float minElDeg, double qthLatDeg, double qthLonDeg,
+                    double qthAltM, bool prefilter, time_t nowUtc){
+  ps.sat=&sat;
+  ps.res=Sgp4Resonance{0.0,0.0,0.0};
+  ps.satIdx=satIdx;
+  ps.bound=passStepBound(l2,minElDeg,qthAltM);
+  ps.regime=orbitRegime(l2);
+  ps.orbit=prefilter?orbitMeanFromTle(l1,l2):OrbitMean{};
+  initSiteFrame(ps.site,qthLatDeg,qthLonDeg,qthAltM);
+  ps.coarseF32=true;
+  ps.minElDeg=minElDeg;
+  ps.qthLatDeg=qthLatDeg;
+  ps.qthLonDeg=qthLonDeg;
+  ps.qthAltM=qthAltM;
+  ps.nowUtc=nowUtc;
+  ps.out=nullptr;
+  ps.outMax=0;
+  ps.outCount=0;
+  ps.overflowAos=0;
+  ps.searchCalls=0;
+  ps.refineEvals=0;
+  ps.phase=PS_IDLE;
+  ps.winCount=-1;
+  ps.winIdx=0;
+  ps.tPrev=0;
+  ps.range.phase=PR_DONE;
+}
+
+// one sample of the series kernel
+template<typename T>
+static SatState evalAt(PassSearch &ps, double t){
+  SatState s{};
+  if(propagateSeries<T>(*ps.sat,ps.site,t,0.0,1,&s.az,&s.el,&s.distKm,&ps.res)!=1) s.el=-90.0f;
+  return s;
+}
+
+SatState searchEval(PassSearch &ps, double t){
+  ps.searchCalls++;
+  return ps.coarseF32?evalAt<float>(ps,t):evalAt<double>(ps,t);
+}
+
+SatState refineEval(PassSearch &ps, double t){
+  ps.searchCalls++;
+  return evalAt<double>(ps,t);
+}
+
+// Earth central angle (deg) between the QTH and the sub-satellite point
+double centralAngleDeg(const SatState &s, double qthAltM){
+  double ro=EARTH_RE_KM+qthAltM/1000.0;
+  double d=s.distKm;
+  double rs=sqrt(ro*ro+d*d+2.0*ro*d*sin(deg2rad(s.el)));
+  double c=(ro*ro+rs*rs-d*d)/(2.0*ro*rs);
+  return rad2deg(acos(clampd(c,-1.0,1.0)));
+}
+
+// Locates the minEl crossing inside [tLo,tHi] (elevation above minEl on exactly
+// one end) by Illinois regula falsi, to PASS_BISECT_TOL. Returns the time on the
+// "above" side of the final bracket and its azimuth.
+double findElCrossing(PassSearch &ps, double tLo, const SatState &sLo,
+                      double tHi, const SatState &sHi, float &azOut){
+  float fLo=sLo.el-ps.minElDeg, fHi=sHi.el-ps.minElDeg;
+  float azLo=sLo.az, azHi=sHi.az;
+  const bool risingAtHi=fHi>0;
+  const double guard=0.5*PASS_BISECT_TOL;
+  int side=0;
+
+  while(tHi-tLo>PASS_BISECT_TOL){
+    double tm=(tLo*fHi-tHi*fLo)/(fHi-fLo);
+    tm=clampd(tm,tLo+guard,tHi-guard);
+    SatState m=refineEval(ps,tm);
+    float fm=m.el-ps.minElDeg;
+    if((fm>0)==(fHi>0)){
+      tHi=tm; fHi=fm; azHi=m.az;
+      if(side==1) fLo*=0.5f;
+      side=1;
+    } else {
+      tLo=tm; fLo=fm; azLo=m.az;
+      if(side==-1) fHi*=0.5f;
+      side=-1;
+    }
+  }
+  azOut=risingAtHi?azHi:azLo;
+  return risingAtHi?tHi:tLo;
+}
+
+// Brent's method (parabolic interpolation with golden-section fallback) on
+// elevation(t), bracketed by the in-pass step around the coarse tMax and
+// clipped to [aos,los]. Converges to PASS_MAX_TOL; returns the number of SGP4
+// evaluations it used.
+int refinePassMax(PassSearch &ps, PassInfo &p, double halfWidth){
+  if(p.tMax==0) return 0;
+  double a=(double)p.tMax-halfWidth;
+  double b=(double)p.tMax+halfWidth;
+  if(a<(double)p.aos) a=(double)p.aos;
+  if(b>(double)p.los) b=(double)p.los;
+  if(b<=a) return 0;
+
+  const double CGOLD=0.3819660;
+  const double tol1=0.5*PASS_MAX_TOL, tol2=2.0*tol1;
+
+  // minimalizuje se -el(t)
+  double x=(double)p.tMax, w=x, v=x;
+  SatState sx=evalAt<double>(ps,x);
+  int evals=1;
+  double fx=-sx.el, fw=fx, fv=fx;
+  float bestAz=sx.az;
+  double d=0.0, e=0.0;
+
+  for(int it=0;it<PASS_MAX_ITER;it++){
+    double xm=0.5*(a+b);
+    if(fabs(x-xm)<=tol2-0.5*(b-a)) break;
+
+    if(fabs(e)>tol1){
+      double r=(x-w)*(fx-fv);
+      double q=(x-v)*(fx-fw);
+      double pp=(x-v)*q-(x-w)*r;
+      q=2.0*(q-r);
+      if(q>0.0) pp=-pp;
+      q=fabs(q);
+      double eOld=e; e=d;
+      if(fabs(pp)>=fabs(0.5*q*eOld) || pp<=q*(a-x) || pp>=q*(b-x)){
+        e=(x>=xm)?a-x:b-x; d=CGOLD*e;
+      } else {
+        d=pp/q;
+        double u=x+d;
+        if(u-a<tol2 || b-u<tol2) d=(xm>=x)?tol1:-tol1;
+      }
+    } else {
+      e=(x>=xm)?a-x:b-x; d=CGOLD*e;
+    }
+
+    double u=(fabs(d)>=tol1)?x+d:x+((d>=0.0)?tol1:-tol1);
+    SatState su=evalAt<double>(ps,u);
+    evals++;
+    double fu=-su.el;
+
+    if(fu<=fx){
+      if(u>=x) a=x; else b=x;
+      v=w; fv=fw; w=x; fw=fx; x=u; fx=fu;
+      bestAz=su.az;
+    } else {
+      if(u<x) a=u; else b=u;
+      if(fu<=fw || w==x){ v=w; fv=fw; w=u; fw=fu; }
+      else if(fu<=fv || v==x || v==w){ v=u; fv=fu; }
+    }
+  }
+
+  p.tMax=(time_t)lround(x); p.maxEl=(float)-fx; p.maxAz=bestAz;
+  return evals;
+}
+
+// Stores a finished pass (refined) unless it already ended before nowUtc.
+// Returns false when the output buffer is full.
+bool addPass(PassSearch &ps, time_t aos, time_t los, time_t tMax,
+             float maxEl, float aosAz, float maxAz, float losAz, double maxHalfWidth){
+  if((double)(los-aos)<PASS_MIN_DURATION) return true;
+  if(los<=ps.nowUtc) return true;
+  if(ps.outCount>=ps.outMax){ ps.overflowAos=aos; return false; }
+  PassInfo p={aos,los,tMax,maxEl,aosAz,maxAz,losAz,ps.satIdx};
+  ps.refineEvals+=refinePassMax(ps,p,maxHalfWidth);
+  ps.out[ps.outCount++]=p;
+  return true;
+}
+
+// Step in which a high orbit cannot move limitDeg across the sky: the ECEF
+// speed bound (vis-viva + Earth rotation at apogee) at the lowest radius
+// the satellite can fall to within the step, over the shortest range from
+// that radius. The radius comes from the sample's range and elevation. The
+// first estimate uses the current radius; the second, shorter one is
+// conservative, since the radius reachable within it is only higher.
+static double skyRateDps(const PassStepBound &b, double rKm){
+  if(rKm<b.rpKm) rKm=b.rpKm;
+  double v=sqrt(EARTH_MU_KM3S2*(2.0/rKm-1.0/b.aKm))+EARTH_OMEGA*b.raKm;
+  return rad2deg(v/(rKm-b.roKm))*EL_RATE_SAFETY;
+}
+
+static double highOrbitStep(const PassSearch &ps, const SatState &s, double limitDeg){
+  const PassStepBound &b=ps.bound;
+  double rho=s.distKm, sinEl=sin(deg2rad(s.el));
+  double r=sqrt(b.roKm*b.roKm+rho*rho+2.0*b.roKm*rho*sinEl);
+  double dt=limitDeg/skyRateDps(b,r);
+  return limitDeg/skyRateDps(b,r-b.vrMaxKms*dt);
+}
+
+// GEO: the elevation sampled every GEO_STEP_S over [t0,t1]; between the
+// samples it cannot move more than geoKms allows in half a step. Returns
+// 1 when above minEl throughout, -1 when below throughout, 0 when it may
+// cross (then the range is searched normally).
+static int geoRangeSide(PassSearch &ps, double t0, double t1){
+  const PassStepBound &b=ps.bound;
+  if(b.geoKms<=0.0 || b.aKm<=0.0) return 0;
+  double margin=rad2deg(b.geoKms/(b.rpKm-b.roKm))*0.5*GEO_STEP_S;
+  float lo=90.0f, hi=-90.0f;
+  for(double t=t0;;t+=GEO_STEP_S){
+    if(t>t1) t=t1;
+    SatState s=searchEval(ps,t);
+    if(s.el<lo) lo=s.el;
+    if(s.el>hi) hi=s.el;
+    if(t>=t1) break;
+  }
+  if(lo-margin>ps.minElDeg) return 1;
+  if(hi+margin<ps.minElDeg) return -1;
+  return 0;
+}
+
+// the coarse maximum is at most one step (either side) from the true one
+static double maxHalfWidth(const PassRangeState &r){
+  return 2.0*((r.stepMax>PASS_STEP_IN_PASS)?r.stepMax:PASS_STEP_IN_PASS);
+}
+
+// searchPassRange() split into steps on ps.range: rangeStep() does one
+// coarse step (with its AOS/LOS refinement) or one backtracking step, so a
+// search can be suspended between any two (passSearchAdvance).
+static void rangeBegin(PassSearch &ps, double tFrom, double tStart, double tEnd){
+  PassRangeState &r=ps.range;
+  r.phase=PR_INIT;
+  r.tFrom=tFrom; r.tStart=tStart; r.tEnd=tEnd;
+  r.tStop=tEnd+PASS_OVERRUN_MAX;
+}
+
+static int rangeStep(PassSearch &ps){
+  PassRangeState &r=ps.range;
+  const float minEl=ps.minElDeg;
+
+  switch(r.phase){
+  case PR_INIT:
+    r.t=r.tStart;
+    r.s=searchEval(ps,r.t);
+    r.above=r.s.el>minEl;
+    r.skipping=r.above;
+    r.aos=r.t; r.tMax=r.t; r.aosAz=r.s.az; r.maxEl=r.s.el; r.maxAz=r.s.az;
+    r.stepMax=0.0;
+    // uvnitř okna prefiltru: dohledat AOS zpětně
+    if(r.above && r.tStart>r.tFrom){ r.tb=r.t; r.b=r.s; r.phase=PR_BACKTRACK; }
+    else r.phase=PR_SCAN;
+    return RANGE_MORE;
+
+  case PR_BACKTRACK: {
+    if(!(r.b.el>minEl && r.tb>r.tFrom)){ r.phase=PR_SCAN; return RANGE_MORE; }
+    double tp=r.tb-3*PASS_STEP_IN_PASS;
+    if(tp<r.tFrom) tp=r.tFrom;
+    SatState p=searchEval(ps,tp);
+    if(p.el>minEl && p.el>r.maxEl){ r.maxEl=p.el; r.tMax=tp; r.maxAz=p.az; }
+    if(p.el<=minEl){
+      r.aos=findElCrossing(ps,tp,p,r.tb,r.b,r.aosAz);
+      r.skipping=false;
+    }
+    r.tb=tp; r.b=p;
+    return RANGE_MORE;
+  }
+
+  case PR_SCAN: {
+    if(!(r.t<r.tEnd || (r.above && !r.skipping && r.t<r.tStop))){ r.phase=PR_FINISH; return RANGE_MORE; }
+    // HEO/GEO: lokální mez z výšky satelitu
+    const bool high=ps.regime!=ORBIT_LEO && ps.bound.aKm>0.0;
+    double step;
+    if(r.above){
+      if(high){
+        double lim=r.s.el-minEl;
+        if(lim>HEO_ANGLE_IN_PASS) lim=HEO_ANGLE_IN_PASS;
+        step=clampd(highOrbitStep(ps,r.s,lim),PASS_STEP_MIN,HEO_STEP_IN_PASS);
+      } else {
+        step=clampd((r.s.el-minEl)/ps.bound.elAboveDps,PASS_STEP_MIN,PASS_STEP_IN_PASS);
+      }
+    } else {
+      double stepEl=(minEl-r.s.el)/ps.bound.elBelowDps;
+      double stepPsi=(centralAngleDeg(r.s,ps.qthAltM)-ps.bound.psiVisDeg)/ps.bound.psiDps;
+      if(stepPsi>stepEl) stepEl=stepPsi;
+      if(high){
+        double stepHigh=highOrbitStep(ps,r.s,minEl-r.s.el);
+        if(stepHigh>stepEl) stepEl=stepHigh;
+      }
+      step=clampd(stepEl,PASS_STEP_MIN,PASS_STEP_MAX);
+    }
+
+    double tNext=r.t+step;
+    if(r.t<r.tEnd && tNext>r.tEnd) tNext=r.tEnd;
+    SatState n=searchEval(ps,tNext);
+    bool nAbove=n.el>minEl;
+    if(r.above && tNext-r.t>r.stepMax) r.stepMax=tNext-r.t;
+
+    if(!r.above && nAbove){
+      r.aos=findElCrossing(ps,r.t,r.s,tNext,n,r.aosAz);
+      r.maxEl=n.el; r.tMax=tNext; r.maxAz=n.az;
+      r.stepMax=0.0;
+    } else if(r.above && nAbove){
+      if(n.el>r.maxEl){ r.maxEl=n.el; r.tMax=tNext; r.maxAz=n.az; }
+    } else if(r.above && !nAbove){
+      if(r.skipping){
+        r.skipping=false;
+      } else {
+        float losAz;
+        double los=findElCrossing(ps,r.t,r.s,tNext,n,losAz);
+        if(!addPass(ps,(time_t)lround(r.aos),(time_t)lround(los),(time_t)lround(r.tMax),
+                    r.maxEl,r.aosAz,r.maxAz,losAz,maxHalfWidth(r))) return RANGE_FULL;
+      }
+    }
+
+    r.t=tNext; r.s=n; r.above=nAbove;
+    return RANGE_MORE;
+  }
+
+  case PR_FINISH:
+    if(r.above && !r.skipping){
+      if(!addPass(ps,(time_t)lround(r.aos),(time_t)lround(r.t),(time_t)lround(r.tMax),
+                  r.maxEl,r.aosAz,r.maxAz,r.s.az,maxHalfWidth(r))) return RANGE_FULL;
+    }
+    r.phase=PR_DONE;
+    return RANGE_DONE;
+
+  default:
+    return RANGE_DONE;
+  }
+}
+
+// Searches one satellite for passes with AOS in [startUtc,endUtc). A pass
+// already in progress at startUtc belongs to the previous range and is
+// skipped; a pass in progress at endUtc is followed to its LOS, so adjacent
+// ranges never split or duplicate a pass. Below the horizon the step is the
+// largest one in which neither the elevation nor the central angle can reach
+// the visibility limit under passStepBound(), so no pass longer than
+// PASS_STEP_MIN can be stepped over; AOS/LOS are then refined to
+// PASS_BISECT_TOL by findElCrossing(). Stops early (overflowAos set) when the
+// output buffer is full.
+// Searches [tStart,tEnd). tFrom <= tStart is where the caller's previous
+// search stopped: a satellite already above at tStart is traced back to its
+// AOS, unless that lies before tFrom (then the pass belongs to the range
+// before). Returns the time the search stopped, or -1 when out is full.
+double searchPassRange(PassSearch &ps, double tFrom, double tStart, double tEnd){
+  rangeBegin(ps,tFrom,tStart,tEnd);
+  int st;
+  while((st=rangeStep(ps))==RANGE_MORE){}
+  return st==RANGE_FULL?-1:ps.range.t;
+}
+
+// Searches passes with AOS in [startUtc,endUtc). With a valid orbit the
+// search runs only inside the prefilter windows; if the orbit is outside
+// the prefilter's assumptions or yields too many windows, the whole range is
+// searched.
+void passSearchBegin(PassSearch &ps, time_t startUtc, time_t endUtc){
+  ps.winCount=-1;
+  ps.winIdx=0;
+  if(ps.orbit.valid){
+    double limit=ps.bound.psiVisDeg;
+    ps.winCount=prefilterWindows(ps.orbit,ps.qthLatDeg,ps.qthLonDeg,limit,
+                                 (double)startUtc,(double)endUtc,
+                                 ps.winStart,ps.winEnd,PREFILTER_MAX_WINDOWS);
+  }
+  ps.tPrev=(double)startUtc;
+  // GEO celé nad nebo pod minEl: žádný průlet, jen stálé nasměrování
+  if(ps.regime==ORBIT_GEO && geoRangeSide(ps,(double)startUtc,(double)endUtc)!=0){
+    ps.phase=PS_DONE;
+    return;
+  }
+  if(ps.winCount<0){
+    rangeBegin(ps,(double)startUtc,(double)startUtc,(double)endUtc);
+    ps.phase=PS_RANGE;
+  } else {
+    ps.phase=PS_NEXT_WINDOW;
+  }
+}
+
+bool passSearchAdvance(PassSearch &ps, PassClockUs clockUs, uint32_t deadlineUs){
+  while(true){
+    if(ps.phase==PS_DONE || ps.phase==PS_IDLE) return true;
+    if(ps.phase==PS_NEXT_WINDOW){
+      if(ps.winIdx>=ps.winCount){ ps.phase=PS_DONE; return true; }
+      int w=ps.winIdx++;
+      double a=(ps.winStart[w]>ps.tPrev)?ps.winStart[w]:ps.tPrev;
+      if(a>=ps.winEnd[w]) continue;
+      rangeBegin(ps,ps.tPrev,a,ps.winEnd[w]);
+      ps.phase=PS_RANGE;
+    }
+
+    int st=rangeStep(ps);
+    if(st==RANGE_FULL){ ps.phase=PS_DONE; return true; }
+    if(st==RANGE_DONE){
+      if(ps.winCount<0){ ps.phase=PS_DONE; return true; }
+      ps.tPrev=ps.range.t;
+      ps.phase=PS_NEXT_WINDOW;
+    }
+    if(clockUs && (int32_t)(clockUs()-deadlineUs)>=0) return false;
+  }
+}
+
+void searchSatPasses(PassSearch &ps, time_t startUtc, time_t endUtc){
+  passSearchBegin(ps,startUtc,endUtc);
+  passSearchAdvance(ps,nullptr,0);
+}
+
+int searchSatWindow(PassSearch &ps, time_t horizonUtc, time_t endUtc){
+  PassInfo* out=ps.out;
+  const int outMax=ps.outMax;
+  int count=0;
+
+  time_t h=horizonUtc;
+  while(h<endUtc && count<outMax){
+    time_t e=(h+PASS_JOB_CHUNK<endUtc)?h+PASS_JOB_CHUNK:endUtc;
+    ps.out=out+count;
+    ps.outMax=(outMax-count<PASS_JOB_MAX)?outMax-count:PASS_JOB_MAX;
+    ps.outCount=0;
+    ps.overflowAos=0;
+    searchSatPasses(ps,h,e);
+    count+=ps.outCount;
+    h=(ps.overflowAos!=0)?ps.overflowAos-1:e;
+  }
+
+  ps.out=out;
+  ps.outMax=outMax;
+  ps.outCount=count;
+  return count;
+}
+
+// ---- elevation profiles ----
+int sampleProfileArc(const Sgp4Elements &sat, const SiteFrame &site, const PassInfo &p,
+                     time_t base, ProfileArc &arc, ProfileSample* out, int outMax,
+                     uint32_t* sgp4Calls){
+  long dur=(long)(p.los-p.aos);
+  if(dur<1) dur=1;
+  if(dur>65535) dur=65535;
+  double step=PROFILE_STEP_S;
+  if(dur>step*(PROFILE_ARC_SAMPLES-2)) step=ceil((double)dur/(PROFILE_ARC_SAMPLES-2));
+  const int n=(int)ceil(dur/step)+1;   // poslední vzorek v LOS nebo za ním
+  if(n>outMax || n>PROFILE_ARC_SAMPLES) return 0;
+
+  float az[PROFILE_ARC_SAMPLES], el[PROFILE_ARC_SAMPLES];
+  if(sgp4Calls) *sgp4Calls+=(uint32_t)n;
+  if(propagateSeries<float>(sat,site,(double)p.aos,step,n,az,el,nullptr)<n) return 0;
+
+  for(int i=0;i<n;i++){
+    long e=lroundf(el[i]*100.0f), a=lroundf(az[i]*100.0f)%36000;
+    out[i].el=(int16_t)(e<-9000?-9000:(e>9000?9000:e));
+    out[i].az=(uint16_t)(a<0?a+36000:a);
+  }
+  long maxOff=(long)(p.tMax-p.aos);
+  arc.aosOff=(uint32_t)(p.aos-base);
+  arc.dur=(uint16_t)dur;
+  arc.maxOff=(uint16_t)(maxOff<0?0:(maxOff>dur?dur:maxOff));
+  arc.maxEl=(int16_t)lroundf(p.maxEl*100.0f);
+  arc.maxAz=(uint16_t)(lroundf(p.maxAz*100.0f)%36000);
+  arc.step=(uint16_t)step;
+  arc.count=(uint8_t)n;
+  arc.satIdx=p.satIdx;
+  return n;
+}
+
+// Catmull-Rom between samples k and k+1 (u in [0,1]); the arc's ends get
+// a linearly extrapolated outer neighbour
+static double profileEl(const ProfileSample* s, int n, int k, double u){
+  const double p1=s[k].el, p2=s[k+1].el;
+  const double p0=k>0?s[k-1].el:2.0*p1-p2;
+  const double p3=k+2<n?s[k+2].el:2.0*p2-p1;
+  return 0.005*(2.0*p1+u*((p2-p0)+u*((2.0*p0-5.0*p1+4.0*p2-p3)+u*(3.0*(p1-p2)+p3-p0))));
+}
+
+// azimut lineárně po kratším oblouku
+static float profileAz(const ProfileSample* s, int k, double u){
+  double a0=s[k].az, d=(double)s[k+1].az-a0;
+  if(d>18000.0) d-=36000.0; else if(d<-18000.0) d+=36000.0;
+  double a=(a0+u*d)*0.01;
+  return (float)(a<0.0?a+360.0:(a>=360.0?a-360.0:a));
+}
+
+// minEl crossing of the curve between samples k and k+1 (the samples lie
+// on different sides), as u in [0,1]
+static double profileCrossing(const ProfileSample* s, int n, int k, double stepS, float minEl,
+                              bool rising){
+  double lo=0.0, hi=1.0;
+  while((hi-lo)*stepS>PASS_BISECT_TOL){
+    double mid=0.5*(lo+hi);
+    if((profileEl(s,n,k,mid)>minEl)==rising) hi=mid; else lo=mid;
+  }
+  return 0.5*(lo+hi);
+}
+
+int profilePasses(const ProfileArc &arc, const ProfileSample* samples, time_t base,
+                  float minElDeg, PassInfo* out, int outMax){
+  const ProfileSample* s=samples+arc.first;
+  const int n=arc.count;
+  const double step=arc.step;
+  const double aos=(double)(base+(time_t)arc.aosOff), los=aos+arc.dur;
+  const time_t tMax=(time_t)aos+arc.maxOff;
+  const float maxEl=arc.maxEl*0.01f, maxAz=arc.maxAz*0.01f;
+  if(maxEl<=minElDeg || n<2 || outMax<1) return 0;
+
+  if(minElDeg<=PROFILE_BASE_EL_DEG){
+    // celý oblouk, tak jak ho našlo hledání
+    double u=(los-aos)/step;
+    int k=(int)u; if(k>n-2) k=n-2;
+    out[0]={(time_t)aos,(time_t)los,tMax,maxEl,s[0].az*0.01f,maxAz,profileAz(s,k,u-k),arc.satIdx};
+    return 1;
+  }
+
+  int count=0;
+  bool above=s[0].el*0.01f>minElDeg;
+  double tA=aos;
+  float azA=s[0].az*0.01f;
+  int kTop=0;   // nejvyšší vzorek rozpracovaného průletu
+  bool gotMax=false;
+  auto emit=[&](double tL, float azL){
+    PassInfo p={(time_t)lround(tA),(time_t)lround(tL),tMax,maxEl,azA,maxAz,azL,arc.satIdx};
+    if(tMax>=p.aos && tMax<=p.los) gotMax=true;
+    else {
+      // druhý hrb: vrchol paraboly nejvyšším vzorkem a sousedy
+      int m=kTop;
+      double d=0.0, e=s[m].el;
+      if(m>0 && m+1<n){
+        double e0=s[m-1].el, e2=s[m+1].el, c=e0-2.0*e+e2;
+        if(c<0.0){ d=0.5*(e0-e2)/c; e-=0.25*(e0-e2)*d; }
+      }
+      p.tMax=(time_t)lround(aos+(m+d)*step);
+      p.maxEl=(float)(e*0.01);
+      p.maxAz=s[m].az*0.01f;
+    }
+    if((double)(p.los-p.aos)<PASS_MIN_DURATION || count>=outMax) return;
+    out[count++]=p;
+  };
+
+  for(int k=0;k+1<n;k++){
+    const bool nAbove=s[k+1].el*0.01f>minElDeg;
+    if(nAbove!=above){
+      double u=profileCrossing(s,n,k,step,minElDeg,nAbove);
+      double t=aos+(k+u)*step;
+      if(t>los) t=los;
+      if(nAbove){ tA=t; azA=profileAz(s,k,u); kTop=k+1; }
+      else emit(t,profileAz(s,k,u));
+    } else if(nAbove && s[k+1].el>s[kTop].el) kTop=k+1;
+    above=nAbove;
+  }
+  if(above) emit(los,s[n-1].az*0.01f);   // LOS useknuté PASS_OVERRUN_MAX
+
+  if(!gotMax){
+    // vrchol mezi vzorky pod minEl (tečný průlet): parabola z tMax ke
+    // krajním vzorkům na každé straně
+    const double tm=(double)tMax;
+    int k=(int)(arc.maxOff/step);
+    if(k>n-2) k=n-2;
+    const double t0=aos+k*step, t1=t0+step;
+    const double d0=maxEl-s[k].el*0.01, d1=maxEl-s[k+1].el*0.01;
+    const double h=maxEl-minElDeg;
+    if(d0<=0.0 || d1<=0.0 || tm<=t0 || tm>=t1) return count;
+    tA=tm-(tm-t0)*sqrt(h/d0);
+    double tL=tm+(t1-tm)*sqrt(h/d1);
+    azA=profileAz(s,k,(tA-t0)/step);
+    emit(tL,profileAz(s,k,(tL-t0)/step));
+  }
+  return count;
+}
@@ -0,0 +1,481 @@
+// sat_predict.h
+// Pass prediction core: SGP4 evaluation, adaptive-step pass search with the
+// analytic prefilter, AOS/LOS and maximum refinement. No Arduino API, so the
+// firmware (src/main.cpp) and the host tools (src/host/) run the same code
+// and get the same passes.
+#pragma once
+#include <stdint.h>
+#include <time.h>
+#include <Sgp4.h>
+#include "sgp4_core.h"
+
+struct SatState {
+  float az;
+  float el;
+  float distKm;
+  int   vis;
+};
+
+struct PassInfo {
+  time_t  aos;
+  time_t  los;
+  time_t  tMax;
+  float   maxEl;
+  float   aosAz;
+  float   maxAz;
+  float   losAz;
+  uint8_t satIdx;
+};
+
+// Uložený průlet (13 B): časy jako offsety od base, azimut po 360/256°,
+// elevace po 0.5°. Firmware drží tabulku v tomhle tvaru, host tools ho
+// umí vypsat, aby se výstupy daly porovnat.
+struct __attribute__((packed)) PassRec {
+  uint32_t aosOff;    // s od base
+  uint16_t dur;       // s, LOS - AOS
+  uint16_t maxOff;    // s, tMax - AOS
+  uint8_t  maxElQ;    // 0.5°
+  uint8_t  aosAzQ, maxAzQ, losAzQ;
+  uint8_t  satIdx;
+};
+
+uint8_t  quantAz(float az);
+float    dequantAz(uint8_t q);
+PassRec  encodePass(const PassInfo &p, time_t base);
+PassInfo decodePass(const PassRec &r, time_t base);
+
+// ---- adaptive-step pass search ----
+const double PASS_STEP_MIN     = 10.0;    // s, nejmenší krok (= původní pevný krok)
+const double PASS_STEP_MAX     = 1800.0;  // s, strop kroku pod obzorem
+const double PASS_STEP_IN_PASS = 20.0;    // s, strop kroku během průletu (hrubé tMax)
+const double PASS_BISECT_TOL   = 0.25;    // s, přesnost AOS/LOS
+const double PASS_MAX_TOL      = 0.1;     // s, přesnost tMax
+const int    PASS_MAX_ITER     = 40;      // strop iterací refinePassMax
+const time_t PASS_LOOKBACK     = 30*60;   // s, hledání probíhajícího průletu zpět
+const double PASS_OVERRUN_MAX  = 6*3600.0;// s, jak daleko za okno se dohledává LOS
+const double PASS_MIN_DURATION = 10.0;    // s, kratší "průlety" se zahazují
+const double EL_RATE_SAFETY    = 1.25;    // rezerva na zploštění Země apod.
+
+// Passes are searched in (satellite, chunk) pieces of PASS_JOB_CHUNK starting
+// at the satellite's horizon; firmware and host tools use the same chunking,
+// so their passes match to the second.
+const time_t PASS_JOB_CHUNK = 6*3600;  // s, délka úseku jednoho jobu
+const int    PASS_JOB_MAX   = 8;       // max průletů v jednom jobu
+
+const double EARTH_MU_KM3S2 = 398600.4418;
+const double EARTH_RE_KM    = 6378.137;
+const double EARTH_OMEGA    = 7.2921159e-5;  // rad/s
+
+const int TLE_LINE_MAX = 130;   // délka bufferu řádku TLE pro Sgp4::init()
+
+// pevné sloupce TLE -> double
+double tleField(const char* line, int col, int len);
+
+// Step bounds for one orbit, derived from the TLE mean motion and eccentricity:
+//  - |dEl/dt| (deg/s) while below minEl (range >= range at minEl from perigee)
+//    and while above (range >= perigee height),
+//  - |dPsi/dt| (deg/s) of the Earth central angle QTH - sub-satellite point,
+//    and the largest central angle at which minEl can be reached (at apogee).
+struct PassStepBound {
+  double elBelowDps;
+  double elAboveDps;
+  double psiDps;
+  double psiVisDeg;
+  // for the local bound of high orbits (highOrbitStep), 0 = unknown
+  double aKm, rpKm, raKm;  // velká poloosa, perigeum, apogeum (od středu Země)
+  double roKm;             // poloměr QTH
+  double vrMaxKms;         // největší radiální rychlost
+  double geoKms;           // GEO: strop rychlosti v ECEF (drift, e, i)
+};
+
+PassStepBound passStepBound(const char* l2, double minElDeg, double qthAltM);
+
+// ---- analytic pass prefilter ----
+const double PREFILTER_MARGIN_DEG     = 2.5;   // ° navíc k poloměru viditelnosti
+const double PREFILTER_MARGIN_DEG_DAY = 0.5;   // °/den stáří TLE (odpor atmosféry)
+const double PREFILTER_TIME_MARGIN    = 60.0;  // s na každou stranu okna
+const double PREFILTER_ECC_MAX        = 0.1;   // výstřednější dráhy bez prefiltru
+const double PREFILTER_PERIOD_MAX     = 225*60.0; // s, deep-space bez prefiltru
+const int    PREFILTER_MAX_WINDOWS    = 16;    // max oken v jednom jobu
+
+const double SGP4_RE_KM = 6378.135;   // WGS72, jako SGP4
+const double SGP4_J2    = 0.001082616;
+
+struct OrbitMean {
+  bool   valid;
+  double epochUtc;           // s
+  double incl, ecc;          // rad, -
+  double raan0, argp0, ma0;  // rad at epoch
+  double raanDot, argpDot, maDot;  // rad/s
+  double maDdot;             // rad/s^2, from the TLE ndot/2 term
+};
+
+double    tleEpochUtc(const char* l1);
+OrbitMean orbitMeanFromTle(const char* l1, const char* l2);
+double    gmstRad(double utc);
+double    wrapPi(double a);
+void      orbitQthGeometry(const OrbitMean &o, double latRad, double lonRad, double utc,
+                           double &dU, double &beta);
+int       prefilterWindows(const OrbitMean &o, double latDeg, double lonDeg, double limitDeg,
+                           double t0, double t1, double *winStart, double *winEnd, int maxWin);
+
+// ---- SGP4 ----
+// The library's Sgp4 object is only the independent reference (brute-force
+// check, bench); prediction propagates read-only Sgp4Elements
+// (sgp4_core.h), initialized once per TLE. Sgp4::init() parses the lines
+// in place, so it gets private copies and the caller's TLE (shared between
+// cores) stays untouched.
+bool initSgp4(Sgp4 &sat, const char* name, const char* l1, const char* l2);
+
+// ---- compact TLE record ----
+// A TLE set pre-parsed into scaled integers (72 B instead of two 80 B
+// lines). The fields keep the TLE's own decimal resolution, so
+// tleRecordLines() writes back lines with the same numbers (format
+// normalized, checksums recomputed) and the propagator initialized from
+// them is bit-identical to one initialized from the original text.
+struct TleRecord {
+  char     satnum[5];       // sloupce 3-7, i Alpha-5
+  char     cls;             // U/C/S
+  char     desig[8];        // mezinárodní označení
+  char     ephType;
+  uint8_t  epochYear;       // 2 číslice
+  uint16_t epochDay;        // celá část dne v roce
+  uint16_t elnum;
+  char     nddotExp[2];     // exponent jak je v TLE ("-0", "+0", "-4")
+  char     bstarExp[2];
+  uint32_t epochFrac;       // zlomek dne * 1e8
+  int32_t  ndot;            // ot./den^2 * 1e8
+  int32_t  nddotMant;       // ±ddddd: 0.ddddd * 10^exp
+  int32_t  bstarMant;
+  uint32_t incl, raan, argp, ma;   // ° * 1e4
+  uint32_t ecc;             // * 1e7
+  uint32_t meanMotion;      // ot./den * 1e8
+  uint32_t revnum;
+  bool     valid;
+};
+
+// false (r.valid too) when the lines are not a TLE set
+bool tleRecordFromLines(TleRecord &r, const char* l1, const char* l2);
+// l1, l2: TLE_LINE_MAX buffers
+void tleRecordLines(const TleRecord &r, char* l1, char* l2);
+bool initElements(Sgp4Elements &sat, const TleRecord &r);   // sgp4ElementsFromTle()
+
+// ---- orbit regimes ----
+// Each satellite is searched by the strategy of its regime, classified from
+// the TLE mean motion and eccentricity:
+//  - LEO: the adaptive search with the global step bounds from the perigee;
+//  - HEO (eccentric or deep space, e.g. Molniya): the same search, but the
+//    sky rate is bounded from the current geocentric radius, so steps grow
+//    to many minutes near apogee and shrink near perigee;
+//  - GEO: the elevation is sampled every GEO_STEP_S; a satellite that stays
+//    above or below minEl for the whole range has no passes, only a constant
+//    pointing. One that crosses minEl (inclined GSO at the edge of
+//    visibility) gets the HEO search.
+enum OrbitRegime : uint8_t { ORBIT_LEO, ORBIT_HEO, ORBIT_GEO };
+
+const double GEO_REV_PER_DAY   = 1.00273791;  // ot./hvězdný den
+const double GEO_REV_TOL       = 0.05;     // ot./den
+const double GEO_ECC_MAX       = 0.01;
+const double GEO_STEP_S        = 3600.0;   // s, vzorky elevace GEO
+const double HEO_STEP_IN_PASS  = 900.0;    // s, strop kroku během průletu HEO
+const double HEO_ANGLE_IN_PASS = 2.0;      // °, pohyb po obloze za krok v průletu (hrubé tMax)
+
+uint8_t     orbitRegime(double revPerDay, double ecc);
+uint8_t     orbitRegime(const char* l2);
+uint8_t     orbitRegime(const TleRecord &r);
+const char* orbitRegimeName(uint8_t regime);
+
+// ---- batched propagation ----
+// QTH constants for the topocentric transform (WGS-84, as the SGP4
+// library's site()), computed once per QTH instead of in every findsat():
+// the station's ECEF vector and the ECEF -> SEZ rotation.
+struct SiteFrame {
+  double sinLat, cosLat, sinLon, cosLon;
+  double ecef[3];     // km
+  double sez[3][3];   // řádky S, E, Z v ECEF
+};
+
+void initSiteFrame(SiteFrame &site, double latDeg, double lonDeg, double altM);
+
+// Propagates one satellite to t0, t0+dt, ... (n samples, UNIX s) and writes
+// azimuth/elevation (deg) and range (km) into caller-owned arrays; rangeKm
+// may be nullptr. SGP4 is sgp4Propagate() on the satellite's elements with
+// the epoch offset hoisted; the sun position and visibility that findsat()
+// adds are skipped. res is the caller's deep-space resonance state (see
+// Sgp4Resonance), nullptr = integrate from epoch. T is the precision of the
+// SGP4 periodics and the topocentric transform (sgp4_core.h): float for the
+// coarse pass scan, double for refinement and tracks. With a fixed step the
+// Earth rotation (TEME -> ECEF) is advanced by a constant rotation per
+// sample, so GMST and its sin/cos are evaluated once per series. Returns the
+// number of samples written (fewer when SGP4 fails, e.g. decay).
+template<typename T>
+int propagateSeries(const Sgp4Elements &sat, const SiteFrame &site, double t0, double dt, int n,
+                    float* az, float* el, float* rangeKm, Sgp4Resonance* res=nullptr);
+
+// Az/el along a pass for the radar trail: up to maxPts evenly spaced
+// samples from AOS, at least PASS_TRACK_STEP_MIN apart and not after LOS.
+// Returns the number of samples (= SGP4 calls).
+const double PASS_TRACK_STEP_MIN = 5.0;   // s
+int samplePassTrack(const Sgp4Elements &sat, const SiteFrame &site, time_t aos, time_t los,
+                    float* az, float* el, int maxPts);
+
+// ---- Chebyshev ephemeris ----
+// A satellite's TEME position over a time window as piecewise Chebyshev
+// polynomials, fitted once from SGP4 (double) so that later queries cost
+// a polynomial instead of SGP4. The position does not depend on the QTH or
+// minEl, so one fit serves every look angle until the TLE changes (the
+// pass search stays on SGP4). Each segment interpolates SGP4 at CHEB_DEG+1
+// Chebyshev nodes and is checked against SGP4 at the ends and halfway
+// between the nodes (where the interpolation error peaks), in float.
+// The segment's error is the largest checked difference plus the last
+// coefficient (the truncation tail between the checks); a segment over
+// CHEB_TOL_KM is halved, down to CHEB_SEG_MIN_S. Segment lengths start at
+// one orbit (at most CHEB_SEG_MAX_S) and adapt to the orbit, so a Molniya
+// gets short segments at perigee and long ones at apogee.
+const int      CHEB_DEG       = 14;      // 15 koeficientů na osu
+const double   CHEB_TOL_KM    = 0.1;     // 0.01° na 600 km
+const uint32_t CHEB_SEG_MIN_S = 60;
+const uint32_t CHEB_SEG_MAX_S = 6*3600;
+const int      CHEB_FIT_CALLS = 2*CHEB_DEG+3;   // SGP4 na jeden pokus o segment
+
+struct ChebSeg {
+  uint32_t start;                  // s od ChebEphem.t0
+  uint32_t len;                    // s
+  float    c[3][CHEB_DEG+1];       // km, TEME x/y/z
+};
+
+struct ChebEphem {
+  double   t0;           // UNIX s
+  uint32_t span;         // s pokrytých od t0 (konec posledního segmentu)
+  ChebSeg* seg;          // caller-owned, segMax
+  int      segMax;
+  int      segCount;
+  uint32_t lenMax;       // s, nejdelší segment (oběžná doba)
+  uint32_t lenNext;      // s, první pokus dalšího segmentu
+  float    errKm;        // největší chyba segmentu (kontrola + ocas)
+  uint32_t fitCalls;     // SGP4 spotřebované fitem
+  bool     failed;       // SGP4 selhala (zánik), dál se nefituje
+  Sgp4Resonance res;     // integrátor rezonance fitu (deep space)
+};
+
+// Starts an empty ephemeris at t0 in seg[segMax]; chebFitStep() appends
+// one segment (fitted from sat) and returns false once tEnd is covered, seg
+// is full or SGP4 failed. chebFit() runs it to the end and returns whether
+// [t0,tEnd] is covered.
+void chebBegin(ChebEphem &e, const Sgp4Elements &sat, double t0, ChebSeg* seg, int segMax);
+bool chebFitStep(ChebEphem &e, const Sgp4Elements &sat, double tEnd);
+bool chebFit(ChebEphem &e, const Sgp4Elements &sat, double t0, double tEnd, ChebSeg* seg, int segMax);
+
+inline bool chebCovers(const ChebEphem &e, double t){
+  return e.segCount>0 && t>=e.t0 && t<=e.t0+(double)e.span;
+}
+
+// TEME position (km) at UNIX t; false outside the fitted window
+template<typename T>
+bool chebPosition(const ChebEphem &e, double t, T r[3]);
+
+// propagateSeries() from the ephemeris: stops (returns fewer than n) at
+// the first sample outside the fitted window
+template<typename T>
+int ephemSeries(const ChebEphem &e, const SiteFrame &site, double t0, double dt, int n,
+                float* az, float* el, float* rangeKm);
+int samplePassTrack(const ChebEphem &e, const SiteFrame &site, time_t aos, time_t los,
+                    float* az, float* el, int maxPts);
+
+// ---- illumination ----
+// Sun position and satellite visibility, split off findsat() so that only
+// the consumers that show it pay for it (the pass search needs elevation
+// only). The sun moves ~0.25 deg per minute, so one vector per minute
+// serves every satellite. A SunCache has no lock: one per thread.
+const int    SAT_VIS_UNKNOWN  = -3;   // SatState.vis ještě nespočtené
+const int    SAT_VIS_BELOW    = -2;   // hodnoty jako satVis v knihovně
+const int    SAT_VIS_DAY      = -1;
+const int    SAT_VIS_ECLIPSED = 0;
+const int    SAT_VIS_SUNLIT   = 1;
+const double SUN_DARK_EL_DEG  = -6.0; // QTH ve tmě = Slunce pod -6° (občanský soumrak)
+
+struct SunCache {
+  int32_t minute;    // UNIX minuta vektoru, -1 = prázdná
+  double  eci[3];    // km, TEME (bez nutace, na směr Slunce to stačí)
+};
+
+void          sunCacheReset(SunCache &c);
+void          sunEci(double utc, double r[3]);   // low-precision (Vallado), ~0.01°
+const double* sunCached(SunCache &c, double utc);
+double        sunElevationDeg(const SiteFrame &site, const double sunEciKm[3], double utc);
+bool          satSunlit(const double rTemeKm[3], const double sunEciKm[3]);
+
+// Visibility as findsat()'s satVis (SAT_VIS_*) for a satellite already
+// propagated to elDeg at utc; costs one SGP4 position when el >= 0.
+int satVisibility(const Sgp4Elements &sat, const SiteFrame &site, SunCache &sun, double utc, float elDeg);
+// the same from the ephemeris (utc inside its window)
+int satVisibility(const ChebEphem &e, const SiteFrame &site, SunCache &sun, double utc, float elDeg);
+
+// ---- optical passes ----
+// Parts of a pass when the satellite is sunlit and the QTH is dark (sun
+// below SUN_DARK_EL_DEG), with the brightest moment. The sun comes from a
+// SunCache, so a pass in daylight costs no SGP4; otherwise the pass is
+// sampled every OPT_STEP_S and each change of state is bisected to
+// OPT_TOL_S. Brightness is a diffuse-sphere estimate from the standard
+// magnitude (1000 km, phase 90°), which TLEs don't carry.
+const double OPT_STEP_S      = 30.0;
+const double OPT_TOL_S       = 1.0;
+const int    OPT_WINDOWS_MAX = 2;      // stín + soumrak, víc v jednom průletu nebývá
+const float  OPT_STD_MAG     = 4.0f;   // typický malý satelit
+const float  OPT_MAG_BRIGHT  = 1.0f;   // hranice tříd jasu
+const float  OPT_MAG_VISIBLE = 3.5f;
+
+enum OpticalClass : uint8_t { OPT_FAINT=0, OPT_VISIBLE=1, OPT_BRIGHT=2 };
+
+struct OpticalWindow {
+  time_t  start, end, peak;
+  float   peakEl;    // deg, v čase peak
+  float   peakMag;   // odhad
+  uint8_t cls;       // OpticalClass
+};
+
+const char* opticalClassName(uint8_t cls);
+
+// Optical windows of pass p (sat = its elements), at most maxOut.
+// Returns the count; *sgp4Calls (optional) gets the SGP4 evaluations added.
+int opticalWindows(const Sgp4Elements &sat, const SiteFrame &site, SunCache &sun, const PassInfo &p,
+                   float stdMag, OpticalWindow* out, int maxOut, uint32_t* sgp4Calls=nullptr);
+// the same from the ephemeris (the whole pass inside its window);
+// *evals gets the polynomial evaluations
+int opticalWindows(const ChebEphem &e, const SiteFrame &site, SunCache &sun, const PassInfo &p,
+                   float stdMag, OpticalWindow* out, int maxOut, uint32_t* evals=nullptr);
+
+// ---- pass search ----
+// Where a resumable search stopped: the locals of searchPassRange() (one
+// prefilter window) ...
+struct PassRangeState {
+  uint8_t  phase;             // PR_*
+  double   tFrom, tStart, tEnd, tStop;
+  double   t;                 // poslední hrubý vzorek
+  SatState s;
+  bool     above, skipping;
+  double   aos, tMax;
+  float    aosAz, maxEl, maxAz;
+  double   tb;                // zpětné dohledání AOS
+  SatState b;
+  double   stepMax;           // největší krok v průletu (interval refinePassMax)
+};
+
+// ... and of searchSatPasses() (the window list).
+enum PassSearchPhase : uint8_t { PS_IDLE, PS_NEXT_WINDOW, PS_RANGE, PS_DONE };
+
+// State of one pass search: the satellite's elements (read only, owned by
+// the caller and shared by any number of searches, on any core, for as long
+// as the search lives) with this search's own resonance state, the search
+// parameters, the passes found and the resume point of an unfinished
+// passSearchAdvance().
+struct PassSearch {
+  const Sgp4Elements* sat;
+  Sgp4Resonance res;          // deep space: kurzor integrátoru tohoto hledání
+  uint8_t       satIdx;
+  PassStepBound bound;
+  uint8_t       regime;       // OrbitRegime
+  OrbitMean     orbit;        // valid: SGP4 only inside prefilter windows
+  SiteFrame     site;
+  bool          coarseF32;    // hrubé hledání ve float (false: vše v double)
+  float         minElDeg;
+  double        qthLatDeg, qthLonDeg, qthAltM;
+  time_t        nowUtc;
+
+  PassInfo*     out;
+  int           outMax;
+  int           outCount;
+  time_t        overflowAos;  // !=0: AOS of the first pass that did not fit
+
+  uint32_t      searchCalls;
+  uint32_t      refineEvals;
+
+  uint8_t       phase;        // PassSearchPhase
+  int           winCount;     // -1: bez prefiltru, celé rozmezí
+  int           winIdx;
+  double        winStart[PREFILTER_MAX_WINDOWS], winEnd[PREFILTER_MAX_WINDOWS];
+  double        tPrev;        // kde skončilo předchozí okno
+  PassRangeState range;
+};
+
+// Sets up ps for one satellite (sat: its elements, l1/l2: its TLE lines for
+// the step bounds and prefilter) and QTH; out/outMax are left to the caller.
+void initPassSearch(PassSearch &ps, const Sgp4Elements &sat, const char* l1, const char* l2,
+                    uint8_t satIdx, float minElDeg, double qthLatDeg, double qthLonDeg,
+                    double qthAltM, bool prefilter, time_t nowUtc);
+
+// Coarse scan sample (float unless ps.coarseF32 is off) and refinement
+// sample (double); both count as search calls.
+SatState searchEval(PassSearch &ps, double t);
+SatState refineEval(PassSearch &ps, double t);
+double   centralAngleDeg(const SatState &s, double qthAltM);
+double   findElCrossing(PassSearch &ps, double tLo, const SatState &sLo,
+                        double tHi, const SatState &sHi, float &azOut);
+// refinePassMax() looks for the maximum within ±halfWidth of p.tMax
+int      refinePassMax(PassSearch &ps, PassInfo &p, double halfWidth=2.0*PASS_STEP_IN_PASS);
+bool     addPass(PassSearch &ps, time_t aos, time_t los, time_t tMax,
+                 float maxEl, float aosAz, float maxAz, float losAz,
+                 double maxHalfWidth=2.0*PASS_STEP_IN_PASS);
+double   searchPassRange(PassSearch &ps, double tFrom, double tStart, double tEnd);
+void     searchSatPasses(PassSearch &ps, time_t startUtc, time_t endUtc);
+
+// searchSatPasses() as a resumable iterator, for cooperative scheduling:
+// passSearchBegin() computes the prefilter windows, each passSearchAdvance()
+// runs coarse steps (a step includes its AOS/LOS/maximum refinement) until
+// clockUs() reaches deadlineUs, and returns true once the search is
+// finished. At least one step is run per call, so any deadline makes
+// progress; clockUs=nullptr runs to the end. The passes are the same as
+// from one searchSatPasses() call, however the run is sliced.
+typedef uint32_t (*PassClockUs)();
+void passSearchBegin(PassSearch &ps, time_t startUtc, time_t endUtc);
+bool passSearchAdvance(PassSearch &ps, PassClockUs clockUs, uint32_t deadlineUs);
+
+// All passes of one satellite with AOS in [horizonUtc,endUtc), searched chunk
+// by chunk exactly like the firmware's job queue does. ps.out must hold
+// ps.outMax passes; returns the count (stops early when out is full).
+int searchSatWindow(PassSearch &ps, time_t horizonUtc, time_t endUtc);
+
+// ---- elevation profiles ----
+// Every pass above PROFILE_BASE_EL_DEG (one search at the horizon) kept as
+// az/el samples, so passes above any higher minEl follow from the samples
+// without SGP4: AOS/LOS from the crossings of a Catmull-Rom curve through
+// the samples (bisected to PASS_BISECT_TOL), the maximum from the arc's
+// refined tMax. A second hump of a HEO arc gets its maximum from a parabola
+// through the highest samples. Samples are int16 in 0.01° (4 B), a LEO arc
+// takes 15-30 of them.
+const float  PROFILE_BASE_EL_DEG = 0.0f;
+const double PROFILE_STEP_S      = 30.0;   // s, krok vzorků oblouku
+const int    PROFILE_ARC_SAMPLES = 128;    // delší oblouky (HEO) dostanou delší krok
+
+struct ProfileSample {
+  int16_t  el;         // 0.01°
+  uint16_t az;         // 0.01°
+};
+
+struct ProfileArc {
+  uint32_t aosOff;     // s od base, AOS nad PROFILE_BASE_EL_DEG = první vzorek
+  uint16_t dur;        // s, LOS - AOS
+  uint16_t maxOff;     // s, tMax - AOS (zpřesněné hledáním)
+  int16_t  maxEl;      // 0.01°
+  uint16_t maxAz;      // 0.01°
+  uint16_t step;       // s mezi vzorky
+  uint16_t first;      // index prvního vzorku v poolu volajícího
+  uint8_t  count;
+  uint8_t  satIdx;
+};
+
+// Samples pass p (found at PROFILE_BASE_EL_DEG) from AOS every arc.step
+// seconds up to the first sample at or after LOS, with SGP4 in float like
+// the coarse scan.
+// Fills arc except arc.first and returns the number of samples written to
+// out, 0 when they do not fit in outMax or propagation failed.
+int sampleProfileArc(const Sgp4Elements &sat, const SiteFrame &site, const PassInfo &p,
+                     time_t base, ProfileArc &arc, ProfileSample* out, int outMax,
+                     uint32_t* sgp4Calls=nullptr);
+
+// Passes above minElDeg within one arc (samples = the pool arc.first
+// indexes), with the search's rule that passes shorter than
+// PASS_MIN_DURATION are dropped. Usually one, none when the arc stays below, two for a HEO arc
+// that dips under minEl between its humps. Returns the count written.
+int profilePasses(const ProfileArc &arc, const ProfileSample* samples, time_t base,
+                  float minElDeg, PassInfo* out, int outMax);
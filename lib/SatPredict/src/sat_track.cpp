@@ -0,0 +1,97 @@
+// sat_track.cpp
+#include "sat_track.h"
+#include <math.h>
+
+static const double EARTH_RATE = 7.292115e-5;   // rad/s, otáčení Země (TEME -> ECEF)
+
+// SEZ position (km) and velocity (km/s) of the satellite from the site
+static bool sezState(const Sgp4Elements &e, const SiteFrame &site, double utc, TrackAnchor &out,
+                     Sgp4Resonance* res){
+  const double jd=utc/86400.0+2440587.5;
+  Sgp4State<double> st=sgp4Propagate<double>(e,(jd-e.rec.jdsatepoch)*1440.0,res);
+  if(st.error) return false;
+
+  // TEME -> ECEF, rychlost včetně rotace souřadnic
+  const double g=gstime(jd), c=cos(g), s=sin(g);
+  const double x= c*st.r[0]+s*st.r[1];
+  const double y=-s*st.r[0]+c*st.r[1];
+  const double vx= c*st.v[0]+s*st.v[1]+EARTH_RATE*y;
+  const double vy=-s*st.v[0]+c*st.v[1]-EARTH_RATE*x;
+  const double d[3]={x-site.ecef[0],y-site.ecef[1],st.r[2]-site.ecef[2]};
+  const double v[3]={vx,vy,st.v[2]};
+
+  out.t=utc;
+  for(int i=0;i<3;i++){
+    out.p[i]=(float)(site.sez[i][0]*d[0]+site.sez[i][1]*d[1]+site.sez[i][2]*d[2]);
+    out.v[i]=(float)(site.sez[i][0]*v[0]+site.sez[i][1]*v[1]+site.sez[i][2]*v[2]);
+  }
+  return true;
+}
+
+// az/el/range and rates from the SEZ vectors
+static void sezLook(double t, const float p[3], const float q[3], TrackLook &out){
+  const float R2D=(float)(180.0/M_PI);
+  const float h2=p[0]*p[0]+p[1]*p[1], h=sqrtf(h2);
+  const float rho=sqrtf(h2+p[2]*p[2]);
+  const float hDot=h>0.0f?(p[0]*q[0]+p[1]*q[1])/h:0.0f;
+
+  float az=atan2f(p[1],-p[0]);
+  if(az<0.0f) az+=(float)(2.0*M_PI);
+  out.t=t;
+  out.az=az*R2D;
+  out.el=atan2f(p[2],h)*R2D;
+  out.rangeKm=rho;
+  out.rangeRate=(p[0]*q[0]+p[1]*q[1]+p[2]*q[2])/rho;
+  // azimut v zenitu nedefinovaný, rychlost 0
+  out.azRate=h2>0.0f?(p[1]*q[0]-p[0]*q[1])/h2*R2D:0.0f;
+  out.elRate=(h*q[2]-p[2]*hDot)/(rho*rho)*R2D;
+}
+
+bool trackLook(const Sgp4Elements &e, const SiteFrame &site, double utc, TrackLook &out){
+  TrackAnchor a;
+  if(!sezState(e,site,utc,a,nullptr)) return false;
+  sezLook(utc,a.p,a.v,out);
+  return true;
+}
+
+void trackBegin(TrackInterp &tr, const Sgp4Elements &e, const SiteFrame &site){
+  tr.el=&e;
+  tr.site=&site;
+  tr.valid=false;
+  tr.anchors=0;
+  tr.res.atime=0.0;
+}
+
+static bool anchorAt(TrackInterp &tr, double utc, TrackAnchor &out){
+  tr.anchors++;
+  return sezState(*tr.el,*tr.site,utc,out,&tr.res);
+}
+
+bool trackAt(TrackInterp &tr, double utc, TrackLook &out){
+  if(tr.valid && utc>tr.b.t){
+    // posun o jednu kotvu; dál (zastavená smyčka) od začátku
+    if(utc<=tr.b.t+TRACK_ANCHOR_S){
+      tr.a=tr.b;
+      tr.valid=anchorAt(tr,tr.a.t+TRACK_ANCHOR_S,tr.b);
+    } else tr.valid=false;
+  }
+  if(!tr.valid || utc<tr.a.t){
+    tr.valid=anchorAt(tr,utc,tr.a) && anchorAt(tr,utc+TRACK_ANCHOR_S,tr.b);
+    if(!tr.valid) return false;
+  }
+
+  // kubický Hermite na [a.t,b.t] po složkách, derivace = rychlosti kotev
+  const TrackAnchor &a=tr.a, &b=tr.b;
+  const float h=(float)(b.t-a.t);
+  const float u=(float)((utc-a.t)/(b.t-a.t));
+  const float u2=u*u, u3=u2*u;
+  const float h00=2*u3-3*u2+1, h10=(u3-2*u2+u)*h, h01=3*u2-2*u3, h11=(u3-u2)*h;
+  const float d01=(6*u-6*u2)/h, d10=3*u2-4*u+1, d11=3*u2-2*u;
+  float p[3], q[3];
+  for(int i=0;i<3;i++){
+    p[i]=h00*a.p[i]+h10*a.v[i]+h01*b.p[i]+h11*b.v[i];
+    q[i]=d01*(b.p[i]-a.p[i])+d10*a.v[i]+d11*b.v[i];
+  }
+  sezLook(utc,p,q,out);
+  return true;
+}
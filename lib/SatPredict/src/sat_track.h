@@ -0,0 +1,48 @@
+// sat_track.h
+// High-rate tracking of one satellite: az/el/range and their rates at any
+// (sub-second) time, for the rotator and the radar dot. SGP4 runs only at
+// anchors TRACK_ANCHOR_S apart; each anchor keeps the satellite's position
+// and velocity in the QTH's SEZ frame (from sgp4Propagate(), with the Earth
+// rotation), and between two anchors both follow a cubic Hermite curve.
+// Az/el/range and their rates come from the interpolated vectors, so the
+// azimuth through zenith stays exact where interpolating angles would not.
+// A sample between anchors costs a few float multiplications and two
+// atan2, so 10 Hz output takes fewer SGP4 calls than a 1 Hz findsat().
+#pragma once
+#include "sgp4_core.h"
+#include "sat_predict.h"
+
+const double TRACK_ANCHOR_S = 10.0;   // s mezi kotvami
+
+struct TrackLook {
+  double t;                  // UNIX s
+  float  az, el, rangeKm;    // deg, deg, km
+  float  azRate, elRate;     // deg/s
+  float  rangeRate;          // km/s, + = vzdaluje se
+};
+
+struct TrackAnchor {
+  double t;                  // UNIX s
+  float  p[3], v[3];         // SEZ, km a km/s
+};
+
+// Look angles and rates of e at utc straight from SGP4 (double, one call);
+// false on an SGP4 error (decay).
+bool trackLook(const Sgp4Elements &e, const SiteFrame &site, double utc, TrackLook &out);
+
+struct TrackInterp {
+  const Sgp4Elements* el;    // volajícího, jen ke čtení
+  const SiteFrame*    site;
+  TrackAnchor a, b;          // kotvy, a.t <= t <= b.t
+  bool        valid;
+  uint32_t    anchors;       // volání SGP4
+  Sgp4Resonance res;        // deep space: rezonance pokračuje od minulé kotvy
+};
+
+// Tracks e from site; both stay owned by the caller and must outlive tr
+// (change either -> trackBegin() again).
+void trackBegin(TrackInterp &tr, const Sgp4Elements &e, const SiteFrame &site);
+// Interpolated look at utc. The anchors move forward with time (one SGP4
+// call per TRACK_ANCHOR_S); a jump back or past the next anchor starts
+// over at utc. False when SGP4 fails there.
+bool trackAt(TrackInterp &tr, double utc, TrackLook &out);
@@ -0,0 +1,374 @@
+// sgp4_batch.cpp
+// Struct-of-arrays SGP4 (sgp4_batch.h). Lane types: double/float (scalar,
+// libm) and, on x86-64, VD4/VF8 on AVX2 registers with Cephes polynomials
+// for sin/cos/atan (double ~1e-16, float ~1e-7 relative, like libm).
+#include "sgp4_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SGP4_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define SGP4_BATCH_X86 0
+#endif
+
+namespace {
+
+// pole konstant; od F_PER0 i ve float
+enum BatchField {
+  F_EPOCH, F_MO, F_MDOT, F_ARGPO, F_ARGPDOT, F_NODEO, F_NODEDOT, F_NODECF,
+  F_CC1, F_CC4B, F_CC5B, F_T2COF, F_T3COF, F_T4COF, F_T5COF, F_D2, F_D3, F_D4,
+  F_OMGCOF, F_XMCOF, F_ETA, F_DELMO, F_SINMAO, F_ECCO, F_NO, F_AM0,
+  F_AYCOF, F_XLCOF, F_CON41, F_X1MTH2, F_X7THM1, F_INCLO, F_SINIO, F_COSIO,
+  F_COUNT
+};
+const int F_PER0 = F_AYCOF;
+const int F_PER  = F_COUNT-F_AYCOF;
+
+// per call: Earth rotation and QTH (as topoSeries() in sat_predict.cpp)
+struct BatchTopo {
+  double cg, sg;
+  double m[3][3];
+  double sx, sy, sz;
+  double j2, reKm;
+};
+
+// Lane<V>: W satellites per value, D = lanes of the secular part (double),
+// E = element type; ldD/ldP load constants, join packs K double lanes
+// into one V, st stores V to E[W].
+template<class V> struct Lane;
+
+template<> struct Lane<double> {
+  typedef double D; typedef double E; enum { W=1 };
+  static double ldD(const double* p){ return *p; }
+  static double ldP(const double* pd, const float*){ return *pd; }
+  static double join(const double* d){ return d[0]; }
+  static void   st(double* o, double v){ o[0]=v; }
+  static double tol(){ return 1.0e-12; }
+};
+
+template<> struct Lane<float> {
+  typedef double D; typedef float E; enum { W=1 };
+  static float ldP(const double*, const float* pf){ return *pf; }
+  static float join(const double* d){ return (float)d[0]; }
+  static void  st(float* o, float v){ o[0]=v; }
+  static float tol(){ return 1.0e-6f; }
+};
+
+// ---- scalar lanes ----
+inline double vsel(bool m, double a, double b){ return m?a:b; }
+inline float  vsel(bool m, float a, float b){ return m?a:b; }
+inline bool   vany(bool m){ return m; }
+inline bool   vand(bool a, bool b){ return a&&b; }
+inline bool   vor(bool a, bool b){ return a||b; }
+inline double vabs(double x){ return fabs(x); }
+inline float  vabs(float x){ return fabsf(x); }
+inline double vsqrt(double x){ return sqrt(x); }
+inline float  vsqrt(float x){ return sqrtf(x); }
+inline double vsin(double x){ return sin(x); }
+inline double vcos(double x){ return cos(x); }
+inline void   vsincos(double x, double &s, double &c){ s=sin(x); c=cos(x); }
+inline void   vsincos(float x, float &s, float &c){ s=sinf(x); c=cosf(x); }
+inline double vatan2(double y, double x){ return atan2(y,x); }
+inline float  vatan2(float y, float x){ return atan2f(y,x); }
+inline double vfmod2pi(double x){ return fmod(x,2.0*M_PI); }
+inline float  vfmod2pi(float x){ return (float)fmod((double)x,2.0*M_PI); }   // jako sgp4_core
+// elevace jako v topoSeries(): asin s ořezem
+template<class T>
+inline T velev(T tZ, T, T, T rho){
+  T s=tZ/rho;
+  if(s>(T)1) s=(T)1;
+  if(s<(T)-1) s=(T)-1;
+  return sgpm::asin(s);
+}
+
+namespace scalar {
+#include "sgp4_batch_kernel.h"
+}
+
+}  // namespace
+
+// ====================== AVX2 ======================
+#if SGP4_BATCH_X86
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to=function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace {
+
+struct VD4 {
+  __m256d v;
+  VD4(){}
+  VD4(__m256d x):v(x){}
+  VD4(double x):v(_mm256_set1_pd(x)){}
+};
+struct MD4 { __m256d m; };
+
+struct VF8 {
+  __m256 v;
+  VF8(){}
+  VF8(__m256 x):v(x){}
+  VF8(float x):v(_mm256_set1_ps(x)){}
+};
+struct MF8 { __m256 m; };
+
+inline VD4 operator+(VD4 a, VD4 b){ return _mm256_add_pd(a.v,b.v); }
+inline VD4 operator-(VD4 a, VD4 b){ return _mm256_sub_pd(a.v,b.v); }
+inline VD4 operator*(VD4 a, VD4 b){ return _mm256_mul_pd(a.v,b.v); }
+inline VD4 operator/(VD4 a, VD4 b){ return _mm256_div_pd(a.v,b.v); }
+inline VD4 operator-(VD4 a){ return _mm256_xor_pd(a.v,_mm256_set1_pd(-0.0)); }
+inline MD4 operator<(VD4 a, VD4 b){ return {_mm256_cmp_pd(a.v,b.v,_CMP_LT_OQ)}; }
+inline MD4 operator<=(VD4 a, VD4 b){ return {_mm256_cmp_pd(a.v,b.v,_CMP_LE_OQ)}; }
+inline MD4 operator>(VD4 a, VD4 b){ return {_mm256_cmp_pd(a.v,b.v,_CMP_GT_OQ)}; }
+inline MD4 operator>=(VD4 a, VD4 b){ return {_mm256_cmp_pd(a.v,b.v,_CMP_GE_OQ)}; }
+inline MD4 operator==(VD4 a, VD4 b){ return {_mm256_cmp_pd(a.v,b.v,_CMP_EQ_OQ)}; }
+inline VD4  vsel(MD4 m, VD4 a, VD4 b){ return _mm256_blendv_pd(b.v,a.v,m.m); }
+inline bool vany(MD4 m){ return _mm256_movemask_pd(m.m)!=0; }
+inline MD4  vand(MD4 a, MD4 b){ return {_mm256_and_pd(a.m,b.m)}; }
+inline MD4  vor(MD4 a, MD4 b){ return {_mm256_or_pd(a.m,b.m)}; }
+inline VD4  vabs(VD4 x){ return _mm256_andnot_pd(_mm256_set1_pd(-0.0),x.v); }
+inline VD4  vsqrt(VD4 x){ return _mm256_sqrt_pd(x.v); }
+inline VD4  vfloor(VD4 x){ return _mm256_round_pd(x.v,_MM_FROUND_TO_NEG_INF|_MM_FROUND_NO_EXC); }
+inline VD4  vtrunc(VD4 x){ return _mm256_round_pd(x.v,_MM_FROUND_TO_ZERO|_MM_FROUND_NO_EXC); }
+inline VD4  vfmod2pi(VD4 x){ return x-vtrunc(x*VD4(1.0/(2.0*M_PI)))*VD4(2.0*M_PI); }
+
+inline VF8 operator+(VF8 a, VF8 b){ return _mm256_add_ps(a.v,b.v); }
+inline VF8 operator-(VF8 a, VF8 b){ return _mm256_sub_ps(a.v,b.v); }
+inline VF8 operator*(VF8 a, VF8 b){ return _mm256_mul_ps(a.v,b.v); }
+inline VF8 operator/(VF8 a, VF8 b){ return _mm256_div_ps(a.v,b.v); }
+inline VF8 operator-(VF8 a){ return _mm256_xor_ps(a.v,_mm256_set1_ps(-0.0f)); }
+inline MF8 operator<(VF8 a, VF8 b){ return {_mm256_cmp_ps(a.v,b.v,_CMP_LT_OQ)}; }
+inline MF8 operator<=(VF8 a, VF8 b){ return {_mm256_cmp_ps(a.v,b.v,_CMP_LE_OQ)}; }
+inline MF8 operator>(VF8 a, VF8 b){ return {_mm256_cmp_ps(a.v,b.v,_CMP_GT_OQ)}; }
+inline MF8 operator>=(VF8 a, VF8 b){ return {_mm256_cmp_ps(a.v,b.v,_CMP_GE_OQ)}; }
+inline MF8 operator==(VF8 a, VF8 b){ return {_mm256_cmp_ps(a.v,b.v,_CMP_EQ_OQ)}; }
+inline VF8  vsel(MF8 m, VF8 a, VF8 b){ return _mm256_blendv_ps(b.v,a.v,m.m); }
+inline bool vany(MF8 m){ return _mm256_movemask_ps(m.m)!=0; }
+inline MF8  vand(MF8 a, MF8 b){ return {_mm256_and_ps(a.m,b.m)}; }
+inline MF8  vor(MF8 a, MF8 b){ return {_mm256_or_ps(a.m,b.m)}; }
+inline VF8  vabs(VF8 x){ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f),x.v); }
+inline VF8  vsqrt(VF8 x){ return _mm256_sqrt_ps(x.v); }
+inline VF8  vfloor(VF8 x){ return _mm256_round_ps(x.v,_MM_FROUND_TO_NEG_INF|_MM_FROUND_NO_EXC); }
+// float jako ve skalární verzi přes double, tady stačí float (|x| < ~20)
+inline VF8  vfmod2pi(VF8 x){
+  VF8 q=_mm256_round_ps((x*VF8(1.0f/(float)(2.0*M_PI))).v,_MM_FROUND_TO_ZERO|_MM_FROUND_NO_EXC);
+  return (x-q*VF8(6.28125f))-q*VF8((float)(2.0*M_PI-6.28125));
+}
+
+template<> struct Lane<VD4> {
+  typedef VD4 D; typedef double E; enum { W=4 };
+  static VD4  ldD(const double* p){ return _mm256_loadu_pd(p); }
+  static VD4  ldP(const double* pd, const float*){ return _mm256_loadu_pd(pd); }
+  static VD4  join(const VD4* d){ return d[0]; }
+  static void st(double* o, VD4 v){ _mm256_storeu_pd(o,v.v); }
+  static double tol(){ return 1.0e-12; }
+};
+
+template<> struct Lane<VF8> {
+  typedef VD4 D; typedef float E; enum { W=8 };
+  static VF8  ldP(const double*, const float* pf){ return _mm256_loadu_ps(pf); }
+  static VF8  join(const VD4* d){
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(d[0].v)),
+                                _mm256_cvtpd_ps(d[1].v),1);
+  }
+  static void st(float* o, VF8 v){ _mm256_storeu_ps(o,v.v); }
+  static float tol(){ return 1.0e-6f; }
+};
+
+// ---- sin/cos (Cephes sin.c / sinf.c) ----
+// oktant j z |x|*4/pi, zaokrouhlený na sudý, redukce ve třech částech pi/4
+inline void vsincos(VD4 x, VD4 &s, VD4 &c){
+  const VD4 ax=vabs(x);
+  VD4 y=vfloor(ax*VD4(4.0/M_PI));
+  y=y+(y-VD4(2.0)*vfloor(y*VD4(0.5)));                    // liché -> +1
+  VD4 j=y-VD4(8.0)*vfloor(y*VD4(0.125));                  // 0, 2, 4, 6
+  const VD4 z=((ax-y*VD4(7.85398125648498535156E-1))-y*VD4(3.77489470793079817668E-8))
+              -y*VD4(2.69515142907905952645E-15);
+  const VD4 zz=z*z;
+  const VD4 ps=z+z*zz*(((((VD4(1.58962301576546568060E-10)*zz+VD4(-2.50507477628578072866E-8))*zz+
+               VD4(2.75573136213857245213E-6))*zz+VD4(-1.98412698295895385996E-4))*zz+
+               VD4(8.33333333332211858878E-3))*zz+VD4(-1.66666666666666307295E-1));
+  const VD4 pc=VD4(1.0)-VD4(0.5)*zz+zz*zz*(((((VD4(-1.13585365213876817300E-11)*zz+
+               VD4(2.08757008419747316778E-9))*zz+VD4(-2.75573141792967388112E-7))*zz+
+               VD4(2.48015872888517045348E-5))*zz+VD4(-1.38888888888730564116E-3))*zz+
+               VD4(4.16666666666665929218E-2));
+  const MD4 hi=j>VD4(3.0);                                 // j 4, 6 -> 0, 2 se změnou znaménka
+  j=vsel(hi,j-VD4(4.0),j);
+  const MD4 swap=j==VD4(2.0);
+  VD4 sv=vsel(swap,pc,ps), cv=vsel(swap,ps,pc);
+  const MD4 neg=x<VD4(0.0);
+  const VD4 sgnS=vsel({_mm256_xor_pd(hi.m,neg.m)},VD4(-1.0),VD4(1.0));
+  const VD4 sgnC=vsel({_mm256_xor_pd(hi.m,swap.m)},VD4(-1.0),VD4(1.0));
+  s=sv*sgnS;
+  c=cv*sgnC;
+}
+inline VD4 vsin(VD4 x){ VD4 s, c; vsincos(x,s,c); return s; }
+inline VD4 vcos(VD4 x){ VD4 s, c; vsincos(x,s,c); return c; }
+
+inline void vsincos(VF8 x, VF8 &s, VF8 &c){
+  const VF8 ax=vabs(x);
+  VF8 y=vfloor(ax*VF8((float)(4.0/M_PI)));
+  y=y+(y-VF8(2.0f)*vfloor(y*VF8(0.5f)));
+  VF8 j=y-VF8(8.0f)*vfloor(y*VF8(0.125f));
+  const VF8 z=((ax-y*VF8(0.78515625f))-y*VF8(2.4187564849853515625e-4f))-y*VF8(3.77489497744594108e-8f);
+  const VF8 zz=z*z;
+  const VF8 ps=((VF8(-1.9515295891E-4f)*zz+VF8(8.3321608736E-3f))*zz+VF8(-1.6666654611E-1f))*zz*z+z;
+  const VF8 pc=((VF8(2.443315711809948E-005f)*zz+VF8(-1.388731625493765E-003f))*zz+
+               VF8(4.166664568298827E-002f))*zz*zz-VF8(0.5f)*zz+VF8(1.0f);
+  const MF8 hi=j>VF8(3.0f);
+  j=vsel(hi,j-VF8(4.0f),j);
+  const MF8 swap=j==VF8(2.0f);
+  VF8 sv=vsel(swap,pc,ps), cv=vsel(swap,ps,pc);
+  const MF8 neg=x<VF8(0.0f);
+  const VF8 sgnS=vsel({_mm256_xor_ps(hi.m,neg.m)},VF8(-1.0f),VF8(1.0f));
+  const VF8 sgnC=vsel({_mm256_xor_ps(hi.m,swap.m)},VF8(-1.0f),VF8(1.0f));
+  s=sv*sgnS;
+  c=cv*sgnC;
+}
+
+// ---- atan2 (Cephes atan.c / atanf.c) ----
+inline VD4 vatan(VD4 x){
+  const VD4 a=vabs(x);
+  const MD4 big=a>VD4(2.41421356237309504880);             // tan(3pi/8)
+  const MD4 mid=vand({_mm256_xor_pd(big.m,_mm256_castsi256_pd(_mm256_set1_epi64x(-1)))},a>VD4(0.66));
+  const VD4 xr=vsel(big,VD4(-1.0)/a,vsel(mid,(a-VD4(1.0))/(a+VD4(1.0)),a));
+  const VD4 y0=vsel(big,VD4(M_PI_2),vsel(mid,VD4(M_PI_4),VD4(0.0)));
+  const VD4 z=xr*xr;
+  const VD4 p=(((VD4(-8.750608600031904122785E-1)*z+VD4(-1.615753718733365076637E1))*z+
+              VD4(-7.500855792314704667340E1))*z+VD4(-1.228866684490136173410E2))*z+
+              VD4(-6.485021904942025371773E1);
+  const VD4 q=((((z+VD4(2.485846490142306297962E1))*z+VD4(1.650270098316988542046E2))*z+
+              VD4(4.328810604912902668951E2))*z+VD4(4.853903996359136964868E2))*z+
+              VD4(1.945506571482613964425E2);
+  VD4 r=xr*(z*p/q)+xr;
+  r=r+vsel(big,VD4(6.123233995736765886130E-17),vsel(mid,VD4(0.5*6.123233995736765886130E-17),VD4(0.0)));
+  r=y0+r;
+  return vsel(x<VD4(0.0),-r,r);
+}
+inline VD4 vatan2(VD4 y, VD4 x){
+  VD4 r=vatan(y/x);
+  return vsel(x<VD4(0.0),r+vsel(y>=VD4(0.0),VD4(M_PI),VD4(-M_PI)),r);
+}
+
+inline VF8 vatan(VF8 x){
+  const VF8 a=vabs(x);
+  const MF8 big=a>VF8(2.414213562373095f);
+  const MF8 mid=vand({_mm256_xor_ps(big.m,_mm256_castsi256_ps(_mm256_set1_epi32(-1)))},a>VF8(0.4142135623730950f));
+  const VF8 xr=vsel(big,VF8(-1.0f)/a,vsel(mid,(a-VF8(1.0f))/(a+VF8(1.0f)),a));
+  const VF8 y0=vsel(big,VF8((float)M_PI_2),vsel(mid,VF8((float)M_PI_4),VF8(0.0f)));
+  const VF8 z=xr*xr;
+  const VF8 r=y0+((((VF8(8.05374449538e-2f)*z+VF8(-1.38776856032E-1f))*z+VF8(1.99777106478E-1f))*z+
+                   VF8(-3.33329491539E-1f))*z*xr+xr);
+  return vsel(x<VF8(0.0f),-r,r);
+}
+inline VF8 vatan2(VF8 y, VF8 x){
+  VF8 r=vatan(y/x);
+  return vsel(x<VF8(0.0f),r+vsel(y>=VF8(0.0f),VF8((float)M_PI),VF8((float)-M_PI)),r);
+}
+
+// elevace z atan2 (bez asin): stejný úhel, v pruzích levnější
+inline VD4 velev(VD4 tZ, VD4 tS, VD4 tE, VD4){ return vatan2(tZ,vsqrt(tS*tS+tE*tE)); }
+inline VF8 velev(VF8 tZ, VF8 tS, VF8 tE, VF8){ return vatan2(tZ,vsqrt(tS*tS+tE*tE)); }
+
+namespace avx2 {
+#include "sgp4_batch_kernel.h"
+}
+
+}  // namespace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif  // SGP4_BATCH_X86
+
+// ====================== API ======================
+bool sgp4BatchInit(Sgp4Batch &b, int maxSats){
+  memset(&b,0,sizeof(b));
+  b.capacity=(maxSats+SGP4_BATCH_LANES-1)/SGP4_BATCH_LANES*SGP4_BATCH_LANES;
+  if(b.capacity<=0) return false;
+  b.c=(double*)calloc((size_t)F_COUNT*b.capacity,sizeof(double));
+  b.f=(float*)calloc((size_t)F_PER*b.capacity,sizeof(float));
+  if(!b.c || !b.f){ sgp4BatchFree(b); return false; }
+  b.isa=sgp4BatchBestIsa();
+  return true;
+}
+
+void sgp4BatchFree(Sgp4Batch &b){
+  free(b.c); free(b.f);
+  b.c=nullptr; b.f=nullptr;
+  b.count=b.capacity=0;
+}
+
+int sgp4BatchAdd(Sgp4Batch &b, const Sgp4Elements &e){
+  const elsetrec &s=e.rec;
+  if(b.count>=b.capacity || s.method=='d') return -1;
+  const bool simp=s.isimp==1;
+  double v[F_COUNT];
+  v[F_EPOCH]=s.jdsatepoch;
+  v[F_MO]=s.mo;       v[F_MDOT]=s.mdot;
+  v[F_ARGPO]=s.argpo; v[F_ARGPDOT]=s.argpdot;
+  v[F_NODEO]=s.nodeo; v[F_NODEDOT]=s.nodedot; v[F_NODECF]=s.nodecf;
+  v[F_CC1]=s.cc1;
+  v[F_CC4B]=s.bstar*s.cc4;
+  v[F_T2COF]=s.t2cof;
+  // isimp: členy, které sgp4() vynechá, jsou nulové
+  v[F_CC5B]=simp?0.0:s.bstar*s.cc5;
+  v[F_T3COF]=simp?0.0:s.t3cof; v[F_T4COF]=simp?0.0:s.t4cof; v[F_T5COF]=simp?0.0:s.t5cof;
+  v[F_D2]=simp?0.0:s.d2; v[F_D3]=simp?0.0:s.d3; v[F_D4]=simp?0.0:s.d4;
+  v[F_OMGCOF]=simp?0.0:s.omgcof; v[F_XMCOF]=simp?0.0:s.xmcof;
+  v[F_ETA]=s.eta; v[F_DELMO]=s.delmo; v[F_SINMAO]=s.sinmao;
+  v[F_ECCO]=s.ecco; v[F_NO]=s.no; v[F_AM0]=e.am0;
+  v[F_AYCOF]=s.aycof; v[F_XLCOF]=s.xlcof; v[F_CON41]=s.con41;
+  v[F_X1MTH2]=s.x1mth2; v[F_X7THM1]=s.x7thm1;
+  v[F_INCLO]=s.inclo; v[F_SINIO]=e.sinio; v[F_COSIO]=e.cosio;
+
+  // zbytek posledního bloku kopií, ať prázdné pruhy počítají platnou dráhu
+  const int lane=b.count++;
+  const int end=(lane/SGP4_BATCH_LANES+1)*SGP4_BATCH_LANES;
+  for(int i=lane;i<end;i++){
+    for(int k=0;k<F_COUNT;k++) b.c[k*b.capacity+i]=v[k];
+    for(int k=0;k<F_PER;k++) b.f[k*b.capacity+i]=(float)v[F_PER0+k];
+  }
+  return lane;
+}
+
+uint8_t sgp4BatchBestIsa(){
+#if SGP4_BATCH_X86
+  if(__builtin_cpu_supports("avx2")) return SGP4_ISA_AVX2;
+#endif
+  return SGP4_ISA_SCALAR;
+}
+
+const char* sgp4BatchIsaName(uint8_t isa){
+  return isa==SGP4_ISA_AVX2?"avx2":"scalar";
+}
+
+template<typename T>
+int sgp4BatchLook(const Sgp4Batch &b, const SiteFrame &site, double utc,
+                  float* az, float* el, float* rangeKm, uint8_t* err){
+  BatchTopo tp;
+  const double jd=utc/86400.0+2440587.5;
+  const double gm=gstime(jd);
+  tp.cg=cos(gm); tp.sg=sin(gm);
+  memcpy(tp.m,site.sez,sizeof(tp.m));
+  tp.sx=site.ecef[0]; tp.sy=site.ecef[1]; tp.sz=site.ecef[2];
+  double tumin, mu, xke, j3, j4, j3oj2;
+  getgravconst(wgs72,tumin,mu,tp.reKm,xke,tp.j2,j3,j4,j3oj2);
+
+#if SGP4_BATCH_X86
+  if(b.isa==SGP4_ISA_AVX2){
+    if(sizeof(T)==sizeof(float)) return avx2::lookRun<VF8>(b,tp,jd,az,el,rangeKm,err);
+    return avx2::lookRun<VD4>(b,tp,jd,az,el,rangeKm,err);
+  }
+#endif
+  return scalar::lookRun<T>(b,tp,jd,az,el,rangeKm,err);
+}
+
+template int sgp4BatchLook<float>(const Sgp4Batch&, const SiteFrame&, double, float*, float*, float*, uint8_t*);
+template int sgp4BatchLook<double>(const Sgp4Batch&, const SiteFrame&, double, float*, float*, float*, uint8_t*);
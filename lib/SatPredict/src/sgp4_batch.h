@@ -0,0 +1,57 @@
+// sgp4_batch.h
+// Struct-of-arrays SGP4 for many near-earth satellites at one time, for
+// catalog-sized runs on the host. The constants sgp4init() computes are
+// stored field by field (one array per elsetrec member), so a vector
+// register holds the same member of 4 (double) or 8 (float) satellites and
+// one pass through the near-earth branch advances all of them. The kernel is
+// written once over a lane type: plain double/float for the scalar fallback
+// (any target, also the ESP32) and AVX2 registers on x86-64, chosen at run
+// time when the CPU has AVX2. Deep-space orbits are not batched; see
+// sgp4BatchAdd().
+//
+// Only snapshots use it (CLI --look, bench): the pass search steps every
+// satellite on its own adaptive grid (the step depends on its elevation and
+// the prefilter skips whole spans), so there is no common time to batch at,
+// and the CLI must reproduce the device's search exactly. On the ESP32 the
+// AVX2 part is compiled out (SGP4_BATCH_X86 = 0) and only the scalar lanes
+// remain, for the serial "bench" (catalog_soa against catalog_state).
+#pragma once
+#include <stdint.h>
+#include "sgp4_core.h"
+#include "sat_predict.h"
+
+const int SGP4_BATCH_LANES = 8;   // kapacita se zaokrouhluje na celé bloky
+
+enum Sgp4BatchIsa : uint8_t {
+  SGP4_ISA_SCALAR = 0,
+  SGP4_ISA_AVX2   = 1,
+};
+
+struct Sgp4Batch {
+  int     count;       // satelity v dávce
+  int     capacity;    // násobek SGP4_BATCH_LANES
+  uint8_t isa;         // Sgp4BatchIsa; init = nejlepší dostupná
+  double* c;           // konstanty po polích: c[field*capacity + i]
+  float*  f;           // periodické konstanty ve float (8 drah na registr)
+};
+
+// Allocates room for maxSats satellites; false when out of memory.
+bool sgp4BatchInit(Sgp4Batch &b, int maxSats);
+void sgp4BatchFree(Sgp4Batch &b);
+// Appends a satellite and returns its lane, or -1 when the batch is full
+// or the orbit is deep space (method 'd'): those stay on sgp4Propagate().
+int  sgp4BatchAdd(Sgp4Batch &b, const Sgp4Elements &e);
+
+// Best ISA of this CPU, and its name ("avx2", "scalar").
+uint8_t     sgp4BatchBestIsa();
+const char* sgp4BatchIsaName(uint8_t isa);
+
+// Az/el (deg) and range (km) of every satellite in the batch at utc (UNIX
+// s), like propagateSeries<T>() with one sample per satellite; rangeKm may
+// be nullptr. T is the precision of the periodics and the topocentric
+// transform, as in sgp4_core.h; the secular terms are always double.
+// err[i] gets the SGP4 error code of satellite i (0 = OK, then el = -90).
+// Returns the number of satellites without error.
+template<typename T>
+int sgp4BatchLook(const Sgp4Batch &b, const SiteFrame &site, double utc,
+                  float* az, float* el, float* rangeKm, uint8_t* err);
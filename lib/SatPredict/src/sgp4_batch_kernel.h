@@ -0,0 +1,170 @@
+// sgp4_batch_kernel.h
+// Lane-generic body of sgp4_batch.cpp: the near-earth branch of
+// sgp4_core.cpp and the topocentric transform of propagateSeries(),
+// written over a lane type V with the operations of Lane<V>. Included twice
+// by sgp4_batch.cpp, for the scalar lanes and inside the AVX2 target region,
+// so the vector instantiations are compiled for AVX2 and the scalar ones are
+// not. No include guard on purpose.
+
+// constant field f of satellites i.. (double lanes / periodic lanes)
+template<class D>
+inline D secC(const Sgp4Batch &b, int f, int i){ return Lane<D>::ldD(b.c+f*b.capacity+i); }
+template<class V>
+inline V perC(const Sgp4Batch &b, int f, int i){
+  return Lane<V>::ldP(b.c+f*b.capacity+i,b.f+(f-F_PER0)*b.capacity+i);
+}
+
+// ---- secular gravity and drag (double) ----
+// err: 0, nebo 1 (e/a mimo rozsah) jako číslo v pruhu
+template<class D>
+inline void secularLanes(const Sgp4Batch &b, int i, double jd, D &em, D &argpm, D &nodem,
+                         D &mm, D &am, D &err){
+  const D t=(D(jd)-secC<D>(b,F_EPOCH,i))*D(1440.0);
+  const D xmdf=secC<D>(b,F_MO,i)+secC<D>(b,F_MDOT,i)*t;
+  const D argpdf=secC<D>(b,F_ARGPO,i)+secC<D>(b,F_ARGPDOT,i)*t;
+  const D nodedf=secC<D>(b,F_NODEO,i)+secC<D>(b,F_NODEDOT,i)*t;
+  const D t2=t*t;
+  nodem=nodedf+secC<D>(b,F_NODECF,i)*t2;
+  D tempa=D(1.0)-secC<D>(b,F_CC1,i)*t;
+  D tempe=secC<D>(b,F_CC4B,i)*t;
+  D templ=secC<D>(b,F_T2COF,i)*t2;
+
+  // isimp: koeficienty níže jsou v dávce nulové, viz sgp4BatchAdd()
+  const D delomg=secC<D>(b,F_OMGCOF,i)*t;
+  const D delmtemp=D(1.0)+secC<D>(b,F_ETA,i)*vcos(xmdf);
+  const D delm=secC<D>(b,F_XMCOF,i)*(delmtemp*delmtemp*delmtemp-secC<D>(b,F_DELMO,i));
+  const D temp=delomg+delm;
+  mm=xmdf+temp;
+  argpm=argpdf-temp;
+  const D t3=t2*t, t4=t3*t;
+  tempa=tempa-secC<D>(b,F_D2,i)*t2-secC<D>(b,F_D3,i)*t3-secC<D>(b,F_D4,i)*t4;
+  tempe=tempe+secC<D>(b,F_CC5B,i)*(vsin(mm)-secC<D>(b,F_SINMAO,i));
+  templ=templ+secC<D>(b,F_T3COF,i)*t3+t4*(secC<D>(b,F_T4COF,i)+t*secC<D>(b,F_T5COF,i));
+
+  am=secC<D>(b,F_AM0,i)*tempa*tempa;
+  em=secC<D>(b,F_ECCO,i)-tempe;
+  err=vsel(vor(vor(em>=D(1.0),em<D(-0.001)),am<D(0.95)),D(1.0),D(0.0));
+  em=vsel(em<D(1.0e-6),D(1.0e-6),em);
+  mm=mm+secC<D>(b,F_NO,i)*templ;
+  D xlm=mm+argpm+nodem;
+  nodem=vfmod2pi(nodem);
+  argpm=vfmod2pi(argpm);
+  xlm=vfmod2pi(xlm);
+  mm=vfmod2pi(xlm-argpm-nodem);
+}
+
+// ---- one block of Lane<V>::W satellites from i: SGP4 + az/el/range ----
+template<class V>
+inline void lookBlock(const Sgp4Batch &b, const BatchTopo &tp, int i, double jd,
+                      V &azDeg, V &elDeg, V &rho, V &err){
+  typedef Lane<V> L;
+  typedef typename L::D D;
+  const int K=L::W/Lane<D>::W;
+  D emD[K], argpD[K], nodeD[K], mmD[K], amD[K], errD[K];
+  for(int k=0;k<K;k++)
+    secularLanes<D>(b,i+k*Lane<D>::W,jd,emD[k],argpD[k],nodeD[k],mmD[k],amD[k],errD[k]);
+
+  // ---- periodics, Kepler, orientation (V) ----
+  const V ep=L::join(emD), argpp=L::join(argpD), nodep=L::join(nodeD), mp=L::join(mmD);
+  const V amT=L::join(amD);
+  err=L::join(errD);
+  const V xincp=perC<V>(b,F_INCLO,i);
+  const V sinip=perC<V>(b,F_SINIO,i), cosip=perC<V>(b,F_COSIO,i);
+
+  V sa, ca;
+  vsincos(argpp,sa,ca);
+  const V axnl=ep*ca;
+  V temp=V(1.0)/(amT*(V(1.0)-ep*ep));
+  const V aynl=ep*sa+temp*perC<V>(b,F_AYCOF,i);
+  const V xl=mp+argpp+nodep+temp*perC<V>(b,F_XLCOF,i)*axnl;
+
+  // Kepler: pruh, který zkonvergoval, se už nemění (jako konec smyčky ve
+  // skalární verzi, sin/cos zůstávají z posledního kroku)
+  const V u=vfmod2pi(xl-nodep);
+  const V tol=V(L::tol());
+  V eo1=u, sineo1=V(0.0), coseo1=V(0.0);
+  auto active=vabs(V(9999.9))>=tol;
+  for(int ktr=1; vany(active) && ktr<=10; ktr++){
+    V s, c;
+    vsincos(eo1,s,c);
+    V tem5=V(1.0)-c*axnl-s*aynl;
+    tem5=(u-aynl*c+axnl*s-eo1)/tem5;
+    tem5=vsel(tem5>=V(0.95),V(0.95),vsel(tem5<=V(-0.95),V(-0.95),tem5));
+    sineo1=vsel(active,s,sineo1);
+    coseo1=vsel(active,c,coseo1);
+    eo1=vsel(active,eo1+tem5,eo1);
+    active=vand(active,vabs(tem5)>=tol);
+  }
+
+  const V ecose=axnl*coseo1+aynl*sineo1;
+  const V esine=axnl*sineo1-aynl*coseo1;
+  const V el2=axnl*axnl+aynl*aynl;
+  const V pl=amT*(V(1.0)-el2);
+  err=vsel(vand(err==V(0.0),pl<V(0.0)),V(4.0),err);
+
+  const V rl=amT*(V(1.0)-ecose);
+  const V betal=vsqrt(V(1.0)-el2);
+  temp=esine/(V(1.0)+betal);
+  const V sinu=amT/rl*(sineo1-aynl-axnl*temp);
+  const V cosu=amT/rl*(coseo1-axnl+aynl*temp);
+  V su=vatan2(sinu,cosu);
+  const V sin2u=(cosu+cosu)*sinu;
+  const V cos2u=V(1.0)-V(2.0)*sinu*sinu;
+  temp=V(1.0)/pl;
+  const V temp1=V(0.5)*V(tp.j2)*temp;
+  const V temp2=temp1*temp;
+
+  const V mrt=rl*(V(1.0)-V(1.5)*temp2*betal*perC<V>(b,F_CON41,i))+
+              V(0.5)*temp1*perC<V>(b,F_X1MTH2,i)*cos2u;
+  su=su-V(0.25)*temp2*perC<V>(b,F_X7THM1,i)*sin2u;
+  const V xnode=nodep+V(1.5)*temp2*cosip*sin2u;
+  const V xinc=xincp+V(1.5)*temp2*cosip*sinip*cos2u;
+  err=vsel(vand(err==V(0.0),mrt<V(1.0)),V(6.0),err);
+
+  V sinsu, cossu, snod, cnod, sini, cosi;
+  vsincos(su,sinsu,cossu);
+  vsincos(xnode,snod,cnod);
+  vsincos(xinc,sini,cosi);
+  const V xmx=-snod*cosi, xmy=cnod*cosi;
+  const V re=V(tp.reKm);
+  const V rx=mrt*(xmx*sinsu+cnod*cossu)*re;
+  const V ry=mrt*(xmy*sinsu+snod*cossu)*re;
+  const V rz=mrt*(sini*sinsu)*re;
+
+  // ---- TEME -> ECEF (bez pohybu pólu) -> SEZ ----
+  const V c=V(tp.cg), s=V(tp.sg);
+  const V dx= c*rx+s*ry-V(tp.sx);
+  const V dy=-s*rx+c*ry-V(tp.sy);
+  const V dz=rz-V(tp.sz);
+  const V tS=V(tp.m[0][0])*dx+V(tp.m[0][1])*dy+V(tp.m[0][2])*dz;
+  const V tE=V(tp.m[1][0])*dx+V(tp.m[1][1])*dy;
+  const V tZ=V(tp.m[2][0])*dx+V(tp.m[2][1])*dy+V(tp.m[2][2])*dz;
+  rho=vsqrt(tS*tS+tE*tE+tZ*tZ);
+  V a=vatan2(tE,-tS);
+  a=vsel(a<V(0.0),a+V(2.0*M_PI),a);
+  azDeg=a*V(180.0/M_PI);
+  elDeg=vsel(err==V(0.0),velev(tZ,tS,tE,rho)*V(180.0/M_PI),V(-90.0));
+}
+
+template<class V>
+int lookRun(const Sgp4Batch &b, const BatchTopo &tp, double jd,
+            float* az, float* el, float* rangeKm, uint8_t* err){
+  typedef Lane<V> L;
+  typedef typename L::E E;
+  E oa[L::W], oe[L::W], orr[L::W], oerr[L::W];
+  int ok=0;
+  for(int i=0;i<b.count;i+=L::W){
+    V va, ve, vr, verr;
+    lookBlock<V>(b,tp,i,jd,va,ve,vr,verr);
+    L::st(oa,va); L::st(oe,ve); L::st(orr,vr); L::st(oerr,verr);
+    const int n=b.count-i<L::W?b.count-i:L::W;
+    for(int k=0;k<n;k++){
+      az[i+k]=(float)oa[k];
+      el[i+k]=(float)oe[k];
+      if(rangeKm) rangeKm[i+k]=(float)orr[k];
+      err[i+k]=(uint8_t)oerr[k];
+      if(oerr[k]==0) ok++;
+    }
+  }
+  return ok;
+}
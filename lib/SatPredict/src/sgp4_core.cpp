@@ -0,0 +1,819 @@
+// sgp4_core.cpp
+// Vallado's sgp4() and sgp4init() (sgp4unit.cpp, WGS-72): position and
+// velocity for sgp4Propagate(). Near-earth periodics are templated on the
+// float type; deep space (dscom, dpper, dsinit, dspace) runs in double.
+#include "sgp4_core.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+struct GravConst {
+  double xke, j2, j4, j3oj2, reKm, vkmpersec;
+  GravConst(){
+    double tumin, mu, j3;
+    getgravconst(wgs72,tumin,mu,reKm,xke,j2,j3,j4,j3oj2);
+    vkmpersec=reKm*xke/60.0;
+  }
+};
+
+const GravConst& grav(){
+  static const GravConst g;
+  return g;
+}
+
+const double TWOPI=2.0*M_PI;
+const double X2O3=2.0/3.0;
+
+// Kepler tolerance: Vallado's 1e-12 in double, float resolution otherwise
+template<typename T> inline T keplerTol();
+template<> inline double keplerTol<double>(){ return 1.0e-12; }
+template<> inline float  keplerTol<float>(){ return 1.0e-6f; }
+
+// orbit constants of the periodic part; near-earth from the record, deep
+// space from the inclination after the lunar-solar periodics
+template<typename T>
+struct PerConst {
+  T aycof, xlcof, con41, x1mth2, x7thm1;
+};
+
+// ---- periodics, Kepler, orientation (T) ----
+// ep..mp = mean elements at t, am = semi-major axis (er). v may be nullptr.
+template<typename T>
+int periodics(T ep, T argpp, T nodep, T mp, double am, T xincp, T sinip, T cosip,
+              const PerConst<T> &c, T r[3], T v[3]){
+  const GravConst &g=grav();
+  const T amT=(T)am;
+
+  T axnl=ep*sgpm::cos(argpp);
+  T temp=(T)1/(amT*((T)1-ep*ep));
+  T aynl=ep*sgpm::sin(argpp)+temp*c.aycof;
+  T xl=mp+argpp+nodep+temp*c.xlcof*axnl;
+
+  T u=(T)fmod((double)(xl-nodep),TWOPI);
+  T eo1=u, tem5=(T)9999.9;
+  T sineo1=0, coseo1=0;
+  for(int ktr=1; sgpm::fabs(tem5)>=keplerTol<T>() && ktr<=10; ktr++){
+    sineo1=sgpm::sin(eo1);
+    coseo1=sgpm::cos(eo1);
+    tem5=(T)1-coseo1*axnl-sineo1*aynl;
+    tem5=(u-aynl*coseo1+axnl*sineo1-eo1)/tem5;
+    if(sgpm::fabs(tem5)>=(T)0.95) tem5=tem5>0?(T)0.95:(T)-0.95;
+    eo1=eo1+tem5;
+  }
+
+  T ecose=axnl*coseo1+aynl*sineo1;
+  T esine=axnl*sineo1-aynl*coseo1;
+  T el2=axnl*axnl+aynl*aynl;
+  T pl=amT*((T)1-el2);
+  if(pl<0) return 4;
+
+  T rl=amT*((T)1-ecose);
+  T betal=sgpm::sqrt((T)1-el2);
+  temp=esine/((T)1+betal);
+  T sinu=amT/rl*(sineo1-aynl-axnl*temp);
+  T cosu=amT/rl*(coseo1-axnl+aynl*temp);
+  T su=sgpm::atan2(sinu,cosu);
+  T sin2u=(cosu+cosu)*sinu;
+  T cos2u=(T)1-(T)2*sinu*sinu;
+  temp=(T)1/pl;
+  T temp1=(T)0.5*(T)g.j2*temp;
+  T temp2=temp1*temp;
+
+  T mrt=rl*((T)1-(T)1.5*temp2*betal*c.con41)+(T)0.5*temp1*c.x1mth2*cos2u;
+  su=su-(T)0.25*temp2*c.x7thm1*sin2u;
+  T xnode=nodep+(T)1.5*temp2*cosip*sin2u;
+  T xinc=xincp+(T)1.5*temp2*cosip*sinip*cos2u;
+
+  T sinsu=sgpm::sin(su), cossu=sgpm::cos(su);
+  T snod=sgpm::sin(xnode), cnod=sgpm::cos(xnode);
+  T sini=sgpm::sin(xinc), cosi=sgpm::cos(xinc);
+  T xmx=-snod*cosi, xmy=cnod*cosi;
+  T ux=xmx*sinsu+cnod*cossu;
+  T uy=xmy*sinsu+snod*cossu;
+  T uz=sini*sinsu;
+
+  if(mrt<(T)1) return 6;
+  const T re=(T)g.reKm;
+  r[0]=mrt*ux*re;
+  r[1]=mrt*uy*re;
+  r[2]=mrt*uz*re;
+  if(!v) return 0;
+
+  // rychlost: nm z am jako v knihovně, pow(am,1.5) = am*sqrt(am)
+  const T xkeT=(T)g.xke;
+  T nm=(T)(g.xke/(am*sqrt(am)));
+  T rdotl=sgpm::sqrt(amT)*esine/rl;
+  T rvdotl=sgpm::sqrt(pl)/rl;
+  T mvt=rdotl-nm*temp1*c.x1mth2*sin2u/xkeT;
+  T rvdot=rvdotl+nm*temp1*(c.x1mth2*cos2u+(T)1.5*c.con41)/xkeT;
+  T vx=xmx*cossu-cnod*sinsu;
+  T vy=xmy*cossu-snod*sinsu;
+  T vz=sini*cossu;
+  const T vk=(T)g.vkmpersec;
+  v[0]=(mvt*ux+rvdot*vx)*vk;
+  v[1]=(mvt*uy+rvdot*vy)*vk;
+  v[2]=(mvt*uz+rvdot*vz)*vk;
+  return 0;
+}
+
+// am0 = (xke/no)^(2/3), sinip/cosip of inclo: per satellite, see Sgp4Elements.
+// v may be nullptr. Returns the SGP4 error code, 0 = OK.
+template<typename T>
+int nearEarth(const elsetrec &s, double am0, T sinip, T cosip, double t, T r[3], T v[3]){
+  // ---- secular gravity and drag (double) ----
+  double xmdf=s.mo+s.mdot*t;
+  double argpdf=s.argpo+s.argpdot*t;
+  double nodedf=s.nodeo+s.nodedot*t;
+  double argpm=argpdf, mm=xmdf;
+  double t2=t*t;
+  double nodem=nodedf+s.nodecf*t2;
+  double tempa=1.0-s.cc1*t;
+  double tempe=s.bstar*s.cc4*t;
+  double templ=s.t2cof*t2;
+
+  if(s.isimp!=1){
+    double delomg=s.omgcof*t;
+    double delmtemp=1.0+s.eta*cos(xmdf);
+    double delm=s.xmcof*(delmtemp*delmtemp*delmtemp-s.delmo);
+    double temp=delomg+delm;
+    mm=xmdf+temp;
+    argpm=argpdf-temp;
+    double t3=t2*t, t4=t3*t;
+    tempa=tempa-s.d2*t2-s.d3*t3-s.d4*t4;
+    tempe=tempe+s.bstar*s.cc5*(sin(mm)-s.sinmao);
+    templ=templ+s.t3cof*t3+t4*(s.t4cof+t*s.t5cof);
+  }
+
+  double em=s.ecco;
+  double am=am0*tempa*tempa;
+  em=em-tempe;
+  if(em>=1.0 || em<-0.001 || am<0.95) return 1;
+  if(em<1.0e-6) em=1.0e-6;
+  mm=mm+s.no*templ;
+  double xlm=mm+argpm+nodem;
+  nodem=fmod(nodem,TWOPI);
+  argpm=fmod(argpm,TWOPI);
+  xlm=fmod(xlm,TWOPI);
+  mm=fmod(xlm-argpm-nodem,TWOPI);
+
+  const PerConst<T> c={(T)s.aycof,(T)s.xlcof,(T)s.con41,(T)s.x1mth2,(T)s.x7thm1};
+  return periodics<T>((T)em,(T)argpm,(T)nodem,(T)mm,am,(T)s.inclo,sinip,cosip,c,r,v);
+}
+
+// ==================== deep space (Vallado) ====================
+
+const double ZES=0.01675, ZEL=0.05490;
+const double ZNS=1.19459e-5, ZNL=1.5835218e-4;
+const double RPTIM=4.37526908801129966e-3;   // rad/min, otáčení Země
+
+// dscom() outputs dsinit() needs besides Sgp4Deep
+struct DsCom {
+  double sinim, cosim, emsq;
+  double s1, s2, s3, s4, s5, ss1, ss2, ss3, ss4, ss5;
+  double sz1, sz3, sz11, sz13, sz21, sz23, sz31, sz33;
+  double z1, z3, z11, z13, z21, z23, z31, z33;
+};
+
+// lunar-solar terms at epoch (epoch = jd - 2433281.5, tc = 0)
+void dscom(double epoch, double ep, double argpp, double inclp, double nodep, double np,
+           Sgp4Deep &d, DsCom &o){
+  const double c1ss=2.9864797e-6, c1l=4.7968065e-7;
+  const double zsinis=0.39785416, zcosis=0.91744867;
+  const double zcosgs=0.1945905, zsings=-0.98088458;
+
+  const double snodm=sin(nodep), cnodm=cos(nodep);
+  const double sinomm=sin(argpp), cosomm=cos(argpp);
+  o.sinim=sin(inclp); o.cosim=cos(inclp);
+  o.emsq=ep*ep;
+  const double betasq=1.0-o.emsq, rtemsq=sqrt(betasq);
+
+  d.peo=0.0; d.pinco=0.0; d.plo=0.0; d.pgho=0.0; d.pho=0.0;
+  const double day=epoch+18261.5;
+  const double xnodce=fmod(4.5236020-9.2422029e-4*day,TWOPI);
+  const double stem=sin(xnodce), ctem=cos(xnodce);
+  const double zcosil=0.91375164-0.03568096*ctem;
+  const double zsinil=sqrt(1.0-zcosil*zcosil);
+  const double zsinhl=0.089683511*stem/zsinil;
+  const double zcoshl=sqrt(1.0-zsinhl*zsinhl);
+  const double gam=5.8351514+0.0019443680*day;
+  double zx=0.39785416*stem/zsinil;
+  const double zy=zcoshl*ctem+0.91744867*zsinhl*stem;
+  zx=atan2(zx,zy);
+  zx=gam+zx-xnodce;
+  const double zcosgl=cos(zx), zsingl=sin(zx);
+
+  // Slunce, pak Měsíc
+  double zcosg=zcosgs, zsing=zsings, zcosi=zcosis, zsini=zsinis;
+  double zcosh=cnodm, zsinh=snodm, cc=c1ss;
+  const double xnoi=1.0/np;
+  double s1=0, s2=0, s3=0, s4=0, s5=0, s6=0, s7=0;
+  double z1=0, z2=0, z3=0, z11=0, z12=0, z13=0, z21=0, z22=0, z23=0, z31=0, z32=0, z33=0;
+  double ss6=0, ss7=0, sz2=0, sz12=0, sz22=0, sz32=0;
+  for(int lsflg=1; lsflg<=2; lsflg++){
+    const double a1=zcosg*zcosh+zsing*zcosi*zsinh;
+    const double a3=-zsing*zcosh+zcosg*zcosi*zsinh;
+    const double a7=-zcosg*zsinh+zsing*zcosi*zcosh;
+    const double a8=zsing*zsini;
+    const double a9=zsing*zsinh+zcosg*zcosi*zcosh;
+    const double a10=zcosg*zsini;
+    const double a2=o.cosim*a7+o.sinim*a8;
+    const double a4=o.cosim*a9+o.sinim*a10;
+    const double a5=-o.sinim*a7+o.cosim*a8;
+    const double a6=-o.sinim*a9+o.cosim*a10;
+
+    const double x1=a1*cosomm+a2*sinomm;
+    const double x2=a3*cosomm+a4*sinomm;
+    const double x3=-a1*sinomm+a2*cosomm;
+    const double x4=-a3*sinomm+a4*cosomm;
+    const double x5=a5*sinomm;
+    const double x6=a6*sinomm;
+    const double x7=a5*cosomm;
+    const double x8=a6*cosomm;
+
+    z31=12.0*x1*x1-3.0*x3*x3;
+    z32=24.0*x1*x2-6.0*x3*x4;
+    z33=12.0*x2*x2-3.0*x4*x4;
+    z1=3.0*(a1*a1+a2*a2)+z31*o.emsq;
+    z2=6.0*(a1*a3+a2*a4)+z32*o.emsq;
+    z3=3.0*(a3*a3+a4*a4)+z33*o.emsq;
+    z11=-6.0*a1*a5+o.emsq*(-24.0*x1*x7-6.0*x3*x5);
+    z12=-6.0*(a1*a6+a3*a5)+o.emsq*(-24.0*(x2*x7+x1*x8)-6.0*(x3*x6+x4*x5));
+    z13=-6.0*a3*a6+o.emsq*(-24.0*x2*x8-6.0*x4*x6);
+    z21=6.0*a2*a5+o.emsq*(24.0*x1*x5-6.0*x3*x7);
+    z22=6.0*(a4*a5+a2*a6)+o.emsq*(24.0*(x2*x5+x1*x6)-6.0*(x4*x7+x3*x8));
+    z23=6.0*a4*a6+o.emsq*(24.0*x2*x6-6.0*x4*x8);
+    z1=z1+z1+betasq*z31;
+    z2=z2+z2+betasq*z32;
+    z3=z3+z3+betasq*z33;
+    s3=cc*xnoi;
+    s2=-0.5*s3/rtemsq;
+    s4=s3*rtemsq;
+    s1=-15.0*ep*s4;
+    s5=x1*x3+x2*x4;
+    s6=x2*x3+x1*x4;
+    s7=x2*x4-x1*x3;
+
+    if(lsflg==1){
+      o.ss1=s1; o.ss2=s2; o.ss3=s3; o.ss4=s4; o.ss5=s5; ss6=s6; ss7=s7;
+      o.sz1=z1; sz2=z2; o.sz3=z3; o.sz11=z11; sz12=z12; o.sz13=z13;
+      o.sz21=z21; sz22=z22; o.sz23=z23; o.sz31=z31; sz32=z32; o.sz33=z33;
+      zcosg=zcosgl; zsing=zsingl; zcosi=zcosil; zsini=zsinil;
+      zcosh=zcoshl*cnodm+zsinhl*snodm;
+      zsinh=snodm*zcoshl-cnodm*zsinhl;
+      cc=c1l;
+    }
+  }
+  o.s1=s1; o.s2=s2; o.s3=s3; o.s4=s4; o.s5=s5;
+  o.z1=z1; o.z3=z3; o.z11=z11; o.z13=z13; o.z21=z21; o.z23=z23; o.z31=z31; o.z33=z33;
+
+  d.zmol=fmod(4.7199672+0.22997150*day-gam,TWOPI);
+  d.zmos=fmod(6.2565837+0.017201977*day,TWOPI);
+
+  // sluneční členy
+  d.se2=2.0*o.ss1*ss6;
+  d.se3=2.0*o.ss1*ss7;
+  d.si2=2.0*o.ss2*sz12;
+  d.si3=2.0*o.ss2*(o.sz13-o.sz11);
+  d.sl2=-2.0*o.ss3*sz2;
+  d.sl3=-2.0*o.ss3*(o.sz3-o.sz1);
+  d.sl4=-2.0*o.ss3*(-21.0-9.0*o.emsq)*ZES;
+  d.sgh2=2.0*o.ss4*sz32;
+  d.sgh3=2.0*o.ss4*(o.sz33-o.sz31);
+  d.sgh4=-18.0*o.ss4*ZES;
+  d.sh2=-2.0*o.ss2*sz22;
+  d.sh3=-2.0*o.ss2*(o.sz23-o.sz21);
+  // měsíční členy
+  d.ee2=2.0*s1*s6;
+  d.e3=2.0*s1*s7;
+  d.xi2=2.0*s2*z12;
+  d.xi3=2.0*s2*(z13-z11);
+  d.xl2=-2.0*s3*z2;
+  d.xl3=-2.0*s3*(z3-z1);
+  d.xl4=-2.0*s3*(-21.0-9.0*o.emsq)*ZEL;
+  d.xgh2=2.0*s4*z32;
+  d.xgh3=2.0*s4*(z33-z31);
+  d.xgh4=-18.0*s4*ZEL;
+  d.xh2=-2.0*s2*z22;
+  d.xh3=-2.0*s2*(z23-z21);
+}
+
+// lunar-solar periodics at t (dpper, init 'n', opsmode 'i')
+void dpper(const Sgp4Deep &d, double t, double &ep, double &inclp, double &nodep,
+           double &argpp, double &mp){
+  double zm=d.zmos+ZNS*t;
+  double zf=zm+2.0*ZES*sin(zm);
+  double sinzf=sin(zf);
+  double f2=0.5*sinzf*sinzf-0.25;
+  double f3=-0.5*sinzf*cos(zf);
+  const double ses=d.se2*f2+d.se3*f3;
+  const double sis=d.si2*f2+d.si3*f3;
+  const double sls=d.sl2*f2+d.sl3*f3+d.sl4*sinzf;
+  const double sghs=d.sgh2*f2+d.sgh3*f3+d.sgh4*sinzf;
+  const double shs=d.sh2*f2+d.sh3*f3;
+
+  zm=d.zmol+ZNL*t;
+  zf=zm+2.0*ZEL*sin(zm);
+  sinzf=sin(zf);
+  f2=0.5*sinzf*sinzf-0.25;
+  f3=-0.5*sinzf*cos(zf);
+  const double sel=d.ee2*f2+d.e3*f3;
+  const double sil=d.xi2*f2+d.xi3*f3;
+  const double sll=d.xl2*f2+d.xl3*f3+d.xl4*sinzf;
+  const double sghl=d.xgh2*f2+d.xgh3*f3+d.xgh4*sinzf;
+  const double shll=d.xh2*f2+d.xh3*f3;
+
+  const double pe=ses+sel-d.peo;
+  const double pinc=sis+sil-d.pinco;
+  const double pl=sls+sll-d.plo;
+  double pgh=sghs+sghl-d.pgho;
+  double ph=shs+shll-d.pho;
+
+  inclp=inclp+pinc;
+  ep=ep+pe;
+  const double sinip=sin(inclp), cosip=cos(inclp);
+
+  if(inclp>=0.2){
+    ph=ph/sinip;
+    pgh=pgh-cosip*ph;
+    argpp=argpp+pgh;
+    nodep=nodep+ph;
+    mp=mp+pl;
+  } else {
+    // Lyddane pro malé sklony
+    const double sinop=sin(nodep), cosop=cos(nodep);
+    double alfdp=sinip*sinop;
+    double betdp=sinip*cosop;
+    const double dalf=ph*cosop+pinc*cosip*sinop;
+    const double dbet=-ph*sinop+pinc*cosip*cosop;
+    alfdp=alfdp+dalf;
+    betdp=betdp+dbet;
+    nodep=fmod(nodep,TWOPI);
+    double xls=mp+argpp+cosip*nodep;
+    const double dls=pl+pgh-pinc*nodep*sinip;
+    xls=xls+dls;
+    const double xnoh=nodep;
+    nodep=atan2(alfdp,betdp);
+    if(fabs(xnoh-nodep)>M_PI){
+      if(nodep<xnoh) nodep=nodep+TWOPI;
+      else nodep=nodep-TWOPI;
+    }
+    mp=mp+pl;
+    argpp=xls-mp-cosip*nodep;
+  }
+}
+
+// secular rates and resonance constants (dsinit at t = 0)
+void dsinit(const elsetrec &s, const DsCom &o, double xpidot, Sgp4Deep &d){
+  const double q22=1.7891679e-6, q31=2.1460748e-6, q33=2.2123015e-7;
+  const double root22=1.7891679e-6, root44=7.3636953e-9, root54=2.1765803e-9;
+  const double root32=3.7393792e-7, root52=1.1428639e-7;
+  const double nm=s.no, em=s.ecco, inclm=s.inclo;
+  const double emsq=o.emsq;
+
+  d.irez=0;
+  if(nm<0.0052359877 && nm>0.0034906585) d.irez=1;
+  if(nm>=8.26e-3 && nm<=9.24e-3 && em>=0.5) d.irez=2;
+
+  // sluneční
+  const double ses=o.ss1*ZNS*o.ss5;
+  const double sis=o.ss2*ZNS*(o.sz11+o.sz13);
+  const double sls=-ZNS*o.ss3*(o.sz1+o.sz3-14.0-6.0*emsq);
+  const double sghs=o.ss4*ZNS*(o.sz31+o.sz33-6.0);
+  double shs=-ZNS*o.ss2*(o.sz21+o.sz23);
+  if(inclm<5.2359877e-2 || inclm>M_PI-5.2359877e-2) shs=0.0;
+  if(o.sinim!=0.0) shs=shs/o.sinim;
+  const double sgs=sghs-o.cosim*shs;
+
+  // měsíční
+  d.dedt=ses+o.s1*ZNL*o.s5;
+  d.didt=sis+o.s2*ZNL*(o.z11+o.z13);
+  d.dmdt=sls-ZNL*o.s3*(o.z1+o.z3-14.0-6.0*emsq);
+  const double sghl=o.s4*ZNL*(o.z31+o.z33-6.0);
+  double shll=-ZNL*o.s2*(o.z21+o.z23);
+  if(inclm<5.2359877e-2 || inclm>M_PI-5.2359877e-2) shll=0.0;
+  d.domdt=sgs+sghl;
+  d.dnodt=shs;
+  if(o.sinim!=0.0){
+    d.domdt=d.domdt-o.cosim/o.sinim*shll;
+    d.dnodt=d.dnodt+shll/o.sinim;
+  }
+
+  d.d2201=d.d2211=d.d3210=d.d3222=d.d4410=d.d4422=0.0;
+  d.d5220=d.d5232=d.d5421=d.d5433=0.0;
+  d.del1=d.del2=d.del3=0.0;
+  d.xfact=d.xlamo=0.0;
+  if(d.irez==0) return;
+
+  // rezonance
+  const double theta=fmod(s.gsto,TWOPI);
+  const double aonv=pow(nm/grav().xke,X2O3);
+  const double cosim=o.cosim, sinim=o.sinim;
+  if(d.irez==2){
+    const double cosisq=cosim*cosim;
+    const double eoc=em*emsq;
+    const double g201=-0.306-(em-0.64)*0.440;
+    double g211, g310, g322, g410, g422, g520, g521, g532, g533;
+    if(em<=0.65){
+      g211=3.616-13.2470*em+16.2900*emsq;
+      g310=-19.302+117.3900*em-228.4190*emsq+156.5910*eoc;
+      g322=-18.9068+109.7927*em-214.6334*emsq+146.5816*eoc;
+      g410=-41.122+242.6940*em-471.0940*emsq+313.9530*eoc;
+      g422=-146.407+841.8800*em-1629.014*emsq+1083.4350*eoc;
+      g520=-532.114+3017.977*em-5740.032*emsq+3708.2760*eoc;
+    } else {
+      g211=-72.099+331.819*em-508.738*emsq+266.724*eoc;
+      g310=-346.844+1582.851*em-2415.925*emsq+1246.113*eoc;
+      g322=-342.585+1554.908*em-2366.899*emsq+1215.972*eoc;
+      g410=-1052.797+4758.686*em-7193.992*emsq+3651.957*eoc;
+      g422=-3581.690+16178.110*em-24462.770*emsq+12422.520*eoc;
+      if(em>0.715) g520=-5149.66+29936.92*em-54087.36*emsq+31324.56*eoc;
+      else         g520=1464.74-4664.75*em+3763.64*emsq;
+    }
+    if(em<0.7){
+      g533=-919.22770+4988.6100*em-9064.7700*emsq+5542.21*eoc;
+      g521=-822.71072+4568.6173*em-8491.4146*emsq+5337.524*eoc;
+      g532=-853.66600+4690.2500*em-8624.7700*emsq+5341.4*eoc;
+    } else {
+      g533=-37995.780+161616.52*em-229838.20*emsq+109377.94*eoc;
+      g521=-51752.104+218913.95*em-309468.16*emsq+146349.42*eoc;
+      g532=-40023.880+170470.89*em-242699.48*emsq+115605.82*eoc;
+    }
+    const double sini2=sinim*sinim;
+    const double f220=0.75*(1.0+2.0*cosim+cosisq);
+    const double f221=1.5*sini2;
+    const double f321=1.875*sinim*(1.0-2.0*cosim-3.0*cosisq);
+    const double f322=-1.875*sinim*(1.0+2.0*cosim-3.0*cosisq);
+    const double f441=35.0*sini2*f220;
+    const double f442=39.3750*sini2*sini2;
+    const double f522=9.84375*sinim*(sini2*(1.0-2.0*cosim-5.0*cosisq)+
+                      0.33333333*(-2.0+4.0*cosim+6.0*cosisq));
+    const double f523=sinim*(4.92187512*sini2*(-2.0-4.0*cosim+10.0*cosisq)+
+                      6.56250012*(1.0+2.0*cosim-3.0*cosisq));
+    const double f542=29.53125*sinim*(2.0-8.0*cosim+cosisq*(-12.0+8.0*cosim+10.0*cosisq));
+    const double f543=29.53125*sinim*(-2.0-8.0*cosim+cosisq*(12.0+8.0*cosim-10.0*cosisq));
+    const double xno2=nm*nm, ainv2=aonv*aonv;
+    double temp1=3.0*xno2*ainv2;
+    double temp=temp1*root22;
+    d.d2201=temp*f220*g201;
+    d.d2211=temp*f221*g211;
+    temp1=temp1*aonv;
+    temp=temp1*root32;
+    d.d3210=temp*f321*g310;
+    d.d3222=temp*f322*g322;
+    temp1=temp1*aonv;
+    temp=2.0*temp1*root44;
+    d.d4410=temp*f441*g410;
+    d.d4422=temp*f442*g422;
+    temp1=temp1*aonv;
+    temp=temp1*root52;
+    d.d5220=temp*f522*g520;
+    d.d5232=temp*f523*g532;
+    temp=2.0*temp1*root54;
+    d.d5421=temp*f542*g521;
+    d.d5433=temp*f543*g533;
+    d.xlamo=fmod(s.mo+s.nodeo+s.nodeo-theta-theta,TWOPI);
+    d.xfact=s.mdot+d.dmdt+2.0*(s.nodedot+d.dnodt-RPTIM)-s.no;
+  } else {
+    const double g200=1.0+emsq*(-2.5+0.8125*emsq);
+    const double g310=1.0+2.0*emsq;
+    const double g300=1.0+emsq*(-6.0+6.60937*emsq);
+    const double f220=0.75*(1.0+cosim)*(1.0+cosim);
+    const double f311=0.9375*sinim*sinim*(1.0+3.0*cosim)-0.75*(1.0+cosim);
+    double f330=1.0+cosim;
+    f330=1.875*f330*f330*f330;
+    d.del1=3.0*nm*nm*aonv*aonv;
+    d.del2=2.0*d.del1*f220*g200*q22;
+    d.del3=3.0*d.del1*f330*g300*q33*aonv;
+    d.del1=d.del1*f311*g310*q31*aonv;
+    d.xlamo=fmod(s.mo+s.nodeo+s.argpo-theta,TWOPI);
+    d.xfact=s.mdot+xpidot-RPTIM+d.dmdt+d.domdt+d.dnodt-s.no;
+  }
+}
+
+// resonance integrator (dspace): Euler-Maclaurin steps of 720 min from the
+// cursor; gives mean motion nm and mean anomaly mm at t
+void dspace(const elsetrec &s, const Sgp4Deep &d, double t, Sgp4Resonance &c,
+            double nodem, double argpm, double &mm, double &nm){
+  const double fasx2=0.13130908, fasx4=2.8843198, fasx6=0.37448087;
+  const double g22=5.7686396, g32=0.95240898, g44=1.8014998;
+  const double g52=1.0508330, g54=4.4108898;
+  const double stepp=720.0, step2=259200.0;
+
+  const double theta=fmod(s.gsto+t*RPTIM,TWOPI);
+  // dopředu i dozadu od epochy; zpět přes nulu nebo k epoše = znovu od epochy
+  if(c.atime==0.0 || t*c.atime<=0.0 || fabs(t)<fabs(c.atime)){
+    c.atime=0.0;
+    c.xni=s.no;
+    c.xli=d.xlamo;
+  }
+  const double delt=t>0.0?stepp:-stepp;
+
+  double xndt, xldot, xnddt, ft;
+  for(;;){
+    if(d.irez!=2){
+      xndt=d.del1*sin(c.xli-fasx2)+d.del2*sin(2.0*(c.xli-fasx4))+d.del3*sin(3.0*(c.xli-fasx6));
+      xldot=c.xni+d.xfact;
+      xnddt=d.del1*cos(c.xli-fasx2)+2.0*d.del2*cos(2.0*(c.xli-fasx4))+
+            3.0*d.del3*cos(3.0*(c.xli-fasx6));
+      xnddt=xnddt*xldot;
+    } else {
+      const double xomi=s.argpo+s.argpdot*c.atime;
+      const double x2omi=xomi+xomi;
+      const double x2li=c.xli+c.xli;
+      xndt=d.d2201*sin(x2omi+c.xli-g22)+d.d2211*sin(c.xli-g22)+
+           d.d3210*sin(xomi+c.xli-g32)+d.d3222*sin(-xomi+c.xli-g32)+
+           d.d4410*sin(x2omi+x2li-g44)+d.d4422*sin(x2li-g44)+
+           d.d5220*sin(xomi+c.xli-g52)+d.d5232*sin(-xomi+c.xli-g52)+
+           d.d5421*sin(xomi+x2li-g54)+d.d5433*sin(-xomi+x2li-g54);
+      xldot=c.xni+d.xfact;
+      xnddt=d.d2201*cos(x2omi+c.xli-g22)+d.d2211*cos(c.xli-g22)+
+            d.d3210*cos(xomi+c.xli-g32)+d.d3222*cos(-xomi+c.xli-g32)+
+            d.d5220*cos(xomi+c.xli-g52)+d.d5232*cos(-xomi+c.xli-g52)+
+            2.0*(d.d4410*cos(x2omi+x2li-g44)+d.d4422*cos(x2li-g44)+
+                 d.d5421*cos(xomi+x2li-g54)+d.d5433*cos(-xomi+x2li-g54));
+      xnddt=xnddt*xldot;
+    }
+    if(fabs(t-c.atime)<stepp){ ft=t-c.atime; break; }
+    c.xli=c.xli+xldot*delt+xndt*step2;
+    c.xni=c.xni+xndt*delt+xnddt*step2;
+    c.atime=c.atime+delt;
+  }
+
+  nm=c.xni+xndt*ft+xnddt*ft*ft*0.5;
+  const double xl=c.xli+xldot*ft+xndt*ft*ft*0.5;
+  if(d.irez!=1) mm=xl-2.0*nodem+2.0*theta;
+  else          mm=xl-nodem-argpm+theta;
+}
+
+// deep-space sgp4() in double; v may be nullptr
+int deepSpace(const Sgp4Elements &e, double t, Sgp4Resonance &res, double r[3], double v[3]){
+  const elsetrec &s=e.rec;
+  const Sgp4Deep &d=e.ds;
+  const GravConst &g=grav();
+
+  // sekulární gravitace a odpor (isimp = 1)
+  const double t2=t*t;
+  double mm=s.mo+s.mdot*t;
+  double argpm=s.argpo+s.argpdot*t;
+  double nodem=s.nodeo+s.nodedot*t+s.nodecf*t2;
+  const double tempa=1.0-s.cc1*t;
+  const double tempe=s.bstar*s.cc4*t;
+  const double templ=s.t2cof*t2;
+
+  // lunisolární sekulární členy a rezonance
+  double em=s.ecco+d.dedt*t;
+  double inclm=s.inclo+d.didt*t;
+  argpm=argpm+d.domdt*t;
+  nodem=nodem+d.dnodt*t;
+  mm=mm+d.dmdt*t;
+  double nm=s.no;
+  if(d.irez!=0) dspace(s,d,t,res,nodem,argpm,mm,nm);
+
+  if(nm<=0.0) return 2;
+  const double am=pow(g.xke/nm,X2O3)*tempa*tempa;
+  em=em-tempe;
+  if(em>=1.0 || em<-0.001 || am<0.95) return 1;
+  if(em<1.0e-6) em=1.0e-6;
+  mm=mm+s.no*templ;
+  double xlm=mm+argpm+nodem;
+  nodem=fmod(nodem,TWOPI);
+  argpm=fmod(argpm,TWOPI);
+  xlm=fmod(xlm,TWOPI);
+  mm=fmod(xlm-argpm-nodem,TWOPI);
+
+  double ep=em, xincp=inclm, argpp=argpm, nodep=nodem, mp=mm;
+  dpper(d,t,ep,xincp,nodep,argpp,mp);
+  if(xincp<0.0){
+    xincp=-xincp;
+    nodep=nodep+M_PI;
+    argpp=argpp-M_PI;
+  }
+  if(ep<0.0 || ep>1.0) return 3;
+
+  // konstanty periodik ze sklonu po lunisolárních periodikách
+  const double sinip=sin(xincp), cosip=cos(xincp);
+  const double cosisq=cosip*cosip;
+  PerConst<double> c;
+  c.aycof=-0.5*g.j3oj2*sinip;
+  c.xlcof=-0.25*g.j3oj2*sinip*(3.0+5.0*cosip)/(fabs(cosip+1.0)>1.5e-12?1.0+cosip:1.5e-12);
+  c.con41=3.0*cosisq-1.0;
+  c.x1mth2=1.0-cosisq;
+  c.x7thm1=7.0*cosisq-1.0;
+  return periodics<double>(ep,argpp,nodep,mp,am,xincp,sinip,cosip,c,r,v);
+}
+
+// ==================== init (twoline2rv, sgp4init) ====================
+
+// columns c0..c1 (1-based, inclusive) of a TLE line as a number
+double tleField(const char* l, int c0, int c1){
+  char b[24];
+  const int n=c1-c0+1;
+  memcpy(b,l+c0-1,n);
+  b[n]='\0';
+  return atof(b);
+}
+
+// " 12345-4" = 0.12345e-4 (BSTAR, nddot)
+double tleExp(const char* l, int c0){
+  char m[8]="0.";
+  memcpy(m+2,l+c0,5);
+  m[7]='\0';
+  const double mant=atof(m)*(l[c0-1]=='-'?-1.0:1.0);
+  return mant*pow(10.0,tleField(l,c0+6,c0+7));
+}
+
+// Alpha-5: A0000 = 100000 (bez I a O)
+long tleSatnum(const char* l){
+  char c=l[2];
+  if(c>='A' && c<='Z'){
+    int v=c-'A'+10;
+    if(c>'I') v--;
+    if(c>'O') v--;
+    return v*10000L+(long)tleField(l,4,7);
+  }
+  return (long)tleField(l,3,7);
+}
+
+bool parseTle(const char* l1, const char* l2, elsetrec &s){
+  if(strlen(l1)<69 || strlen(l2)<69 || l1[0]!='1' || l2[0]!='2') return false;
+  const double xpdotp=1440.0/TWOPI;   // rev/den -> rad/min
+  const double deg2rad=M_PI/180.0;
+  memset(&s,0,sizeof(s));
+  s.satnum=tleSatnum(l1);
+  const int yr=(int)tleField(l1,19,20);
+  s.epochyr=yr;
+  s.epochdays=tleField(l1,21,32);
+  s.ndot=tleField(l1,34,43)/(xpdotp*1440.0);
+  s.nddot=tleExp(l1,45)/(xpdotp*1440.0*1440.0);
+  s.bstar=tleExp(l1,54);
+
+  s.inclo=tleField(l2,9,16)*deg2rad;
+  s.nodeo=tleField(l2,18,25)*deg2rad;
+  char ecc[10]="0.";
+  memcpy(ecc+2,l2+26,7);
+  ecc[9]='\0';
+  s.ecco=atof(ecc);
+  s.argpo=tleField(l2,35,42)*deg2rad;
+  s.mo=tleField(l2,44,51)*deg2rad;
+  s.no=tleField(l2,53,63)/xpdotp;
+  if(s.no<=0.0 || s.ecco>=1.0) return false;
+
+  // epocha: 1. ledna roku + dny - 1
+  const int year=yr<57?yr+2000:yr+1900;
+  const double jdJan1=367.0*year-floor(7*(year+floor(10.0/12))*0.25)+floor(275.0/9)+1+1721013.5;
+  s.jdsatepoch=jdJan1-1+s.epochdays;
+  return true;
+}
+
+// initl(): Kozai mean motion of the TLE -> Brouwer
+void unKozai(elsetrec &s){
+  const double j2=grav().j2;
+  const double omeosq=1.0-s.ecco*s.ecco, rteosq=sqrt(omeosq);
+  const double cosio=cos(s.inclo), cosio2=cosio*cosio;
+  const double ak=pow(grav().xke/s.no,X2O3);
+  const double d1=0.75*j2*(3.0*cosio2-1.0)/(rteosq*omeosq);
+  double del=d1/(ak*ak);
+  const double adel=ak*(1.0-del*del-del*(1.0/3.0+134.0*del*del/81.0));
+  del=d1/(adel*adel);
+  s.no=s.no/(1.0+del);
+}
+
+// sgp4init() from the elements and Brouwer no; deep space into ds
+bool setup(elsetrec &s, Sgp4Deep &ds){
+  const GravConst &g=grav();
+  const double re=g.reKm, j2=g.j2;
+  if(s.no<=0.0 || s.ecco<0.0 || s.ecco>=1.0) return false;
+
+  const double ss=78.0/re+1.0, qzms2t=pow((120.0-78.0)/re,4);
+  s.error=0;
+  s.method='n';
+  const double eccsq=s.ecco*s.ecco, omeosq=1.0-eccsq, rteosq=sqrt(omeosq);
+  const double cosio=cos(s.inclo), cosio2=cosio*cosio, sinio=sin(s.inclo);
+  const double ao=pow(g.xke/s.no,X2O3);
+  const double po=ao*omeosq, con42=1.0-5.0*cosio2;
+  s.con41=-con42-cosio2-cosio2;
+  const double posq=po*po, rp=ao*(1.0-s.ecco);
+  s.gsto=gstime(s.jdsatepoch);
+  s.a=ao;
+  s.alta=ao*(1.0+s.ecco)-1.0;
+  s.altp=rp-1.0;
+
+  s.isimp=0;
+  if(rp<220.0/re+1.0) s.isimp=1;
+  double sfour=ss, qzms24=qzms2t;
+  const double perige=(rp-1.0)*re;
+  if(perige<156.0){
+    sfour=perige-78.0;
+    if(perige<98.0) sfour=20.0;
+    qzms24=pow((120.0-sfour)/re,4);
+    sfour=sfour/re+1.0;
+  }
+  const double pinvsq=1.0/posq;
+  const double tsi=1.0/(ao-sfour);
+  s.eta=ao*s.ecco*tsi;
+  const double etasq=s.eta*s.eta, eeta=s.ecco*s.eta, psisq=fabs(1.0-etasq);
+  const double coef=qzms24*pow(tsi,4), coef1=coef/pow(psisq,3.5);
+  const double cc2=coef1*s.no*(ao*(1.0+1.5*etasq+eeta*(4.0+etasq))+
+                   0.375*j2*tsi/psisq*s.con41*(8.0+3.0*etasq*(8.0+etasq)));
+  s.cc1=s.bstar*cc2;
+  double cc3=0.0;
+  if(s.ecco>1.0e-4) cc3=-2.0*coef*tsi*g.j3oj2*s.no*sinio/s.ecco;
+  s.x1mth2=1.0-cosio2;
+  s.cc4=2.0*s.no*coef1*ao*omeosq*(s.eta*(2.0+0.5*etasq)+s.ecco*(0.5+2.0*etasq)-
+        j2*tsi/(ao*psisq)*(-3.0*s.con41*(1.0-2.0*eeta+etasq*(1.5-0.5*eeta))+
+        0.75*s.x1mth2*(2.0*etasq-eeta*(1.0+etasq))*cos(2.0*s.argpo)));
+  s.cc5=2.0*coef1*ao*omeosq*(1.0+2.75*(etasq+eeta)+eeta*etasq);
+  const double cosio4=cosio2*cosio2;
+  const double temp1=1.5*j2*pinvsq*s.no;
+  const double temp2=0.5*temp1*j2*pinvsq;
+  const double temp3=-0.46875*g.j4*pinvsq*pinvsq*s.no;
+  s.mdot=s.no+0.5*temp1*rteosq*s.con41+0.0625*temp2*rteosq*(13.0-78.0*cosio2+137.0*cosio4);
+  s.argpdot=-0.5*temp1*con42+0.0625*temp2*(7.0-114.0*cosio2+395.0*cosio4)+
+            temp3*(3.0-36.0*cosio2+49.0*cosio4);
+  const double xhdot1=-temp1*cosio;
+  s.nodedot=xhdot1+(0.5*temp2*(4.0-19.0*cosio2)+2.0*temp3*(3.0-7.0*cosio2))*cosio;
+  const double xpidot=s.argpdot+s.nodedot;
+  s.omgcof=s.bstar*cc3*cos(s.argpo);
+  s.xmcof=0.0;
+  if(s.ecco>1.0e-4) s.xmcof=-X2O3*coef*s.bstar/eeta;
+  s.nodecf=3.5*omeosq*xhdot1*s.cc1;
+  s.t2cof=1.5*s.cc1;
+  if(fabs(cosio+1.0)>1.5e-12) s.xlcof=-0.25*g.j3oj2*sinio*(3.0+5.0*cosio)/(1.0+cosio);
+  else                        s.xlcof=-0.25*g.j3oj2*sinio*(3.0+5.0*cosio)/1.5e-12;
+  s.aycof=-0.5*g.j3oj2*sinio;
+  s.delmo=pow(1.0+s.eta*cos(s.mo),3);
+  s.sinmao=sin(s.mo);
+  s.x7thm1=7.0*cosio2-1.0;
+
+  memset(&ds,0,sizeof(ds));
+  s.d2=s.d3=s.d4=s.t3cof=s.t4cof=s.t5cof=0.0;
+  if(TWOPI/s.no>=225.0){
+    // perioda >= 225 min: deep space (dpper při init nic nemění)
+    s.method='d';
+    s.isimp=1;
+    DsCom o={};
+    dscom(s.jdsatepoch-2433281.5,s.ecco,s.argpo,s.inclo,s.nodeo,s.no,ds,o);
+    dsinit(s,o,xpidot,ds);
+    s.irez=ds.irez;
+  }
+
+  if(s.isimp!=1){
+    const double cc1sq=s.cc1*s.cc1;
+    s.d2=4.0*ao*tsi*cc1sq;
+    const double temp=s.d2*tsi*s.cc1/3.0;
+    s.d3=(17.0*ao+sfour)*temp;
+    s.d4=0.5*temp*ao*tsi*(221.0*ao+31.0*sfour)*s.cc1;
+    s.t3cof=s.d2+2.0*cc1sq;
+    s.t4cof=0.25*(3.0*s.d3+s.cc1*(12.0*s.d2+10.0*cc1sq));
+    s.t5cof=0.2*(3.0*s.d4+12.0*s.cc1*s.d3+6.0*s.d2*s.d2+15.0*cc1sq*(2.0*s.d2+cc1sq));
+  }
+  s.init='n';
+  return true;
+}
+
+}  // namespace
+
+// ---- reentrant propagator ----
+static bool elementsFinish(Sgp4Elements &e){
+  e.am0=pow(grav().xke/e.rec.no,2.0/3.0);
+  e.sinio=sin(e.rec.inclo);
+  e.cosio=cos(e.rec.inclo);
+  // chyba už v epoše (rozpad, špatná e) jako sgp4init()
+  double r[3];
+  Sgp4Resonance res={0.0,0.0,0.0};
+  const int err=e.rec.method=='d'?deepSpace(e,0.0,res,r,nullptr)
+                                 :nearEarth<double>(e.rec,e.am0,e.sinio,e.cosio,0.0,r,nullptr);
+  e.rec.error=err;
+  return err==0;
+}
+
+bool sgp4ElementsInit(Sgp4Elements &e, const elsetrec &initialized){
+  e.rec=initialized;
+  if(!setup(e.rec,e.ds)) return false;
+  return elementsFinish(e);
+}
+
+bool sgp4ElementsFromTle(Sgp4Elements &e, const char* l1, const char* l2){
+  if(!parseTle(l1,l2,e.rec)) return false;
+  unKozai(e.rec);
+  if(!setup(e.rec,e.ds)) return false;
+  return elementsFinish(e);
+}
+
+template<typename T>
+Sgp4State<T> sgp4Propagate(const Sgp4Elements &e, double t, Sgp4Resonance* res){
+  Sgp4State<T> st;
+  if(e.rec.method=='d'){
+    Sgp4Resonance own={0.0,0.0,0.0};
+    double rd[3], vd[3];
+    st.error=deepSpace(e,t,res?*res:own,rd,vd);
+    for(int i=0;i<3;i++){ st.r[i]=(T)rd[i]; st.v[i]=(T)vd[i]; }
+    return st;
+  }
+  st.error=nearEarth<T>(e.rec,e.am0,(T)e.sinio,(T)e.cosio,t,st.r,st.v);
+  return st;
+}
+
+template Sgp4State<float>  sgp4Propagate<float>(const Sgp4Elements&, double, Sgp4Resonance*);
+template Sgp4State<double> sgp4Propagate<double>(const Sgp4Elements&, double, Sgp4Resonance*);
@@ -0,0 +1,85 @@
+// sgp4_core.h
+// SGP4 in-tree: the reentrant sgp4Propagate() for all orbits, its own init
+// included (Sgp4Elements), templated on the floating type of the periodic
+// part. The near-earth secular terms and the angle reductions always run in
+// double (they grow with time since epoch); the Kepler solution,
+// short-period terms and orientation run in T. The ESP32 FPU only does
+// float, so T=float is the cheaper choice there.
+#pragma once
+#include <math.h>
+#include <Sgp4.h>
+
+// float/double overloads for code templated on precision
+namespace sgpm {
+inline float  sin(float x){ return sinf(x); }
+inline float  cos(float x){ return cosf(x); }
+inline float  asin(float x){ return asinf(x); }
+inline float  sqrt(float x){ return sqrtf(x); }
+inline float  atan2(float y, float x){ return atan2f(y,x); }
+inline float  fabs(float x){ return fabsf(x); }
+inline double sin(double x){ return ::sin(x); }
+inline double cos(double x){ return ::cos(x); }
+inline double asin(double x){ return ::asin(x); }
+inline double sqrt(double x){ return ::sqrt(x); }
+inline double atan2(double y, double x){ return ::atan2(y,x); }
+inline double fabs(double x){ return ::fabs(x); }
+}
+
+// ---- reentrant propagator ----
+// Sgp4::findsat() leaves its results in the object (satAz, satEl, ...), so
+// every caller needs its own. Sgp4Elements is a read-only snapshot of all
+// sgp4init() constants plus the terms sgp4() would redo on every call (the
+// semi-major axis of the mean motion, sin/cos of the inclination);
+// sgp4Propagate() only reads it, so one Sgp4Elements serves any number of
+// threads. Everything runs in-tree, init included: the near-earth branch,
+// and for periods of 225 min and more Vallado's deep-space routines (dscom,
+// dpper, dsinit, dspace: lunar-solar periodics, 12 h and 24 h resonance).
+// The library is only used for its elsetrec layout, getgravconst() and
+// gstime().
+
+// deep-space constants (dscom/dsinit), method 'd' only
+struct Sgp4Deep {
+  double e3, ee2, peo, pgho, pho, pinco, plo;
+  double se2, se3, sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2, sl3, sl4;
+  double xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4, zmol, zmos;
+  double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433;
+  double dedt, didt, dmdt, dnodt, domdt, del1, del2, del3, xfact, xlamo;
+  int    irez;         // rezonance: 0 žádná, 1 synchronní (24 h), 2 půldenní (12 h)
+};
+
+struct Sgp4Elements {
+  elsetrec rec;        // po sgp4init() (in-tree), jen ke čtení
+  double   am0;        // (xke/no)^(2/3)
+  double   sinio, cosio;
+  Sgp4Deep ds;
+};
+
+// State of the resonance integrator (dspace) of one caller. Without it
+// every call integrates from epoch in 720 min steps, so the cost grows with
+// tsince (a GEO or 12 h orbit a week from epoch: 14 steps). A caller that
+// steps forward keeps one zero-initialized Sgp4Resonance per satellite and
+// continues from the last step, like the library's satrec does; results
+// are the same either way (same step grid).
+struct Sgp4Resonance {
+  double atime;        // min od epochy, 0 = začít od epochy
+  double xli, xni;
+};
+
+template<typename T>
+struct Sgp4State {
+  T   r[3];            // TEME, km
+  T   v[3];            // TEME, km/s
+  int error;           // 0 = OK, jinak kód chyby SGP4 (1 e/a, 2 n, 3 e po periodikách, 4 p<0, 6 rozpad)
+};
+
+// From a record the library already initialized (Sgp4::init()): takes its
+// elements and Brouwer mean motion and recomputes every constant in-tree.
+bool sgp4ElementsInit(Sgp4Elements &e, const elsetrec &initialized);
+// twoline2rv() + sgp4init() in-tree (Alpha-5 catalog numbers included).
+bool sgp4ElementsFromTle(Sgp4Elements &e, const char* l1, const char* l2);
+
+// State at tsince minutes from epoch; res = optional integrator state of the
+// caller for deep-space resonance (see Sgp4Resonance), nullptr = from epoch.
+// Deep space always runs in double, T only applies to near-earth orbits.
+template<typename T>
+Sgp4State<T> sgp4Propagate(const Sgp4Elements &e, double tsince, Sgp4Resonance* res=nullptr);
@@ -0,0 +1,38 @@
+// tle_file.cpp
+#include "tle_file.h"
+#include <stdio.h>
+#include <string.h>
+
+static void trimLine(char* s){
+  size_t n=strlen(s);
+  while(n>0 && (s[n-1]=='\n'||s[n-1]=='\r'||s[n-1]==' '||s[n-1]=='\t')) s[--n]='\0';
+}
+
+bool loadTleFile(const char* path, std::vector<TleSet> &out){
+  FILE* f=fopen(path,"r");
+  if(!f) return false;
+  char line[256], name[256]="";
+  TleSet cur;
+  bool haveL1=false;
+  while(fgets(line,sizeof(line),f)){
+    trimLine(line);
+    if(line[0]=='#') continue;   // komentář
+    if(line[0]=='1' && line[1]==' '){
+      strncpy(cur.l1,line,TLE_LINE_MAX-1); cur.l1[TLE_LINE_MAX-1]='\0';
+      haveL1=true;
+    } else if(line[0]=='2' && line[1]==' ' && haveL1){
+      strncpy(cur.l2,line,TLE_LINE_MAX-1); cur.l2[TLE_LINE_MAX-1]='\0';
+      if(name[0]) cur.name=name;
+      else cur.name=std::string(cur.l1+2,5);
+      out.push_back(cur);
+      haveL1=false; name[0]='\0';
+    } else if(line[0]){
+      char* p=line;
+      if(p[0]=='0' && p[1]==' ') p+=2;   // "0 NAME" (3LE ze Space-Track)
+      strncpy(name,p,sizeof(name)-1); name[sizeof(name)-1]='\0';
+      haveL1=false;
+    }
+  }
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,16 @@
+// tle_file.h
+// TLE text files for the host tools: 3-line (name + TLE), "0 NAME" 3LE
+// from Space-Track, or plain 2-line sets. Lines starting with # are skipped.
+#pragma once
+#include <string>
+#include <vector>
+#include "sat_predict.h"
+
+struct TleSet {
+  std::string name;   // bez jména: katalogové číslo
+  char l1[TLE_LINE_MAX];
+  char l2[TLE_LINE_MAX];
+};
+
+// Appends all sets in path to out; false when the file cannot be read.
+bool loadTleFile(const char* path, std::vector<TleSet> &out);
@@ -0,0 +1,241 @@
+// sat_bench_main.cpp
+// Native benchmark of the prediction core (lib/SatPredict/sat_bench).
+//
+//   pio run -e bench
+//   .pio/build/bench/program [--quick] [--threads N] [--tle FILE] [--out FILE]
+//   .pio/build/bench/program --precision [--sats N] [--tle FILE]
+//   .pio/build/bench/program --reference [--tle FILE] [--qth FILE] [--hours H]
+//   .pio/build/bench/program --verify [--tle SGP4-VER.TLE --vectors tcppver.out]
+//
+// Prints one JSON object (stdout or --out) and a readable table on stderr.
+// The device runs the same kernels with the serial command "bench".
+// --precision compares the float coarse scan with all-double results and
+// exits with 1 when a difference is over its PREC_* tolerance.
+// --reference runs the 10 s / 1 s brute-force pass search over the stored
+// corpus (src/bench/corpus, run from the project root) and compares every
+// fast predictor with it: missed/extra passes, AOS/LOS/tMax/maxEl errors,
+// speedup. Exits with 1 when an ACC_* tolerance is exceeded.
+// --verify checks sgp4Propagate() against Vallado's SGP4 test vectors: the
+// built-in subset, or the complete SGP4-VER.TLE / tcppver.out pair from the
+// paper's distribution (error cases included). Exits with 1 when a VER_* tolerance is exceeded.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "sat_bench.h"
+#include "sgp4_batch.h"
+#include "job_queue.h"
+#include "tle_file.h"
+
+static const char* CORPUS_TLE = "src/bench/corpus/satellites.tle";
+static const char* CORPUS_QTH = "src/bench/corpus/qth.txt";
+
+static void usage(){
+  fprintf(stderr,"usage: program [--quick] [--threads N] [--tle FILE] [--out FILE]\n"
+                 "       program --precision [--sats N] [--tle FILE] [--out FILE]\n"
+                 "       program --reference [--tle FILE] [--qth FILE] [--hours H] [--out FILE]\n"
+                 "       program --verify [--tle SGP4-VER.TLE --vectors tcppver.out] [--out FILE]\n");
+}
+
+// "lat lon alt_m minel name" per line, # = komentář
+static bool loadQthFile(const char* path, std::vector<AccuracyQth> &out){
+  FILE* f=fopen(path,"r");
+  if(!f) return false;
+  char line[160];
+  while(fgets(line,sizeof(line),f)){
+    if(line[0]=='#') continue;
+    AccuracyQth q;
+    memset(&q,0,sizeof(q));
+    if(sscanf(line,"%lf %lf %lf %f %23s",&q.latDeg,&q.lonDeg,&q.altM,&q.minElDeg,q.name)<4) continue;
+    out.push_back(q);
+  }
+  fclose(f);
+  return true;
+}
+
+// tcppver.out: "<satnum> xx" uvozuje satelit, pak "tsince x y z vx vy vz ...",
+// chyby SGP4 jako "# *** error: t:= ... *** code = N"
+static bool loadVectorFile(const char* path, std::vector<Sgp4Vector> &out){
+  FILE* f=fopen(path,"r");
+  if(!f) return false;
+  char line[512];
+  long satnum=-1;
+  while(fgets(line,sizeof(line),f)){
+    if(strstr(line,"xx")){ satnum=atol(line); continue; }
+    Sgp4Vector v;
+    memset(&v,0,sizeof(v));
+    v.satnum=satnum;
+    // "# *** error: t:= 60.000000 *** code =   6"
+    const char* e=strstr(line,"error: t:=");
+    if(e){
+      const char* c=strstr(line,"code =");
+      if(satnum<0 || !c) continue;
+      v.tsince=atof(e+10);
+      v.error=atoi(c+6);
+      out.push_back(v);
+      continue;
+    }
+    if(satnum<0 || sscanf(line,"%lf %lf %lf %lf %lf %lf %lf",&v.tsince,&v.r[0],&v.r[1],&v.r[2],
+                          &v.v[0],&v.v[1],&v.v[2])!=7) continue;
+    out.push_back(v);
+  }
+  fclose(f);
+  return true;
+}
+
+static int runVerify(const std::vector<const char*> &l1, const std::vector<const char*> &l2,
+                     const char* vecPath, FILE* f){
+  std::vector<Sgp4Vector> vecs;
+  const char* const* a;
+  const char* const* b;
+  const Sgp4Vector* v;
+  int nTle, nVec;
+  if(vecPath){
+    if(!loadVectorFile(vecPath,vecs) || vecs.empty()){
+      fprintf(stderr,"no vectors in %s\n",vecPath); return 1;
+    }
+    a=l1.data(); b=l2.data(); nTle=(int)l1.size();
+    v=vecs.data(); nVec=(int)vecs.size();
+  } else {
+    nTle=sgp4VerBuiltin(a,b,v,nVec);
+  }
+  Sgp4VerifyReport rep;
+  runSgp4Verify(a,b,nTle,v,nVec,rep);
+  fprintf(stderr,"[VER] %d sats, %d vectors (%d without TLE): pos %.2e km, vel %.2e km/s "
+          "(worst %ld at %.1f min), float pos %.4f km, %d failed -> %s\n",
+          rep.sats,rep.vectors,rep.noTle,rep.maxPosErrKm,rep.maxVelErrKms,rep.worstSat,
+          rep.worstTsince,rep.maxPosErrF32Km,rep.failed,rep.ok?"OK":"FAIL");
+  static char json[512];
+  sgp4VerifyJson(json,sizeof(json),rep,nullptr);
+  fprintf(f,"%s\n",json);
+  return rep.ok?0:1;
+}
+
+static int runReference(BenchConfig &cfg, const std::vector<TleSet> &tles, const char* qthPath,
+                        FILE* f){
+  std::vector<AccuracyQth> qths;
+  if(!loadQthFile(qthPath,qths) || qths.empty()){
+    fprintf(stderr,"no QTHs in %s\n",qthPath); return 1;
+  }
+  static AccuracyReport rep;
+  runAccuracyCheck(cfg,cfg.tleCount,qths.data(),(int)qths.size(),rep);
+
+  fprintf(stderr,"[ACC] reference: %d sats x %d QTHs, %d h, %d passes, %lu findsat, %.0f ms\n",
+          rep.sats,rep.qths,rep.hours,rep.refPasses,(unsigned long)rep.refCalls,rep.refUs/1000.0);
+  for(int k=0;k<rep.count;k++){
+    const AccuracyResult &r=rep.res[k];
+    fprintf(stderr,"[ACC] %-20s %5d passes, %d missed, %d extra (+%d short); "
+            "AOS %d s, LOS %d s, tMax %d s (%.3f deg), maxEl %.3f deg (low %.3f); "
+            "%lu SGP4, %.0f ms, x%.1f -> %s\n",
+            r.name,r.passes,r.missed,r.extra,r.extraShort,r.maxAosErrS,r.maxLosErrS,
+            r.maxTmaxErrS,r.maxTmaxDeficitDeg,r.maxElErrDeg,r.maxElDeficitDeg,(unsigned long)r.sgp4Calls,r.us/1000.0,r.speedup,
+            r.ok?"OK":"FAIL");
+  }
+  for(int i=0;i<rep.listCount;i++){
+    const AccuracyMiss &m=rep.list[i];
+    char t[24];
+    tm u; gmtime_r(&m.pass.aos,&u);
+    strftime(t,sizeof(t),"%Y-%m-%dT%H:%M:%SZ",&u);
+    fprintf(stderr,"[ACC]   %s %s: %s at %s, AOS %s, %ld s, max %.1f deg\n",
+            rep.res[m.predictor].name,m.missed?"missed":"extra",tles[m.sat].name.c_str(),
+            qths[m.qth].name,t,(long)(m.pass.los-m.pass.aos),m.pass.maxEl);
+  }
+
+  static char json[4096];
+  accuracyJson(json,sizeof(json),rep,nullptr);
+  fprintf(f,"%s\n",json);
+  return rep.ok?0:1;
+}
+
+int main(int argc, char** argv){
+  bool quick=false, precision=false, reference=false, verify=false;
+  int threads=0, precSats=128, hours=0;
+  const char* tlePath=nullptr;
+  const char* qthPath=nullptr;
+  const char* outPath=nullptr;
+  const char* vecPath=nullptr;
+  for(int i=1;i<argc;i++){
+    const char* a=argv[i];
+    bool hasVal=i+1<argc;
+    if(!strcmp(a,"--quick")) quick=true;
+    else if(!strcmp(a,"--precision")) precision=true;
+    else if(!strcmp(a,"--reference")) reference=true;
+    else if(!strcmp(a,"--verify")) verify=true;
+    else if(!strcmp(a,"--vectors") && hasVal) vecPath=argv[++i];
+    else if(!strcmp(a,"--qth") && hasVal) qthPath=argv[++i];
+    else if(!strcmp(a,"--hours") && hasVal) hours=atoi(argv[++i]);
+    else if(!strcmp(a,"--sats") && hasVal) precSats=atoi(argv[++i]);
+    else if(!strcmp(a,"--threads") && hasVal) threads=atoi(argv[++i]);
+    else if(!strcmp(a,"--tle") && hasVal) tlePath=argv[++i];
+    else if(!strcmp(a,"--out") && hasVal) outPath=argv[++i];
+    else { usage(); return 2; }
+  }
+
+  BenchConfig cfg;
+  benchDefaults(cfg,quick);
+  if(hours>0) cfg.hours=hours;
+  if(reference && !tlePath) tlePath=CORPUS_TLE;
+  if(reference && !qthPath) qthPath=CORPUS_QTH;
+  if(verify && (!tlePath)!=(!vecPath)){ usage(); return 2; }
+
+  std::vector<TleSet> tles;
+  std::vector<const char*> l1, l2;
+  if(tlePath){
+    if(!loadTleFile(tlePath,tles) || tles.empty()){
+      fprintf(stderr,"no TLE sets in %s\n",tlePath); return 1;
+    }
+    for(const TleSet &t:tles){ l1.push_back(t.l1); l2.push_back(t.l2); }
+    cfg.tleL1=l1.data(); cfg.tleL2=l2.data(); cfg.tleCount=(int)tles.size();
+  }
+
+  FILE* f=outPath?fopen(outPath,"w"):stdout;
+  if(!f){ fprintf(stderr,"cannot write %s\n",outPath); return 1; }
+  if(verify){
+    int rc=runVerify(l1,l2,vecPath,f);
+    if(outPath) fclose(f);
+    return rc;
+  }
+  if(reference){
+    int rc=runReference(cfg,tles,qthPath,f);
+    if(outPath) fclose(f);
+    return rc;
+  }
+
+  static char json[8192];
+
+  if(precision){
+    PrecisionReport rep;
+    runPrecisionCheck(cfg,precSats,rep);
+    fprintf(stderr,"[PREC] %d sats, %lu samples: dir %.4f deg, range %.3f km; "
+            "passes %d/%d, %d unmatched, AOS %d s, LOS %d s, tMax %d s, maxEl %.3f deg; "
+            "batch (%s) %lu samples, %d errors, dir %.4f deg, range %.3f km; "
+            "track %lu samples, dir %.5f deg, range %.4f km, rate %.2f m/s -> %s\n",
+            rep.sats,(unsigned long)rep.samples,rep.maxDirErrDeg,rep.maxRangeErrKm,
+            rep.passesF32,rep.passesF64,rep.unmatched,rep.maxAosErrS,rep.maxLosErrS,
+            rep.maxTmaxErrS,rep.maxElErrDeg,sgp4BatchIsaName(sgp4BatchBestIsa()),
+            (unsigned long)rep.batchSamples,rep.batchErrors,rep.maxBatchDirErrDeg,
+            rep.maxBatchRangeErrKm,(unsigned long)rep.trackSamples,rep.maxTrackDirErrDeg,
+            rep.maxTrackRangeErrKm,rep.maxTrackRateErrKms*1000.0f,rep.ok?"OK":"FAIL");
+    precisionJson(json,sizeof(json),rep,nullptr);
+    fprintf(f,"%s\n",json);
+    if(outPath) fclose(f);
+    return rep.ok?0:1;
+  }
+
+  setJobWorkerCount(threads);
+  BenchResult res[BENCH_MAX_RESULTS];
+  int n=runBenchSuite(cfg,res,BENCH_MAX_RESULTS);
+
+  for(int i=0;i<n;i++){
+    const BenchResult &r=res[i];
+    fprintf(stderr,"[BENCH] %-16s %4d sats %7lu ops %9lu SGP4 %10.0f us %10.3f us/op\n",
+            r.name,r.sats,(unsigned long)r.ops,(unsigned long)r.sgp4Calls,r.us,
+            r.ops?r.us/r.ops:0.0);
+  }
+
+  benchJson(json,sizeof(json),res,n,nullptr);
+  fprintf(f,"%s\n",json);
+  if(outPath) fclose(f);
+  return 0;
+}
@@ -0,0 +1,240 @@
+// sat_predict_cli.cpp
+// Host pass predictor: same core as the firmware (lib/SatPredict), run over
+// a whole TLE file on all host cores.
+//
+//   pio run -e native
+//   .pio/build/native/program --tle amateur.txt --lat 49.7501 --lon 13.38
+//                             --alt 310 --minel 10 --hours 24 > passes.csv
+//
+// Output is the CSV of the device's /passes?csv=1 (sat column = TLE name),
+// quantized like the device's pass table, so both can be diffed directly.
+// --raw prints the unquantized search results instead. --optical lists only
+// the visible parts of the passes (sunlit satellite, dark QTH), one row per
+// window, like /passes?optical=1&csv=1. --look prints the satellites above
+// --minel at --start instead (az/el/range of the whole catalog through the
+// struct-of-arrays batch, sgp4_batch.h).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "sat_predict.h"
+#include "sgp4_batch.h"
+#include "job_queue.h"
+#include "tle_file.h"
+
+struct HostSat {
+  std::vector<PassInfo> passes;        // device: kvantované jako PassRec (mimo --raw)
+  std::vector<OpticalWindow> windows;  // --optical
+  std::vector<int> windowPass;         // index do passes
+  uint32_t calls;
+};
+
+struct HostRun {
+  std::vector<TleSet>  tles;
+  std::vector<HostSat> sats;
+  float  minElDeg;
+  double latDeg, lonDeg, altM;
+  bool   prefilter;
+  bool   raw;
+  bool   optical;
+  bool   look;
+  float  stdMag;
+  time_t startUtc, endUtc;
+};
+
+// one job = one satellite over the whole window
+static void runSatJob(void* ctx, int jobIdx){
+  HostRun &run=*(HostRun*)ctx;
+  const TleSet &tle=run.tles[jobIdx];
+  HostSat &hs=run.sats[jobIdx];
+
+  int chunks=(int)((run.endUtc-run.startUtc+PASS_LOOKBACK+PASS_JOB_CHUNK-1)/PASS_JOB_CHUNK);
+  std::vector<PassInfo> buf((size_t)(chunks+1)*PASS_JOB_MAX);
+
+  Sgp4Elements* sat=new Sgp4Elements;
+  if(!sgp4ElementsFromTle(*sat,tle.l1,tle.l2)){ delete sat; hs.passes.clear(); hs.calls=0; return; }
+  PassSearch ps;
+  initPassSearch(ps,*sat,tle.l1,tle.l2,(uint8_t)jobIdx,run.minElDeg,
+                 run.latDeg,run.lonDeg,run.altM,run.prefilter,run.startUtc);
+  ps.out=buf.data();
+  ps.outMax=(int)buf.size();
+  int n=searchSatWindow(ps,run.startUtc-PASS_LOOKBACK,run.endUtc);
+
+  const time_t base=run.startUtc-PASS_LOOKBACK;
+  hs.passes.clear();
+  for(int i=0;i<n;i++)
+    hs.passes.push_back(run.raw?buf[i]:decodePass(encodePass(buf[i],base),base));
+  hs.calls=ps.searchCalls+ps.refineEvals;
+
+  if(run.optical){
+    SunCache sun;
+    sunCacheReset(sun);
+    OpticalWindow w[OPT_WINDOWS_MAX];
+    for(int i=0;i<n;i++){
+      int k=opticalWindows(*sat,ps.site,sun,hs.passes[i],run.stdMag,w,OPT_WINDOWS_MAX,&hs.calls);
+      for(int j=0;j<k;j++){ hs.windows.push_back(w[j]); hs.windowPass.push_back(i); }
+    }
+  }
+  delete sat;
+}
+
+static void fmtUtc(time_t t, char* out, size_t len){
+  tm u; gmtime_r(&t,&u);
+  strftime(out,len,"%Y-%m-%dT%H:%M:%SZ",&u);
+}
+
+// --look: one time step for the whole catalog; deep-space orbits, which the
+// batch does not take, go through propagateSeries()
+static int runLook(const HostRun &run){
+  SiteFrame site;
+  initSiteFrame(site,run.latDeg,run.lonDeg,run.altM);
+  const int n=(int)run.tles.size();
+  Sgp4Batch b;
+  if(!sgp4BatchInit(b,n)){ fprintf(stderr,"out of memory\n"); return 1; }
+  std::vector<int> lane(n,-1);
+  std::vector<int> rest;
+  Sgp4Elements* e=new Sgp4Elements;
+  for(int si=0;si<n;si++){
+    if(!sgp4ElementsFromTle(*e,run.tles[si].l1,run.tles[si].l2)) continue;
+    lane[si]=sgp4BatchAdd(b,*e);
+    if(lane[si]<0) rest.push_back(si);
+  }
+
+  std::vector<float> az(n), el(n), rng(n);
+  std::vector<uint8_t> err(n);
+  auto t0=std::chrono::steady_clock::now();
+  sgp4BatchLook<double>(b,site,(double)run.startUtc,az.data(),el.data(),rng.data(),err.data());
+  struct Row { int sat; float az, el, rng; };
+  std::vector<Row> rows;
+  for(int si=0;si<n;si++){
+    int k=lane[si];
+    if(k>=0 && !err[k] && el[k]>=run.minElDeg) rows.push_back({si,az[k],el[k],rng[k]});
+  }
+  for(int si:rest){
+    Row r={si,0,0,0};
+    if(!sgp4ElementsFromTle(*e,run.tles[si].l1,run.tles[si].l2)) continue;
+    if(propagateSeries<double>(*e,site,(double)run.startUtc,0.0,1,&r.az,&r.el,&r.rng)==1 &&
+       r.el>=run.minElDeg) rows.push_back(r);
+  }
+  double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+  delete e;
+  std::stable_sort(rows.begin(),rows.end(),[](const Row &a,const Row &b){ return a.el>b.el; });
+
+  printf("sat,az,el,range_km\n");
+  for(const Row &r:rows)
+    printf("%s,%.1f,%.1f,%.0f\n",run.tles[r.sat].name.c_str(),r.az,r.el,r.rng);
+  fprintf(stderr,"[LOOK] %d sats (%d batched, %s), %d above %.0f deg, %.2f ms\n",n,b.count,
+          sgp4BatchIsaName(b.isa),(int)rows.size(),run.minElDeg,ms);
+  sgp4BatchFree(b);
+  return 0;
+}
+
+static void usage(){
+  fprintf(stderr,
+    "usage: program --tle FILE --lat DEG --lon DEG [--alt M] [--minel DEG]\n"
+    "               [--start UNIX] [--hours H] [--threads N] [--no-prefilter] [--raw]\n"
+    "               [--optical [--stdmag MAG]] [--look]\n"
+    "  defaults: alt 0, minel 10, start now, hours 24, threads = all cores, stdmag 4\n");
+}
+
+int main(int argc, char** argv){
+  const char* tlePath=nullptr;
+  HostRun run;
+  run.minElDeg=10.0f;
+  run.latDeg=1000; run.lonDeg=1000; run.altM=0;
+  run.prefilter=true;
+  run.raw=false;
+  run.optical=false;
+  run.look=false;
+  run.stdMag=OPT_STD_MAG;
+  run.startUtc=time(nullptr);
+  int hours=24, threads=0;
+
+  for(int i=1;i<argc;i++){
+    const char* a=argv[i];
+    bool hasVal=i+1<argc;
+    if(!strcmp(a,"--tle") && hasVal) tlePath=argv[++i];
+    else if(!strcmp(a,"--lat") && hasVal) run.latDeg=atof(argv[++i]);
+    else if(!strcmp(a,"--lon") && hasVal) run.lonDeg=atof(argv[++i]);
+    else if(!strcmp(a,"--alt") && hasVal) run.altM=atof(argv[++i]);
+    else if(!strcmp(a,"--minel") && hasVal) run.minElDeg=(float)atof(argv[++i]);
+    else if(!strcmp(a,"--start") && hasVal) run.startUtc=(time_t)atoll(argv[++i]);
+    else if(!strcmp(a,"--hours") && hasVal) hours=atoi(argv[++i]);
+    else if(!strcmp(a,"--threads") && hasVal) threads=atoi(argv[++i]);
+    else if(!strcmp(a,"--no-prefilter")) run.prefilter=false;
+    else if(!strcmp(a,"--raw")) run.raw=true;
+    else if(!strcmp(a,"--optical")) run.optical=true;
+    else if(!strcmp(a,"--look")) run.look=true;
+    else if(!strcmp(a,"--stdmag") && hasVal) run.stdMag=(float)atof(argv[++i]);
+    else { usage(); return 2; }
+  }
+  if(!tlePath || run.latDeg<-90 || run.latDeg>90 || run.lonDeg<-180 || run.lonDeg>180 || hours<=0){
+    usage(); return 2;
+  }
+  // stejné meze jako firmware
+  if(run.minElDeg<0) run.minElDeg=0;
+  if(run.minElDeg>90) run.minElDeg=90;
+
+  if(!loadTleFile(tlePath,run.tles)){ fprintf(stderr,"cannot read %s\n",tlePath); return 1; }
+  if(run.tles.empty()){ fprintf(stderr,"no TLE sets in %s\n",tlePath); return 1; }
+  if(run.look) return runLook(run);
+  run.sats.assign(run.tles.size(),HostSat{{},{},{},0});
+  run.endUtc=run.startUtc+(time_t)hours*3600;
+
+  setJobWorkerCount(threads);
+  auto t0=std::chrono::steady_clock::now();
+  runJobs(runSatJob,&run,(int)run.sats.size());
+  double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+
+  struct Row { time_t aos; int sat; PassInfo p; int win; };
+  std::vector<Row> rows;
+  uint64_t calls=0;
+  for(int si=0;si<(int)run.sats.size();si++){
+    const HostSat &hs=run.sats[si];
+    calls+=hs.calls;
+    if(run.optical){
+      for(int k=0;k<(int)hs.windows.size();k++){
+        const PassInfo &p=hs.passes[hs.windowPass[k]];
+        rows.push_back({p.aos,si,p,k});
+      }
+    } else {
+      for(const PassInfo &p:hs.passes) rows.push_back({p.aos,si,p,-1});
+    }
+  }
+  std::stable_sort(rows.begin(),rows.end(),[](const Row &a,const Row &b){ return a.aos<b.aos; });
+
+  if(run.optical)
+    printf("sat,aos_utc,los_utc,vis_start_utc,vis_end_utc,vis_peak_utc,peak_el,peak_mag,class\n");
+  else
+    printf("sat,aos_utc,los_utc,tmax_utc,max_el,aos_az,max_az,los_az\n");
+  for(const Row &r:rows){
+    char sa[24],sl[24],sm[24];
+    fmtUtc(r.p.aos,sa,sizeof(sa));
+    fmtUtc(r.p.los,sl,sizeof(sl));
+    if(run.optical){
+      const OpticalWindow &w=run.sats[r.sat].windows[r.win];
+      char vs[24],ve[24],vp[24];
+      fmtUtc(w.start,vs,sizeof(vs));
+      fmtUtc(w.end,ve,sizeof(ve));
+      fmtUtc(w.peak,vp,sizeof(vp));
+      printf("%s,%s,%s,%s,%s,%s,%.1f,%.1f,%s\n",run.tles[r.sat].name.c_str(),sa,sl,vs,ve,vp,
+             w.peakEl,w.peakMag,opticalClassName(w.cls));
+      continue;
+    }
+    fmtUtc(r.p.tMax,sm,sizeof(sm));
+    if(run.raw)
+      printf("%s,%s,%s,%s,%.3f,%.3f,%.3f,%.3f\n",run.tles[r.sat].name.c_str(),sa,sl,sm,
+             r.p.maxEl,r.p.aosAz,r.p.maxAz,r.p.losAz);
+    else
+      printf("%s,%s,%s,%s,%.1f,%.0f,%.0f,%.0f\n",run.tles[r.sat].name.c_str(),sa,sl,sm,
+             r.p.maxEl,r.p.aosAz,r.p.maxAz,r.p.losAz);
+  }
+
+  fprintf(stderr,"[PRED] %d sats, %d %s in %d h, %llu SGP4 calls, %.0f ms on %d threads\n",
+          (int)run.sats.size(),(int)rows.size(),run.optical?"optical windows":"passes",hours,(unsigned long long)calls,ms,jobWorkerCount());
+  return 0;
+}
@@ -8,8 +8,9 @@
 //  - Configurable timezone (POSIX TZ strings via <select>)
 //  - RX/TX frequencies for satellites + Doppler shift
 //  - Cached pass track on radar
+//  - 10 Hz interpolated tracking (radar dot, Doppler, serial "track on")
 //  - add/delete custom satellites via web + save to SPIFFS
-//  - max 4 enabled satellites for pass prediction
+//  - up to 128 enabled satellites for pass prediction (132 total incl. custom)
 //  - Maidenhead locator from GPS/QTH + show on passes screen only
 //  - raw GPS string on web auto-updated without reload
 //  - LIVE update of Lat/Lon/Alt in web without refresh
@@ -26,11 +27,16 @@
 #include <time.h>
 #include <sys/time.h>
 #include <Sgp4.h>
+#include <new>
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <WebServer.h>
 #include <TinyGPSPlus.h>
 #include "logo.h"
+#include "job_queue.h"
+#include "sat_predict.h"
+#include "sat_track.h"
+#include "sat_bench.h"
 
 // ====================== WIFI ======================
 const char* WIFI_SSID = "Vxxxx";
@@ -104,9 +110,9 @@ bool   g_isAPMode = false;
 WebServer server(80);
 
 // ====================== SAT LIMITS ======================
-static const uint8_t MAX_SATS_SELECTED = 4;  // max vybraných pro výpočet
-static const uint8_t BUILTIN_COUNT     = 4;  // pevně v kódu
-static const uint8_t MAX_SATS_TOTAL    = 12; // kapacita builtin + custom
+static const uint8_t MAX_SATS_SELECTED = 128; // max vybraných pro výpočet
+static const uint8_t BUILTIN_COUNT     = 4;   // pevně v kódu
+static const uint8_t MAX_SATS_TOTAL    = 132; // kapacita builtin + custom
 
 const char* PATH_SATS = "/sats.txt";
 
@@ -118,8 +124,7 @@ struct SatConfig {
   const char* tleUrl;
 
   char  name[32];
-  char  l1[80];
-  char  l2[80];
+  TleRecord tle;   // předparsovaná TLE, řádky se z ní skládají jen pro init elementů
 
   float rxFreqMHz;
   float txFreqMHz;
@@ -133,21 +138,21 @@ SatConfig g_sats[MAX_SATS_TOTAL] = {
   {
     "ISS","ISS","ISS (ZARYA)",
     "https://celestrak.org/NORAD/elements/gp.php?CATNR=25544&FORMAT=tle",
-    "", "", "",
+    "", {},
     437.800f, 145.800f, true,
     false
   },
   {
     "SO50","SO50","SO-50",
     "https://celestrak.org/NORAD/elements/gp.php?NAME=SO-50&FORMAT=tle",
-    "", "", "",
+    "", {},
     436.795f,145.850f,false,
     false
   },
   {
     "FO29","FO29","FO-29",
     "https://celestrak.org/NORAD/elements/gp.php?NAME=FO-29&FORMAT=tle",
-    "", "", "",
+    "", {},
     435.850f,145.900f,false,
     false
   },
@@ -155,7 +160,7 @@ SatConfig g_sats[MAX_SATS_TOTAL] = {
   {
     "UMKA1","UmKA-1","UmKA-1 (RS40S)",
     "https://celestrak.org/NORAD/elements/gp.php?CATNR=57172&FORMAT=tle",
-    "", "", "",
+    "", {},
     437.625f,145.850f,false,  // RX downlink / TX uplink
     false
   }
@@ -163,36 +168,89 @@ SatConfig g_sats[MAX_SATS_TOTAL] = {
 };
 
 int  SAT_COUNT = BUILTIN_COUNT;
-Sgp4 g_sgp4[MAX_SATS_TOTAL];
 
-// buffers pro custom satelity (aby const char* ukazovaly do stabilní paměti)
-char g_customIdBuf[MAX_SATS_TOTAL][8];
-char g_customShortBuf[MAX_SATS_TOTAL][16];
-char g_customDefBuf[MAX_SATS_TOTAL][32];
-char g_customUrlBuf[MAX_SATS_TOTAL][96];
+// SGP4 elementy (~1 kB/kus) jen pro naposledy použité satelity, viz
+// satPropagator(); sdílí je i joby průletů (jen ke čtení)
+const int SGP4_POOL_SIZE = 6;
+struct Sgp4Slot {
+  Sgp4Elements sat;
+  bool     ok;        // init z TLE prošel
+  bool     used;
+  uint8_t  satIdx;
+  uint32_t lastUse;
+};
+Sgp4Slot g_sgp4Pool[SGP4_POOL_SIZE];
+uint32_t g_sgp4PoolTick   = 0;
+uint32_t g_sgp4PoolHits   = 0;
+uint32_t g_sgp4PoolMisses = 0;
+SiteFrame g_qthFrame;   // ECEF + SEZ rotace QTH (živá poloha, stopy průletů), viz updateSatSites()
+SunCache  g_sunCache = {-1,{0,0,0}};   // vektor Slunce po minutách, společný pro všechny satelity
+
+// texty custom satelitů (const char* v SatConfig ukazují sem); na heapu jen
+// pro obsazené sloty, 152 B/satelit místo 20 kB statického pole
+struct CustomText {
+  char id[8];
+  char shortName[16];
+  char defaultName[32];
+  char tleUrl[96];
+};
+CustomText* g_customText[MAX_SATS_TOTAL];   // nullptr = slot bez textů
+
+// Points the strings of custom slot idx to its heap texts (allocated on
+// first use, kept while the slot is used). False when out of memory.
+bool setCustomText(int idx, const String &id, const String &shortName,
+                   const String &defaultName, const String &tleUrl){
+  if(!g_customText[idx]) g_customText[idx]=(CustomText*)calloc(1,sizeof(CustomText));
+  CustomText* t=g_customText[idx];
+  if(!t) return false;
+  id.toCharArray(t->id,sizeof(t->id));
+  shortName.toCharArray(t->shortName,sizeof(t->shortName));
+  defaultName.toCharArray(t->defaultName,sizeof(t->defaultName));
+  tleUrl.toCharArray(t->tleUrl,sizeof(t->tleUrl));
+  SatConfig &s=g_sats[idx];
+  s.id=t->id;
+  s.shortName=t->shortName;
+  s.defaultName=t->defaultName;
+  s.tleUrl=t->tleUrl;
+  return true;
+}
+
+// slots from..MAX_SATS_TOTAL-1 are no longer used
+void freeCustomText(int from){
+  for(int i=from;i<MAX_SATS_TOTAL;i++){ free(g_customText[i]); g_customText[i]=nullptr; }
+}
+
+// Limit výběru: počítají se všechny zapnuté satelity, s TLE i bez, stejně
+// jako počítadlo a varování ve web UI (zaškrtnuté boxy)
+int enabledSatCount(){
+  int en=0;
+  for(int i=0;i<SAT_COUNT;i++) if(g_sats[i].enabled) en++;
+  return en;
+}
+
+// keeps the first MAX_SATS_SELECTED enabled satellites
+void enforceSatCap(){
+  int en=0;
+  for(int i=0;i<SAT_COUNT;i++){
+    if(g_sats[i].enabled){
+      en++;
+      if(en>MAX_SATS_SELECTED) g_sats[i].enabled=false;
+    }
+  }
+}
 
 // ====================== PASS / TRAIL ======================
-struct SatState {
-  float az;
-  float el;
-  float distKm;
-  int   vis;
-};
+const int MAX_PASSES = 1024;  // 7 dní pro ~20 satelitů, 13 kB
+PassRec g_passes[MAX_PASSES];
+int     g_passCount = 0;
+time_t  g_passBase  = 0;
 
-struct PassInfo {
-  time_t  aos;
-  time_t  los;
-  time_t  tMax;
-  float   maxEl;
-  float   aosAz;
-  float   maxAz;
-  float   losAz;
-  uint8_t satIdx;
-};
+// délka predikce dopředu (h), config.txt / web
+const uint16_t PASS_WINDOW_MAX_H = 7*24;
+uint16_t g_passWindowH = 24;
 
-const int MAX_PASSES = 32;
-PassInfo g_passes[MAX_PASSES];
-int g_passCount = 0;
+// do kdy (UTC) jsou průlety daného satelitu v g_passes kompletní
+time_t g_satHorizon[MAX_SATS_TOTAL];
 
 int g_lastPassListMinute = -1;
 
@@ -202,8 +260,9 @@ TrailPoint g_trail[TRAIL_LEN];
 int g_trailCount   = 0;
 int g_trailPassIdx = -1;
 
-float g_prevDistKm[MAX_SATS_TOTAL];
-bool  g_prevDistValid[MAX_SATS_TOTAL];
+// sledovaný satelit, pro který jsou kotvy v g_track (viz trackSatellite());
+// -1 = inicializovat znovu
+int g_trackSat = -1;
 
 // ====================== DISPLAY MODE ======================
 enum DisplayMode { MODE_LIST, MODE_TRACKER };
@@ -242,9 +301,11 @@ bool saveTleToFs(const SatConfig &sc, time_t nowUtc) {
   File f = SPIFFS.open(tlePathForSat(sc), FILE_WRITE);
   if (!f) return false;
   f.printf("%ld\n",(long)nowUtc);
+  char l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  tleRecordLines(sc.tle,l1,l2);
   f.println(sc.name);
-  f.println(sc.l1);
-  f.println(sc.l2);
+  f.println(l1);
+  f.println(l2);
   f.close();
   return true;
 }
@@ -264,10 +325,8 @@ bool loadTleFromFs(SatConfig &sc, time_t nowUtc) {
     String l1   = f.readStringUntil('\n'); l1.trim();
     String l2   = f.readStringUntil('\n'); l2.trim();
     f.close();
-    if (l1.length()<10 || l2.length()<10) return false;
+    if (!tleRecordFromLines(sc.tle,l1.c_str(),l2.c_str())) return false;
     name.toCharArray(sc.name,sizeof(sc.name));
-    l1.toCharArray(sc.l1,sizeof(sc.l1));
-    l2.toCharArray(sc.l2,sizeof(sc.l2));
     return true;
   }
 
@@ -280,11 +339,9 @@ bool loadTleFromFs(SatConfig &sc, time_t nowUtc) {
   String l2   = f.readStringUntil('\n'); l2.trim();
   f.close();
 
-  if (l1.length()<10 || l2.length()<10) return false;
+  if (!tleRecordFromLines(sc.tle,l1.c_str(),l2.c_str())) return false;
 
   name.toCharArray(sc.name,sizeof(sc.name));
-  l1.toCharArray(sc.l1,sizeof(sc.l1));
-  l2.toCharArray(sc.l2,sizeof(sc.l2));
   return true;
 }
 
@@ -310,7 +367,7 @@ void saveCustomSats(){
 void loadCustomSats(){
   File f = SPIFFS.open(PATH_SATS, FILE_READ);
   SAT_COUNT = BUILTIN_COUNT;
-  if(!f) return;
+  if(!f){ freeCustomText(SAT_COUNT); return; }
 
   while(f.available() && SAT_COUNT < MAX_SATS_TOTAL){
     String line = f.readStringUntil('\n'); line.trim();
@@ -329,18 +386,13 @@ void loadCustomSats(){
     SatConfig &s = g_sats[SAT_COUNT];
     memset(&s,0,sizeof(SatConfig));
 
-    parts[0].toCharArray(g_customIdBuf[SAT_COUNT], sizeof(g_customIdBuf[SAT_COUNT]));
-    parts[1].toCharArray(g_customShortBuf[SAT_COUNT], sizeof(g_customShortBuf[SAT_COUNT]));
-    parts[2].toCharArray(g_customDefBuf[SAT_COUNT], sizeof(g_customDefBuf[SAT_COUNT]));
-    parts[3].toCharArray(g_customUrlBuf[SAT_COUNT], sizeof(g_customUrlBuf[SAT_COUNT]));
-
-    s.id = g_customIdBuf[SAT_COUNT];
-    s.shortName = g_customShortBuf[SAT_COUNT];
-    s.defaultName = g_customDefBuf[SAT_COUNT];
-    s.tleUrl = g_customUrlBuf[SAT_COUNT];
+    if(!setCustomText(SAT_COUNT,parts[0],parts[1],parts[2],parts[3])){
+      Serial.println("[SATS] out of memory, custom satellites truncated");
+      break;
+    }
 
     strncpy(s.name, s.defaultName, sizeof(s.name));
-    s.l1[0]='\0'; s.l2[0]='\0';
+    s.tle.valid=false;
     s.rxFreqMHz = parts[4].toFloat();
     s.txFreqMHz = parts[5].toFloat();
     s.enabled   = (p>=7) ? (parts[6].toInt()!=0) : false;
@@ -349,15 +401,10 @@ void loadCustomSats(){
     SAT_COUNT++;
   }
   f.close();
+  freeCustomText(SAT_COUNT);
 
-  // enforce max 4 enabled
-  int en=0;
-  for(int i=0;i<SAT_COUNT;i++){
-    if(g_sats[i].enabled){
-      en++;
-      if(en>MAX_SATS_SELECTED) g_sats[i].enabled=false;
-    }
-  }
+  // enforce max MAX_SATS_SELECTED enabled
+  enforceSatCap();
 }
 
 // ===== CONFIG LOAD / SAVE =====
@@ -374,9 +421,10 @@ void loadConfig() {
   if (line1.length()>0) {
     double lat, lon, alt; float minEl;
     int doppler=0,gpsEn=0,gpsOnly=0; int rx=g_gpsRxPin, tx=g_gpsTxPin; long baud=g_gpsBaud;
+    int windowH=g_passWindowH;
 
-    int n = sscanf(line1.c_str(), "%lf %lf %lf %f %d %d %d %d %d %ld",
-                   &lat,&lon,&alt,&minEl,&doppler,&gpsEn,&gpsOnly,&rx,&tx,&baud);
+    int n = sscanf(line1.c_str(), "%lf %lf %lf %f %d %d %d %d %d %ld %d",
+                   &lat,&lon,&alt,&minEl,&doppler,&gpsEn,&gpsOnly,&rx,&tx,&baud,&windowH);
 
     if (n>=3) {
       g_qthLat=lat; g_qthLon=lon; g_qthAlt=alt;
@@ -386,6 +434,7 @@ void loadConfig() {
       if(n>=7) g_gpsOnlyMode=(gpsOnly!=0);
       if(n>=9){ g_gpsRxPin=rx; g_gpsTxPin=tx; }
       if(n>=10){ g_gpsBaud = (baud>0)?(uint32_t)baud:9600; }
+      if(n>=11) g_passWindowH=(uint16_t)constrain(windowH,1,(int)PASS_WINDOW_MAX_H);
     }
   }
 
@@ -429,25 +478,20 @@ void loadConfig() {
     start=sp+1;
   }
 
-  int en=0;
-  for(int i=0;i<SAT_COUNT;i++){
-    if(g_sats[i].enabled){
-      en++;
-      if(en>MAX_SATS_SELECTED) g_sats[i].enabled=false;
-    }
-  }
+  enforceSatCap();
 }
 
 void saveConfig() {
   File f = SPIFFS.open(PATH_CONFIG, FILE_WRITE);
   if(!f) return;
 
-  f.printf("%.6f %.6f %.3f %.1f %d %d %d %d %d %lu\n",
+  f.printf("%.6f %.6f %.3f %.1f %d %d %d %d %d %lu %u\n",
            g_qthLat,g_qthLon,g_qthAlt,g_minElDeg,
            g_dopplerEnabled?1:0,
            g_gpsEnabled?1:0,
            g_gpsOnlyMode?1:0,
-           g_gpsRxPin,g_gpsTxPin,(unsigned long)g_gpsBaud);
+           g_gpsRxPin,g_gpsTxPin,(unsigned long)g_gpsBaud,
+           (unsigned)g_passWindowH);
 
   for(int i=0;i<SAT_COUNT;i++) if(g_sats[i].enabled){ f.print(g_sats[i].id); f.print(" "); }
   f.print("\n");
@@ -582,10 +626,9 @@ bool downloadTleForSat(SatConfig &sc, time_t nowUtc){
     idx=nl+1;
   }
   if(lineNo<3) return false;
+  if(!tleRecordFromLines(sc.tle,l1.c_str(),l2.c_str())) return false;
 
   name.toCharArray(sc.name,sizeof(sc.name));
-  l1.toCharArray(sc.l1,sizeof(sc.l1));
-  l2.toCharArray(sc.l2,sizeof(sc.l2));
   saveTleToFs(sc,nowUtc);
   return true;
 }
@@ -598,116 +641,1257 @@ bool ensureTleForSat(SatConfig &sc, time_t nowUtc){
   return false;
 }
 
+void updateSatSites(){
+  // elementy z aktuální TLE se spočítají při příští inicializaci slotu
+  for(Sgp4Slot &sl:g_sgp4Pool) sl.used=false;
+  initSiteFrame(g_qthFrame,g_qthLat,g_qthLon,g_qthAlt);
+  g_trackSat=-1;   // kotvy sledování jsou k QTH
+}
+
 void initSatConfigs(){
   for(int i=0;i<SAT_COUNT;i++){
     if(!g_sats[i].isCustom){
       strncpy(g_sats[i].name,g_sats[i].defaultName,sizeof(g_sats[i].name));
     }
-    g_sats[i].l1[0]='\0'; g_sats[i].l2[0]='\0';
+    g_sats[i].tle.valid=false;
   }
 
   // fallback TLE pro ISS
   strncpy(g_sats[0].name,"ISS (ZARYA)",sizeof(g_sats[0].name));
-  strncpy(g_sats[0].l1,"1 25544U 98067A   25321.51385417  .00013833  00000-0  24663-3 0  9999",sizeof(g_sats[0].l1));
-  strncpy(g_sats[0].l2,"2 25544  51.6416 307.6127 0004374 279.5544  80.5053 15.50090446 99999",sizeof(g_sats[0].l2));
+  tleRecordFromLines(g_sats[0].tle,
+                     "1 25544U 98067A   25321.51385417  .00013833  00000-0  24663-3 0  9999",
+                     "2 25544  51.6416 307.6127 0004374 279.5544  80.5053 15.50090446 99999");
 
   time_t nowUtc=time(nullptr);
   for(int i=0;i<SAT_COUNT;i++){
     if(!ensureTleForSat(g_sats[i],nowUtc)){
-      if(i!=0){ g_sats[i].enabled=false; g_sats[i].l1[0]='\0'; g_sats[i].l2[0]='\0'; }
+      if(i!=0){ g_sats[i].enabled=false; g_sats[i].tle.valid=false; }
     }
   }
+  enforceSatCap();   // nově platné TLE: stejný limit jako web a config
 
-  for(int i=0;i<SAT_COUNT;i++){
-    g_sgp4[i].site(g_qthLat,g_qthLon,g_qthAlt);
-    if(strlen(g_sats[i].l1)>10 && strlen(g_sats[i].l2)>10)
-      g_sgp4[i].init(g_sats[i].name,g_sats[i].l1,g_sats[i].l2);
-    else if(i==0)
-      g_sgp4[0].init(g_sats[0].name,g_sats[0].l1,g_sats[0].l2);
-    g_prevDistKm[i]=0; g_prevDistValid[i]=false;
+  updateSatSites();
+}
+
+// ====================== SAT / PASSES ======================
+// počítadlo volání SGP4 (pro porovnání rychlosti výpočtu průletů)
+uint32_t g_propCalls = 0;
+bool     g_passPrefilter = true;   // "prefilter off" = plné hledání pro srovnání
+
+// Initialized SGP4 elements of a satellite from the LRU pool, or nullptr
+// when its TLE does not initialize: a hit costs a scan of SGP4_POOL_SIZE
+// slots, a miss re-initializes the least recently used slot from the
+// satellite's TleRecord (sgp4init in-tree). Memory stays at the pool size
+// however many satellites are configured. Only loop() touches the pool; a
+// caller that keeps the pointer across other calls fetches it again, since
+// the slot may have been reused meanwhile.
+const Sgp4Elements* satPropagator(int satIdx){
+  g_sgp4PoolTick++;
+  int lru=0;
+  for(int k=0;k<SGP4_POOL_SIZE;k++){
+    Sgp4Slot &sl=g_sgp4Pool[k];
+    if(sl.used && sl.satIdx==satIdx){
+      sl.lastUse=g_sgp4PoolTick;
+      g_sgp4PoolHits++;
+      return sl.ok?&sl.sat:nullptr;
+    }
+    if(!g_sgp4Pool[lru].used) continue;
+    if(!sl.used || sl.lastUse<g_sgp4Pool[lru].lastUse) lru=k;
   }
+
+  Sgp4Slot &sl=g_sgp4Pool[lru];
+  sl.ok=initElements(sl.sat,g_sats[satIdx].tle);
+  sl.used=true;
+  sl.satIdx=(uint8_t)satIdx;
+  sl.lastUse=g_sgp4PoolTick;
+  g_sgp4PoolMisses++;
+  return sl.ok?&sl.sat:nullptr;
 }
 
-void updateSatSites(){
-  for(int i=0;i<SAT_COUNT;i++) g_sgp4[i].site(g_qthLat,g_qthLon,g_qthAlt);
+// ---- Chebyshev ephemeris ----
+// The satellites of the next passes (and the GEO marks) get a Chebyshev fit
+// of their position from PASS_LOOKBACK back to EPHEM_SPAN_S ahead, see
+// ephemStep(). Live position, illumination, pass trails and the optical
+// windows then evaluate polynomials instead of SGP4; outside a fitted window
+// they fall back to the SGP4 pool. The pass search and the profiles stay on
+// SGP4 (from the ephemeris the search was slower, see --reference). The fit does not depend on the QTH or minEl,
+// so it stays valid across their changes, until the TLE set changes.
+const int      EPHEM_SLOTS    = 8;
+const int      EPHEM_SEGS     = 24;        // LEO den ~16 segmentů, Molniya ~11, GEO 5
+const time_t   EPHEM_SPAN_S   = 24*3600;
+const time_t   EPHEM_REFIT_S  = 6*3600;    // přefitovat, když zbývá méně
+const uint32_t EPHEM_SLICE_MS = 20;
+
+struct EphemSlot {
+  ChebEphem e;
+  ChebSeg*  seg;          // [EPHEM_SEGS], alokuje se při prvním fitu
+  uint8_t   satIdx;
+  char      satnum[5];    // TLE sada, ze které je fit
+  uint16_t  tleDay;
+  uint32_t  tleFrac;
+  bool      ready;
+};
+EphemSlot g_ephem[EPHEM_SLOTS];
+int       g_ephemFitting  = -1;   // slot rozpracovaného fitu
+time_t    g_ephemFitEnd   = 0;
+uint32_t  g_ephemFitMs    = 0;
+uint32_t  g_ephemCheckMs  = 0;
+uint32_t  g_ephemEvals    = 0;    // živá poloha, stopy
+uint32_t  g_ephemFitCalls = 0;
+uint32_t  g_ephemFits     = 0;
+
+bool ephemSameTle(const EphemSlot &sl, const TleRecord &t){
+  return t.valid && memcmp(sl.satnum,t.satnum,sizeof(sl.satnum))==0 &&
+         sl.tleDay==t.epochDay && sl.tleFrac==t.epochFrac;
 }
 
-// ====================== SAT / PASSES ======================
+// fitted ephemeris of the satellite's current TLE, or nullptr
+const ChebEphem* satEphem(int satIdx){
+  for(const EphemSlot &sl:g_ephem)
+    if(sl.ready && sl.satIdx==satIdx && ephemSameTle(sl,g_sats[satIdx].tle)) return &sl.e;
+  return nullptr;
+}
+
+// Az/el/range only; the illumination (sun position, shadow) is left for
+// satStateVis(), so callers that need just the geometry don't pay for it.
 SatState computeSatellite(int satIdx, time_t utcNow){
   SatState s{};
+  s.vis=SAT_VIS_UNKNOWN;
   if(satIdx<0||satIdx>=SAT_COUNT) return s;
-  g_sgp4[satIdx].findsat((unsigned long)utcNow);
-  s.az=(float)g_sgp4[satIdx].satAz;
-  s.el=(float)g_sgp4[satIdx].satEl;
-  s.distKm=(float)g_sgp4[satIdx].satDist;
-  s.vis=(int)g_sgp4[satIdx].satVis;
+  const ChebEphem* e=satEphem(satIdx);
+  if(e && ephemSeries<double>(*e,g_qthFrame,(double)utcNow,0.0,1,&s.az,&s.el,&s.distKm)==1){
+    g_ephemEvals++;
+    return s;
+  }
+  const Sgp4Elements* sat=satPropagator(satIdx);
+  if(!sat || propagateSeries<double>(*sat,g_qthFrame,(double)utcNow,0.0,1,&s.az,&s.el,&s.distKm)!=1)
+    s.el=-90.0f;
+  g_propCalls++;
   return s;
 }
 
-void sortPassesByAos(){
-  for(int i=0;i<g_passCount-1;i++)
-    for(int j=i+1;j<g_passCount;j++)
-      if(g_passes[j].aos<g_passes[i].aos){
-        PassInfo tmp=g_passes[i]; g_passes[i]=g_passes[j]; g_passes[j]=tmp;
+// s.vis on demand (SAT_VIS_*), from the shared per-minute sun vector
+int satStateVis(int satIdx, time_t utcNow, SatState &s){
+  if(s.vis==SAT_VIS_UNKNOWN && satIdx>=0 && satIdx<SAT_COUNT){
+    const ChebEphem* e=satEphem(satIdx);
+    if(e && chebCovers(*e,(double)utcNow)){
+      s.vis=satVisibility(*e,g_qthFrame,g_sunCache,(double)utcNow,s.el);
+      if(s.el>=0.0f) g_ephemEvals++;
+    } else if(const Sgp4Elements* sat=satPropagator(satIdx)){
+      s.vis=satVisibility(*sat,g_qthFrame,g_sunCache,(double)utcNow,s.el);
+      if(s.el>=0.0f) g_propCalls++;
+    }
+  }
+  return s.vis;
+}
+
+// ---- high-rate tracking ----
+// The satellite of the running pass is sampled every TRACK_RATE_MS with the
+// sub-second time of gettimeofday(): SGP4 only at anchors TRACK_ANCHOR_S
+// apart, Hermite interpolation between (sat_track.h). The radar dot moves
+// at that rate, the once-per-second screen and the Doppler use the same
+// samples, and the range rate comes from the velocity instead of the
+// difference of two whole-second ranges. "track on" streams the samples on
+// serial (for a rotator).
+const uint32_t TRACK_RATE_MS = 100;   // 10 Hz
+
+Sgp4Elements g_trackEl;        // jen sledovaný satelit
+TrackInterp  g_track;
+char         g_trackSatnum[5];
+uint16_t     g_trackTleDay  = 0;
+uint32_t     g_trackTleFrac = 0;
+uint32_t     g_trackSamples = 0;
+bool         g_trackLog     = false;
+
+double utcNowPrecise(){
+  timeval tv;
+  gettimeofday(&tv,nullptr);
+  return (double)tv.tv_sec+tv.tv_usec*1e-6;
+}
+
+// Interpolated look of satellite satIdx at utc; the anchors restart when
+// the satellite or its TLE changes (or the QTH, see updateSatSites()).
+bool trackSatellite(int satIdx, double utc, TrackLook &out){
+  const TleRecord &t=g_sats[satIdx].tle;
+  if(satIdx!=g_trackSat || memcmp(g_trackSatnum,t.satnum,sizeof(g_trackSatnum))!=0 ||
+     g_trackTleDay!=t.epochDay || g_trackTleFrac!=t.epochFrac){
+    g_trackSat=-1;
+    const Sgp4Elements* sat=t.valid?satPropagator(satIdx):nullptr;
+    if(!sat) return false;
+    g_trackEl=*sat;
+    trackBegin(g_track,g_trackEl,g_qthFrame);
+    memcpy(g_trackSatnum,t.satnum,sizeof(g_trackSatnum));
+    g_trackTleDay=t.epochDay;
+    g_trackTleFrac=t.epochFrac;
+    g_trackSat=satIdx;
+  }
+  g_trackSamples++;
+  return trackAt(g_track,utc,out);
+}
+
+// ---- GEO static pointing ----
+// A GEO satellite above minEl has no passes (the search skips it, see
+// orbitRegime), only a constant pointing. It is refreshed once a minute,
+// drawn on the radar while tracking and listed under the passes.
+const int GEO_MARKS_MAX = 8;
+struct GeoMark { uint8_t satIdx; float az, el; };
+GeoMark g_geoMarks[GEO_MARKS_MAX];
+int     g_geoMarkCount  = 0;
+int     g_geoMarkMinute = -1;
+
+void updateGeoMarks(time_t nowUtc){
+  g_geoMarkCount=0;
+  for(int si=0;si<SAT_COUNT && g_geoMarkCount<GEO_MARKS_MAX;si++){
+    if(!g_sats[si].enabled || orbitRegime(g_sats[si].tle)!=ORBIT_GEO) continue;
+    SatState s=computeSatellite(si,nowUtc);
+    if(s.el<=g_minElDeg) continue;
+    g_geoMarks[g_geoMarkCount++]={(uint8_t)si,s.az,s.el};
+  }
+}
+
+// ---- pass store ----
+// g_passes is kept sorted by AOS and holds the MAX_PASSES earliest passes
+// of all satellites. A pass earlier than the last one evicts it; the
+// evicted satellite's horizon moves back to that pass, so it is found again
+// once there is room.
+PassInfo passAt(int i){ return decodePass(g_passes[i],g_passBase); }
+time_t passAos(int i){ return g_passBase+(time_t)g_passes[i].aosOff; }
+time_t passLos(int i){ return passAos(i)+g_passes[i].dur; }
+
+int passInsertPos(uint32_t aosOff){
+  int lo=0, hi=g_passCount;
+  while(lo<hi){
+    int mid=(lo+hi)/2;
+    if(g_passes[mid].aosOff<=aosOff) lo=mid+1; else hi=mid;
+  }
+  return lo;
+}
+
+// false = store full and the pass is not earlier than any stored one
+// (passes before g_passBase are not stored either)
+bool storePass(const PassInfo &p, PassInfo *evicted=nullptr){
+  if(p.aos<g_passBase) return false;
+  if(g_passCount>=MAX_PASSES){
+    PassInfo last=passAt(MAX_PASSES-1);
+    if(p.aos>=last.aos) return false;
+    if(evicted) *evicted=last;
+    if(g_satHorizon[last.satIdx]>last.aos-1) g_satHorizon[last.satIdx]=last.aos-1;
+    g_passCount--;
+  }
+  PassRec r=encodePass(p,g_passBase);
+  int pos=passInsertPos(r.aosOff);
+  memmove(&g_passes[pos+1],&g_passes[pos],(g_passCount-pos)*sizeof(PassRec));
+  g_passes[pos]=r;
+  g_passCount++;
+  return true;
+}
+
+// ---- optical windows ----
+// Background stage after the pass search: the visible parts of the stored
+// passes (opticalWindows()) are computed pass by pass in AOS order, from
+// the ephemeris when its window covers the pass, and kept as compact
+// records sorted by AOS, so /passes?optical=1 only formats them.
+// g_optHorizon[si] works like g_satHorizon: passes of si with an earlier
+// AOS are done. Every rebuild of the pass table starts over.
+const int      OPT_CACHE_MAX = 256;   // okna, 16 B/kus
+const uint32_t OPT_SLICE_MS  = 20;
+
+struct __attribute__((packed)) OptRec {
+  uint32_t aosOff;     // průlet: s od g_passBase
+  uint16_t startOff;   // okno: s od AOS
+  uint16_t endOff;
+  uint16_t peakOff;
+  int16_t  peakElQ;    // 0.1°
+  int16_t  peakMagQ;   // 0.01 mag
+  uint8_t  satIdx;
+  uint8_t  cls;
+};
+OptRec   g_opt[OPT_CACHE_MAX];
+int      g_optCount   = 0;
+time_t   g_optHorizon[MAX_SATS_TOTAL];
+uint32_t g_optCheckMs = 0;
+uint32_t g_optMs      = 0;
+uint32_t g_optCalls   = 0;   // SGP4
+uint32_t g_optEvals   = 0;   // z efemeridy
+
+void opticalReset(){
+  g_optCount=0;
+  for(int si=0;si<MAX_SATS_TOTAL;si++) g_optHorizon[si]=0;
+}
+
+OpticalWindow optRecWindow(const OptRec &r){
+  const time_t aos=g_passBase+(time_t)r.aosOff;
+  OpticalWindow w;
+  w.start=aos+r.startOff;
+  w.end=aos+r.endOff;
+  w.peak=aos+r.peakOff;
+  w.peakEl=r.peakElQ*0.1f;
+  w.peakMag=r.peakMagQ*0.01f;
+  w.cls=r.cls;
+  return w;
+}
+
+// first record of pass (satIdx, aosOff), or g_optCount
+int optFind(uint32_t aosOff, uint8_t satIdx){
+  int lo=0, hi=g_optCount;
+  while(lo<hi){
+    int mid=(lo+hi)/2;
+    if(g_opt[mid].aosOff<aosOff) lo=mid+1; else hi=mid;
+  }
+  while(lo<g_optCount && g_opt[lo].aosOff==aosOff && g_opt[lo].satIdx!=satIdx) lo++;
+  return (lo<g_optCount && g_opt[lo].aosOff==aosOff)?lo:g_optCount;
+}
+
+// false = no room for k more records
+bool optStore(const PassInfo &p, const OpticalWindow* w, int k){
+  if(g_optCount+k>OPT_CACHE_MAX) return false;
+  const uint32_t aosOff=(uint32_t)(p.aos-g_passBase);
+  int pos=g_optCount;
+  while(pos>0 && g_opt[pos-1].aosOff>aosOff) pos--;
+  memmove(&g_opt[pos+k],&g_opt[pos],(g_optCount-pos)*sizeof(OptRec));
+  for(int j=0;j<k;j++){
+    OptRec &r=g_opt[pos+j];
+    r.aosOff=aosOff;
+    r.startOff=(uint16_t)(w[j].start-p.aos);
+    r.endOff=(uint16_t)(w[j].end-p.aos);
+    r.peakOff=(uint16_t)(w[j].peak-p.aos);
+    r.peakElQ=(int16_t)lroundf(w[j].peakEl*10.0f);
+    r.peakMagQ=(int16_t)lroundf(constrain(w[j].peakMag,-300.0f,300.0f)*100.0f);
+    r.satIdx=p.satIdx;
+    r.cls=w[j].cls;
+  }
+  g_optCount+=k;
+  return true;
+}
+
+// passes still waiting for the stage (LOS after nowUtc)
+int opticalPending(time_t nowUtc){
+  int n=0;
+  for(int i=0;i<g_passCount;i++)
+    if(passAos(i)>=g_optHorizon[g_passes[i].satIdx] && passLos(i)>nowUtc) n++;
+  return n;
+}
+
+// ---- parallel pass jobs ----
+// A run is split into (satellite, time chunk) jobs that the job_queue
+// workers execute on both cores. Jobs are handed out by start time, so the
+// nearest passes of all satellites are found first. Only the running batch
+// exists in memory; a 7-day window with 128 satellites would otherwise be
+// thousands of job entries. A job that runs out of the loop() time slice
+// keeps its PassSearch and continues in the next slice, so one loop() never
+// waits for a whole job (a Molniya chunk takes tens of ms).
+struct PassJob {
+  uint8_t  satIdx;
+  time_t   startUtc;
+  time_t   endUtc;
+  const Sgp4Elements* sat;  // satPropagator(), obnoví se před každým slice
+  bool     started;
+  bool     finished;
+
+  // výsledek
+  PassInfo passes[PASS_JOB_MAX];
+  uint8_t  passCount;
+  uint8_t  cursor;      // další průlet při slévání
+  time_t   overflowAos;
+  uint32_t searchCalls;
+  uint32_t refineEvals;
+  uint32_t us;
+};
+
+struct PassRun {
+  PassJob* jobs;        // [batchMax], právě běžící dávka
+  int*     heap;        // [batchMax], slévání výsledků dávky
+  PassSearch* search;   // [batchMax], rozpracovaná hledání dávky
+  int      batchMax;
+  int      batch;       // joby rozpracované dávky, 0 = žádná
+  uint32_t sliceEndUs;  // micros(), kdy se má hledání přerušit
+  time_t   queued[MAX_SATS_TOTAL];  // do kdy jsou úseky satelitu rozdané
+  time_t   endUtc;
+  int      jobCount;
+  float    minElDeg;
+  double   qthLatDeg, qthLonDeg, qthAltM;
+  bool     prefilter;
+  time_t   nowUtc;
+};
+
+uint32_t predClockUs(){ return (uint32_t)micros(); }
+
+void runPassJob(void* ctx, int jobIdx){
+  PassRun &run=*(PassRun*)ctx;
+  PassJob &job=run.jobs[jobIdx];
+  if(job.finished) return;
+  PassSearch &ps=run.search[jobIdx];
+  int si=job.satIdx;
+  uint32_t us0=micros();
+
+  if(!job.started){
+    char l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+    tleRecordLines(g_sats[si].tle,l1,l2);
+    initPassSearch(ps,*job.sat,l1,l2,(uint8_t)si,
+                   run.minElDeg,run.qthLatDeg,run.qthLonDeg,run.qthAltM,
+                   run.prefilter,run.nowUtc);
+    ps.out=job.passes;
+    ps.outMax=PASS_JOB_MAX;
+    passSearchBegin(ps,job.startUtc,job.endUtc);
+    job.started=true;
+    job.us=0;
+  }
+  ps.sat=job.sat;
+
+  job.finished=passSearchAdvance(ps,predClockUs,run.sliceEndUs);
+  job.us+=micros()-us0;
+  if(!job.finished) return;
+
+  job.passCount=(uint8_t)ps.outCount;
+  job.overflowAos=ps.overflowAos;
+  job.searchCalls=ps.searchCalls;
+  job.refineEvals=ps.refineEvals;
+}
+
+// Satellite with the earliest chunk not yet handed out, or -1.
+int nextPassJobSat(const PassRun &run){
+  int best=-1;
+  for(int si=0;si<SAT_COUNT;si++){
+    if(run.queued[si]>=run.endUtc) continue;
+    if(best<0 || run.queued[si]<run.queued[best]) best=si;
+  }
+  return best;
+}
+
+// ---- pass cache in SPIFFS ----
+// The pass table survives a reboot. The file key covers the QTH and minEl;
+// each satellite has its own key from the TLE epoch and line checksums, so
+// a new TLE or a changed enabled set only invalidates the satellites
+// concerned. Everything else is restored with its horizon and the rest of
+// the window is searched as a normal extension.
+const char*    PATH_PASSES          = "/passes.txt";
+const uint32_t PASS_CACHE_SAVE_MIN_MS = 15*60*1000UL;  // šetří flash
+
+uint32_t g_passCacheSavedMs = 0;
+bool     g_passCacheSaved   = false;
+
+uint32_t fnv1a(const char* str, uint32_t h=2166136261u){
+  while(*str){ h^=(uint8_t)*str++; h*=16777619u; }
+  return h;
+}
+
+uint32_t passCacheKey(){
+  char buf[64];
+  snprintf(buf,sizeof(buf),"%.6f %.6f %.1f %.2f",g_qthLat,g_qthLon,g_qthAlt,g_minElDeg);
+  return fnv1a(buf);
+}
+
+// TLE epoch (line 1, sloupce 19-32) + kontrolní součty obou řádků
+uint32_t satCacheKey(const SatConfig &sc){
+  char l1[TLE_LINE_MAX], l2[TLE_LINE_MAX], buf[24];
+  if(!sc.tle.valid) return 0;
+  tleRecordLines(sc.tle,l1,l2);
+  memcpy(buf,l1+18,14);
+  buf[14]=l1[68]; buf[15]=l2[68]; buf[16]='\0';
+  return fnv1a(buf,fnv1a(sc.id));
+}
+
+void savePassCache(){
+  File f=SPIFFS.open(PATH_PASSES,FILE_WRITE);
+  if(!f) return;
+
+  f.printf("key %08lx\n",(unsigned long)passCacheKey());
+  for(int si=0;si<SAT_COUNT;si++){
+    if(!g_sats[si].enabled) continue;
+    uint32_t k=satCacheKey(g_sats[si]);
+    if(k==0) continue;
+    f.printf("sat %d %s %08lx %ld\n",si,g_sats[si].id,(unsigned long)k,(long)g_satHorizon[si]);
+  }
+  int n=0;
+  for(int i=0;i<g_passCount;i++){
+    const PassInfo p=passAt(i);
+    if(satCacheKey(g_sats[p.satIdx])==0) continue;
+    f.printf("p %d %ld %ld %ld %.2f %.1f %.1f %.1f\n",p.satIdx,(long)p.aos,(long)p.los,(long)p.tMax,
+             p.maxEl,p.aosAz,p.maxAz,p.losAz);
+    n++;
+  }
+  f.printf("end %d\n",n);
+  f.close();
+
+  g_passCacheSavedMs=millis();
+  g_passCacheSaved=true;
+}
+
+// Restores passes and horizons of satellites whose key still matches.
+// The others start from scratch. Returns false if the file is missing,
+// damaged or computed for another QTH / minEl.
+bool loadPassCache(time_t nowUtc){
+  File f=SPIFFS.open(PATH_PASSES,FILE_READ);
+  if(!f) return false;
+
+  String line=f.readStringUntil('\n'); line.trim();
+  unsigned long key=0;
+  if(sscanf(line.c_str(),"key %lx",&key)!=1 || (uint32_t)key!=passCacheKey()){
+    f.close();
+    return false;
+  }
+
+  // index v souboru -> aktuální index (satelity se mohly přečíslovat)
+  int fileToSat[MAX_SATS_TOTAL];
+  for(int i=0;i<MAX_SATS_TOTAL;i++) fileToSat[i]=-1;
+  time_t horizon[MAX_SATS_TOTAL];
+  for(int si=0;si<MAX_SATS_TOTAL;si++) horizon[si]=nowUtc-PASS_LOOKBACK;
+
+  g_passCount=0;
+  g_passBase=nowUtc-(time_t)PASS_OVERRUN_MAX;   // nejstarší možné AOS probíhajícího průletu
+  opticalReset();
+  int count=0, stored=-1;
+  while(f.available()){
+    line=f.readStringUntil('\n'); line.trim();
+    const char* c=line.c_str();
+    if(line.startsWith("sat ")){
+      int fi; char id[16]; unsigned long k; long h;
+      if(sscanf(c,"sat %d %15s %lx %ld",&fi,id,&k,&h)!=4 || fi<0 || fi>=MAX_SATS_TOTAL) continue;
+      for(int si=0;si<SAT_COUNT;si++){
+        if(!g_sats[si].enabled || strcmp(g_sats[si].id,id)!=0) continue;
+        if(satCacheKey(g_sats[si])!=(uint32_t)k) break;
+        fileToSat[fi]=si;
+        if((time_t)h>horizon[si]) horizon[si]=(time_t)h;
+        break;
       }
+    } else if(line.startsWith("p ")){
+      int fi; long aos,los,tMax; float maxEl,aosAz,maxAz,losAz;
+      if(sscanf(c,"p %d %ld %ld %ld %f %f %f %f",&fi,&aos,&los,&tMax,
+                &maxEl,&aosAz,&maxAz,&losAz)!=8) continue;
+      if(fi<0 || fi>=MAX_SATS_TOTAL || fileToSat[fi]<0) continue;
+      if(los<=nowUtc) continue;
+      PassInfo p;
+      p.aos=aos; p.los=los; p.tMax=tMax; p.maxEl=maxEl;
+      p.aosAz=aosAz; p.maxAz=maxAz; p.losAz=losAz;
+      p.satIdx=(uint8_t)fileToSat[fi];
+      if(storePass(p)) count++;
+    } else if(line.startsWith("end ")){
+      stored=line.substring(4).toInt();
+    }
+  }
+  f.close();
+  if(stored<0){ g_passCount=0; return false; }   // neúplný zápis
+
+  int restored=0;
+  for(int si=0;si<MAX_SATS_TOTAL;si++){
+    g_satHorizon[si]=horizon[si];
+    if(horizon[si]>nowUtc-PASS_LOOKBACK) restored++;
+  }
+  Serial.printf("[PRED] restored %d passes of %d satellites from cache\n",count,restored);
+  return true;
 }
 
-void refinePassMax(PassInfo &p){
-  time_t center=p.tMax; if(center==0) return;
-  time_t tStart=center-120, tEnd=center+120;
-  if(tStart<p.aos) tStart=p.aos;
-  if(tEnd>p.los) tEnd=p.los;
-  if(tEnd<=tStart) return;
+// ---- budgeted prediction engine ----
+// A run does not block loop(): predictStep() executes job batches until its
+// time slice is used up and publishes the passes found so far, so the list
+// fills in progressively even with 100+ satellites enabled. The slice is
+// kept to within one coarse step: jobs suspend at its end and the batch is
+// resumed by the next predictStep(); it is merged only when all its jobs
+// have finished, so the result does not depend on where the cuts fell.
+const uint32_t PRED_SLICE_MS = 40;    // CPU čas pro výpočet v jednom loop()
+
+struct SatPredStats {
+  uint32_t us;       // čas výpočtu (součet přes joby)
+  uint32_t calls;    // volání SGP4 (bez vzorků z efemeridy)
+  uint16_t jobs;
+  uint16_t passes;
+};
+// od posledního plného přepočtu
+SatPredStats g_satStats[MAX_SATS_TOTAL];
+
+struct PredEngine {
+  bool     active;
+  bool     full;       // plný přepočet (vždy se uloží do cache)
+  PassRun  run;
+  int      added;
+  uint32_t startMs, busyMs;
+  uint32_t searchCalls, refineEvals;
+};
+PredEngine g_pred = {};
+
+bool predictBusy(){ return g_pred.active; }
+
+// completed=false: the run is being replaced and its rest dropped.
+void finishPrediction(bool completed=false){
+  if(!g_pred.active) return;
+  Serial.printf("[PRED] +%d passes (%d total), %d jobs on %d workers, "
+                "%lu search + %lu refine evals, %lu ms CPU in %lu ms\n",
+                g_pred.added,g_passCount,g_pred.run.jobCount,jobWorkerCount(),
+                (unsigned long)g_pred.searchCalls,(unsigned long)g_pred.refineEvals,
+                (unsigned long)g_pred.busyMs,(unsigned long)(millis()-g_pred.startMs));
+  free(g_pred.run.jobs);
+  free(g_pred.run.heap);
+  delete[] g_pred.run.search;
+  g_pred.run.jobs=nullptr;
+  g_pred.run.heap=nullptr;
+  g_pred.run.search=nullptr;
+  g_pred.run.batch=0;
+  g_pred.active=false;
+  g_lastPassListMinute=-1;
 
-  float bestEl=p.maxEl; time_t bestT=p.tMax; float bestAz=p.maxAz;
-  for(time_t t=tStart;t<=tEnd;t++){
-    SatState s=computeSatellite(p.satIdx,t);
-    if(s.el>bestEl){ bestEl=s.el; bestT=t; bestAz=s.az; }
+  if(completed && (!g_passCacheSaved || millis()-g_passCacheSavedMs>=PASS_CACHE_SAVE_MIN_MS || g_pred.full))
+    savePassCache();
+}
+
+// Merges one finished batch. Each job's passes are already in AOS order, so
+// the jobs are merged through a min-heap of their next pass and each pass
+// goes into the store with a binary search. A satellite's horizon only moves
+// forward by whole jobs in time order; a job that no longer starts at the
+// horizon (an earlier one overflowed) is dropped and searched again by a
+// later run.
+int mergePassBatch(PassRun &run, int batch){
+  int* heap=run.heap;
+  int heapN=0;
+  auto headAos=[&](int j){ return run.jobs[j].passes[run.jobs[j].cursor].aos; };
+
+  for(int j=0;j<batch;j++){
+    PassJob &job=run.jobs[j];
+    int si=job.satIdx;
+    job.cursor=0;
+    if(job.startUtc!=g_satHorizon[si]){ job.passCount=0; continue; }
+
+    SatPredStats &st=g_satStats[si];
+    st.us+=job.us;
+    st.calls+=job.searchCalls+job.refineEvals;
+    st.jobs++;
+    g_pred.searchCalls+=job.searchCalls;
+    g_pred.refineEvals+=job.refineEvals;
+    g_satHorizon[si]=(job.overflowAos!=0)?job.overflowAos-1:job.endUtc;
+
+    if(job.passCount==0) continue;
+    // sift up
+    int c=heapN++;
+    while(c>0 && headAos(heap[(c-1)/2])>headAos(j)){ heap[c]=heap[(c-1)/2]; c=(c-1)/2; }
+    heap[c]=j;
+  }
+
+  int added=0;
+  while(heapN>0){
+    int j=heap[0];
+    PassJob &job=run.jobs[j];
+    const PassInfo &p=job.passes[job.cursor];
+    int si=p.satIdx;
+
+    PassInfo ev; ev.satIdx=0xFF;
+    if(!storePass(p,&ev)){
+      // plno: tenhle i všechny další průlety v haldě jsou pozdější
+      for(int k=0;k<heapN;k++){
+        const PassJob &r=run.jobs[heap[k]];
+        const PassInfo &q=r.passes[r.cursor];
+        if(g_satHorizon[q.satIdx]>q.aos-1) g_satHorizon[q.satIdx]=q.aos-1;
+      }
+      break;
+    }
+    g_satStats[si].passes++;
+    added++;
+    if(ev.satIdx!=0xFF){ g_satStats[ev.satIdx].passes--; added--; }
+
+    // next pass of job j, or drop it from the heap; sift down
+    if(++job.cursor>=job.passCount) j=heap[--heapN];
+    int c=0;
+    while(true){
+      int l=2*c+1;
+      if(l>=heapN) break;
+      if(l+1<heapN && headAos(heap[l+1])<headAos(heap[l])) l++;
+      if(headAos(heap[l])>=headAos(j)) break;
+      heap[c]=heap[l]; c=l;
+    }
+    if(heapN>0) heap[c]=j;
+  }
+  return added;
+}
+
+// Runs pending jobs for up to budgetMs. Returns true while work remains.
+bool predictStep(uint32_t budgetMs){
+  if(!g_pred.active) return false;
+  PassRun &run=g_pred.run;
+  uint32_t ms0=millis();
+  run.sliceEndUs=(uint32_t)micros()+budgetMs*1000;
+  int added=0;
+  bool done=false;
+
+  PassRec trailPass{};
+  if(g_trailPassIdx>=0) trailPass=g_passes[g_trailPassIdx];
+
+  while(millis()-ms0<budgetMs){
+    if(run.batch==0){
+      int batch=0;
+      while(batch<run.batchMax){
+        int si=nextPassJobSat(run);
+        if(si<0) break;
+        // plný store: další úseky začínají až po posledním uloženém průletu
+        if(g_passCount>=MAX_PASSES && run.queued[si]>=passAos(MAX_PASSES-1)) break;
+
+        PassJob &job=run.jobs[batch++];
+        job.satIdx=(uint8_t)si;
+        job.startUtc=run.queued[si];
+        job.endUtc=(job.startUtc+PASS_JOB_CHUNK<run.endUtc)?job.startUtc+PASS_JOB_CHUNK:run.endUtc;
+        job.started=false;
+        job.finished=false;
+        run.queued[si]=job.endUtc;
+      }
+      if(batch==0){ done=true; break; }
+      run.batch=batch;
+    }
+
+    // elementy z poolu jen tady v loop(), workery je jen čtou; dávka
+    // (batchMax) je menší než pool, takže si joby sloty nevytlačí
+    for(int j=0;j<run.batch;j++){
+      PassJob &job=run.jobs[j];
+      if(job.finished) continue;
+      job.sat=satPropagator(job.satIdx);
+      if(job.sat) continue;
+      job.finished=true;   // TLE nejde inicializovat: žádné průlety
+      job.passCount=0; job.overflowAos=0;
+      job.searchCalls=0; job.refineEvals=0; job.us=0;
+    }
+    runJobs(runPassJob,&run,run.batch);
+    bool finished=true;
+    for(int j=0;j<run.batch;j++) finished&=run.jobs[j].finished;
+    if(!finished) break;   // slice je pryč, dávka pokračuje příště
+    added+=mergePassBatch(run,run.batch);
+    run.batch=0;
+  }
+  g_pred.busyMs+=millis()-ms0;
+  g_pred.added+=added;
+
+  if(added!=0){
+    // publish: indexy se posunuly, stopa patří pořád stejnému průletu
+    if(g_trailPassIdx>=0){
+      g_trailPassIdx=-1;
+      for(int i=0;i<g_passCount;i++)
+        if(g_passes[i].satIdx==trailPass.satIdx && g_passes[i].aosOff==trailPass.aosOff){ g_trailPassIdx=i; break; }
+    }
+    g_lastPassListMinute=-1;
+  }
+
+  if(done){ finishPrediction(true); return false; }
+  return true;
+}
+
+// Drops finished passes and queues only the part of the window each
+// satellite is missing, so a steady-state update costs the time added since
+// the last one rather than the whole window. A run still in progress is
+// replaced; what it merged so far is kept.
+void extendPasses(time_t nowUtc, bool full=false){
+  finishPrediction();
+
+  int kept=0;
+  for(int i=0;i<g_passCount;i++)
+    if(passLos(i)>nowUtc) g_passes[kept++]=g_passes[i];
+  g_passCount=kept;
+
+  PassRun &run=g_pred.run;
+  run.endUtc=nowUtc+(time_t)g_passWindowH*3600;
+  run.jobCount=0;
+  for(int si=0;si<MAX_SATS_TOTAL;si++){
+    bool ok=si<SAT_COUNT && g_sats[si].enabled && g_sats[si].tle.valid;
+    run.queued[si]=ok?g_satHorizon[si]:run.endUtc;
+    if(ok && g_satHorizon[si]<run.endUtc)
+      run.jobCount+=(int)((run.endUtc-g_satHorizon[si]+PASS_JOB_CHUNK-1)/PASS_JOB_CHUNK);
   }
-  p.maxEl=bestEl; p.tMax=bestT; p.maxAz=bestAz;
+  if(run.jobCount==0) return;
+
+  run.batchMax=jobWorkerCount();
+  run.jobs=(PassJob*)calloc(run.batchMax,sizeof(PassJob));
+  run.heap=(int*)calloc(run.batchMax,sizeof(int));
+  run.search=new (std::nothrow) PassSearch[run.batchMax]();
+  run.batch=0;
+  if(!run.jobs||!run.heap||!run.search){
+    free(run.jobs); free(run.heap); delete[] run.search;
+    run.jobs=nullptr; run.heap=nullptr; run.search=nullptr;
+    Serial.println("[PRED] out of memory for pass jobs");
+    return;
+  }
+  run.minElDeg=g_minElDeg;
+  run.qthLatDeg=g_qthLat;
+  run.qthLonDeg=g_qthLon;
+  run.qthAltM=g_qthAlt;
+  run.prefilter=g_passPrefilter;
+  run.nowUtc=nowUtc;
+
+  g_pred.added=0;
+  g_pred.startMs=millis();
+  g_pred.busyMs=0;
+  g_pred.searchCalls=0;
+  g_pred.refineEvals=0;
+  g_pred.full=full;
+  g_pred.active=true;
+
+  predictStep(PRED_SLICE_MS);
 }
 
+// Full recomputation (config, TLE or time source changed).
 void predictPasses(time_t startUtc){
+  finishPrediction();
   g_passCount=0;
-  const time_t endUtc=startUtc+24*3600;
-  const time_t step=10;
 
   if(g_minElDeg<0) g_minElDeg=0;
   if(g_minElDeg>90) g_minElDeg=90;
 
+  // hledá se i kousek zpět, aby probíhající průlet dostal skutečné AOS
+  g_passBase=startUtc-PASS_LOOKBACK;
+  opticalReset();
+  for(int si=0;si<MAX_SATS_TOTAL;si++) g_satHorizon[si]=startUtc-PASS_LOOKBACK;
+  memset(g_satStats,0,sizeof(g_satStats));
+  extendPasses(startUtc,true);
+}
+
+// Boot / first valid time: restore the cached table if it still fits the
+// configuration and search only what is missing.
+void restorePasses(time_t nowUtc){
+  if(g_minElDeg<0) g_minElDeg=0;
+  if(g_minElDeg>90) g_minElDeg=90;
+
+  finishPrediction();
+  if(!loadPassCache(nowUtc)){ predictPasses(nowUtc); return; }
+  memset(g_satStats,0,sizeof(g_satStats));
+  extendPasses(nowUtc);
+}
+
+// ---- ephemeris stage ----
+// Picks the first satellite (in pass order, then GEO marks) whose slot is
+// missing, stale or ends within EPHEM_REFIT_S, and starts its fit in the
+// slot of the same satellite, a free one or one no longer wanted.
+bool ephemBeginNext(time_t nowUtc){
+  static bool wanted[MAX_SATS_TOTAL];
+  int order[EPHEM_SLOTS], n=0;
+  memset(wanted,0,sizeof(wanted));
+  for(int i=0;i<g_passCount && n<EPHEM_SLOTS;i++){
+    int si=g_passes[i].satIdx;
+    if(passLos(i)<nowUtc || wanted[si]) continue;
+    wanted[si]=true; order[n++]=si;
+  }
+  for(int k=0;k<g_geoMarkCount && n<EPHEM_SLOTS;k++){
+    int si=g_geoMarks[k].satIdx;
+    if(!wanted[si]){ wanted[si]=true; order[n++]=si; }
+  }
+
+  for(int k=0;k<n;k++){
+    int si=order[k];
+    const ChebEphem* e=satEphem(si);
+    if(e && chebCovers(*e,(double)(nowUtc+EPHEM_REFIT_S))) continue;
+
+    int slot=-1;
+    for(int j=0;j<EPHEM_SLOTS && slot<0;j++)
+      if(g_ephem[j].ready && g_ephem[j].satIdx==si) slot=j;
+    for(int j=0;j<EPHEM_SLOTS && slot<0;j++)
+      if(!g_ephem[j].ready) slot=j;
+    for(int j=0;j<EPHEM_SLOTS && slot<0;j++)
+      if(!wanted[g_ephem[j].satIdx]) slot=j;
+    if(slot<0) return false;
+
+    EphemSlot &sl=g_ephem[slot];
+    if(!sl.seg) sl.seg=(ChebSeg*)malloc(EPHEM_SEGS*sizeof(ChebSeg));
+    if(!sl.seg){ Serial.println("[EPHEM] out of memory"); return false; }
+    const TleRecord &t=g_sats[si].tle;
+    const Sgp4Elements* sat=satPropagator(si);
+    if(!sat) continue;
+    sl.ready=false;
+    sl.satIdx=(uint8_t)si;
+    memcpy(sl.satnum,t.satnum,sizeof(sl.satnum));
+    sl.tleDay=t.epochDay;
+    sl.tleFrac=t.epochFrac;
+    chebBegin(sl.e,*sat,(double)(nowUtc-PASS_LOOKBACK),sl.seg,EPHEM_SEGS);
+    g_ephemFitting=slot;
+    g_ephemFitEnd=nowUtc+EPHEM_SPAN_S;
+    g_ephemFitMs=0;
+    return true;
+  }
+  return false;
+}
+
+// Background stage of loop(): fits segments for up to budgetMs. Runs only
+// while no pass run is active, the pass search goes first.
+void ephemStep(time_t nowUtc, uint32_t budgetMs){
+  if(predictBusy() || !g_haveTime) return;
+  uint32_t ms0=millis();
+  if(g_ephemFitting<0){
+    if(ms0-g_ephemCheckMs<1000) return;
+    g_ephemCheckMs=ms0;
+    if(!ephemBeginNext(nowUtc)) return;
+  }
+
+  EphemSlot &sl=g_ephem[g_ephemFitting];
+  if(!ephemSameTle(sl,g_sats[sl.satIdx].tle)){ g_ephemFitting=-1; return; }   // nová TLE / smazaný
+  const Sgp4Elements* sat=satPropagator(sl.satIdx);
+  if(!sat){ g_ephemFitting=-1; return; }
+  bool more=true;
+  while(more && millis()-ms0<budgetMs)
+    more=chebFitStep(sl.e,*sat,(double)g_ephemFitEnd);
+  g_ephemFitMs+=millis()-ms0;
+  if(more) return;
+
+  sl.ready=sl.e.segCount>0;
+  g_ephemFitting=-1;
+  g_ephemFits++;
+  g_ephemFitCalls+=sl.e.fitCalls;
+  Serial.printf("[EPHEM] %s: %d segs, %.1f h, err %.3f km, %lu SGP4, %lu ms\n",
+                g_sats[sl.satIdx].shortName,sl.e.segCount,sl.e.span/3600.0,sl.e.errKm,
+                (unsigned long)sl.e.fitCalls,(unsigned long)g_ephemFitMs);
+}
+
+// ---- optical stage ----
+// Background stage of loop(), after ephemStep(): runs only while no pass
+// run is active (the table is stable then). Once everything is done it
+// looks for new passes once a second.
+void opticalStep(time_t nowUtc, uint32_t budgetMs){
+  if(predictBusy() || !g_haveTime) return;
+  uint32_t ms0=millis();
+  if(ms0-g_optCheckMs<1000) return;
+
+  // okna průletů, které už skončily
+  int kept=0;
+  for(int j=0;j<g_optCount;j++){
+    const OptRec &r=g_opt[j];
+    if(g_passBase+(time_t)r.aosOff+r.endOff>nowUtc) g_opt[kept++]=r;
+  }
+  g_optCount=kept;
+
+  bool more=false;
+  for(int i=0;i<g_passCount;i++){
+    const int si=g_passes[i].satIdx;
+    if(passAos(i)<g_optHorizon[si] || passLos(i)<=nowUtc) continue;
+    if(millis()-ms0>=budgetMs){ more=true; break; }
+    const PassInfo p=passAt(i);
+    OpticalWindow w[OPT_WINDOWS_MAX];
+    int k=0;
+    const ChebEphem* e=satEphem(si);
+    if(e && chebCovers(*e,(double)p.aos) && chebCovers(*e,(double)p.los))
+      k=opticalWindows(*e,g_qthFrame,g_sunCache,p,OPT_STD_MAG,w,OPT_WINDOWS_MAX,&g_optEvals);
+    else if(const Sgp4Elements* sat=satPropagator(si))
+      k=opticalWindows(*sat,g_qthFrame,g_sunCache,p,OPT_STD_MAG,w,OPT_WINDOWS_MAX,&g_optCalls);
+    if(!optStore(p,w,k)) break;   // plno: zbytek, až starší okna skončí
+    g_optHorizon[si]=p.aos+1;
+  }
+  g_optMs+=millis()-ms0;
+  if(!more) g_optCheckMs=ms0;
+}
+
+// ---- elevation profiles ----
+// Background stage after the ephemeris: searches every enabled satellite at
+// the horizon (PROFILE_BASE_EL_DEG) chunk by chunk, earliest chunk first
+// like the pass jobs, and keeps each arc as int16 az/el samples. The
+// profile depends on the QTH and the TLE, not on minEl, so a new minEl is
+// applied by rethresholdPasses() from the samples alone and /passes?minel=
+// previews one without saving. A satellite's profile is complete up to
+// cover[si] (the same chunk rule as g_satHorizon); a full pool stops it
+// until passes expire and make room.
+const int      PROFILE_SAMPLES_MAX = 8192;   // 32 kB, ~300 LEO oblouků
+const int      PROFILE_ARCS_MAX    = 512;     // 10 kB
+const uint32_t PROFILE_SLICE_MS    = 20;
+
+struct ProfileStore {
+  ProfileSample* samples;     // [PROFILE_SAMPLES_MAX], alokuje se při prvním použití
+  ProfileArc*    arcs;        // [PROFILE_ARCS_MAX]
+  PassSearch*    search;      // hledání rozpracovaného úseku
+  int      sampleCount, arcCount;
+  time_t   base;              // horizont při založení, offsety oblouků
+  uint32_t qthKey;
+  time_t   cover[MAX_SATS_TOTAL];
+  uint32_t tleKey[MAX_SATS_TOTAL];   // satCacheKey() při prvním úseku, 0 = nic
+
+  int      satIdx;            // rozpracovaný úsek, -1 = žádný
+  time_t   chunkEnd;
+  bool     sampling;          // hledání hotové, vzorkují se průlety
+  int      passIdx;
+  PassInfo passes[PASS_JOB_MAX];
+
+  uint32_t checkMs;
+  uint32_t calls;             // SGP4 hledání + vzorky
+  uint32_t busyMs;
+};
+ProfileStore g_prof = {};
+
+uint32_t profileQthKey(){
+  char buf[48];
+  snprintf(buf,sizeof(buf),"%.6f %.6f %.1f",g_qthLat,g_qthLon,g_qthAlt);
+  return fnv1a(buf);
+}
+
+// profile of satellite si is usable: same TLE, and covers more than nothing
+bool profileCovers(int si){
+  return g_prof.arcs && g_prof.qthKey==profileQthKey() && g_prof.tleKey[si]!=0 &&
+         g_prof.tleKey[si]==satCacheKey(g_sats[si]) && g_prof.cover[si]>g_prof.base;
+}
+
+void profileReset(time_t nowUtc){
+  g_prof.sampleCount=0;
+  g_prof.arcCount=0;
+  g_prof.base=nowUtc-PASS_LOOKBACK;
+  g_prof.qthKey=profileQthKey();
+  for(int si=0;si<MAX_SATS_TOTAL;si++){ g_prof.cover[si]=g_prof.base; g_prof.tleKey[si]=0; }
+  g_prof.satIdx=-1;
+}
+
+// Drops finished arcs and those of satellites with a new TLE (their
+// profile starts over), and compacts the pool.
+void profileCompact(time_t nowUtc){
   for(int si=0;si<SAT_COUNT;si++){
-    if(!g_sats[si].enabled) continue;
-    if(strlen(g_sats[si].l1)<10||strlen(g_sats[si].l2)<10) continue;
-
-    bool above=false; time_t aos=0,lastAboveTime=0,tMax=0;
-    float aosAz=0,lastAboveAz=0,maxEl=-90,maxAz=0;
-
-    for(time_t t=startUtc;t<endUtc;t+=step){
-      SatState s=computeSatellite(si,t);
-
-      if(!above && s.el>g_minElDeg){
-        above=true; aos=t; aosAz=s.az; lastAboveTime=t; lastAboveAz=s.az;
-        maxEl=s.el; tMax=t; maxAz=s.az;
-      } else if(above && s.el>g_minElDeg){
-        lastAboveTime=t; lastAboveAz=s.az;
-        if(s.el>maxEl){ maxEl=s.el; tMax=t; maxAz=s.az; }
-      } else if(above && s.el<=g_minElDeg){
-        if(g_passCount<MAX_PASSES && lastAboveTime>aos){
-          g_passes[g_passCount]={aos,lastAboveTime,tMax,maxEl,aosAz,maxAz,lastAboveAz,(uint8_t)si};
-          g_passCount++;
-        }
-        above=false;
-      }
+    if(g_prof.tleKey[si]==0 || g_prof.tleKey[si]==satCacheKey(g_sats[si])) continue;
+    g_prof.tleKey[si]=0;
+    g_prof.cover[si]=nowUtc-PASS_LOOKBACK;
+  }
+  int arcs=0, samples=0;
+  for(int a=0;a<g_prof.arcCount;a++){
+    ProfileArc arc=g_prof.arcs[a];
+    if(g_prof.tleKey[arc.satIdx]==0 || g_prof.base+(time_t)arc.aosOff+arc.dur<=nowUtc) continue;
+    memmove(&g_prof.samples[samples],&g_prof.samples[arc.first],arc.count*sizeof(ProfileSample));
+    arc.first=(uint16_t)samples;
+    samples+=arc.count;
+    g_prof.arcs[arcs++]=arc;
+  }
+  g_prof.arcCount=arcs;
+  g_prof.sampleCount=samples;
+}
+
+// Starts the earliest missing chunk of an enabled satellite, like
+// nextPassJobSat(). False when all is covered or the pool is full.
+bool profileBeginNext(time_t nowUtc){
+  profileCompact(nowUtc);
+  if(g_prof.arcCount>=PROFILE_ARCS_MAX || g_prof.sampleCount+PROFILE_ARC_SAMPLES>PROFILE_SAMPLES_MAX)
+    return false;
+
+  const time_t endUtc=nowUtc+(time_t)g_passWindowH*3600;
+  int si=-1;
+  for(int k=0;k<SAT_COUNT;k++){
+    if(!g_sats[k].enabled || !g_sats[k].tle.valid || g_prof.cover[k]>=endUtc) continue;
+    if(si<0 || g_prof.cover[k]<g_prof.cover[si]) si=k;
+  }
+  if(si<0) return false;
+
+  const Sgp4Elements* sat=satPropagator(si);
+  if(!sat){ g_prof.cover[si]=endUtc; return false; }   // TLE nejde inicializovat
+  PassSearch &ps=*g_prof.search;
+  char l1[TLE_LINE_MAX], l2[TLE_LINE_MAX];
+  tleRecordLines(g_sats[si].tle,l1,l2);
+  initPassSearch(ps,*sat,l1,l2,(uint8_t)si,PROFILE_BASE_EL_DEG,
+                 g_qthLat,g_qthLon,g_qthAlt,g_passPrefilter,nowUtc);
+  ps.out=g_prof.passes;
+  ps.outMax=PASS_JOB_MAX;
+  const time_t start=g_prof.cover[si];
+  g_prof.chunkEnd=(start+PASS_JOB_CHUNK<endUtc)?start+PASS_JOB_CHUNK:endUtc;
+  passSearchBegin(ps,start,g_prof.chunkEnd);
+  if(g_prof.tleKey[si]==0) g_prof.tleKey[si]=satCacheKey(g_sats[si]);
+  g_prof.satIdx=si;
+  g_prof.sampling=false;
+  g_prof.passIdx=0;
+  return true;
+}
+
+// Background stage of loop(), after ephemStep(): runs only while no pass
+// run and no fit is active. The SGP4 elements are looked up again in every
+// slice, since the pool may have reused the slot in between.
+void profileStep(time_t nowUtc, uint32_t budgetMs){
+  if(predictBusy() || g_ephemFitting>=0 || !g_haveTime) return;
+  uint32_t ms0=millis();
+  if(!g_prof.arcs){
+    if(ms0-g_prof.checkMs<1000) return;
+    g_prof.checkMs=ms0;
+    g_prof.samples=(ProfileSample*)malloc(PROFILE_SAMPLES_MAX*sizeof(ProfileSample));
+    g_prof.arcs=(ProfileArc*)malloc(PROFILE_ARCS_MAX*sizeof(ProfileArc));
+    g_prof.search=new (std::nothrow) PassSearch();
+    if(!g_prof.samples || !g_prof.arcs || !g_prof.search){
+      free(g_prof.samples); free(g_prof.arcs); delete g_prof.search;
+      g_prof.samples=nullptr; g_prof.arcs=nullptr; g_prof.search=nullptr;
+      Serial.println("[PROF] out of memory");
+      return;
     }
+    profileReset(nowUtc);
+  }
+  if(g_prof.qthKey!=profileQthKey()) profileReset(nowUtc);
+
+  if(g_prof.satIdx<0){
+    if(ms0-g_prof.checkMs<1000) return;
+    g_prof.checkMs=ms0;
+    if(!profileBeginNext(nowUtc)) return;
+  }
+
+  const int si=g_prof.satIdx;
+  PassSearch &ps=*g_prof.search;
+  if(g_prof.tleKey[si]!=satCacheKey(g_sats[si])){ g_prof.satIdx=-1; return; }   // nová TLE
+  ps.sat=satPropagator(si);
+  if(!ps.sat){ g_prof.satIdx=-1; return; }
+  if(!g_prof.sampling){
+    uint32_t c0=ps.searchCalls+ps.refineEvals;
+    g_prof.sampling=passSearchAdvance(ps,predClockUs,(uint32_t)micros()+budgetMs*1000);
+    g_prof.calls+=ps.searchCalls+ps.refineEvals-c0;
+  }
+
+  bool full=false;
+  while(g_prof.sampling && g_prof.passIdx<ps.outCount && millis()-ms0<budgetMs){
+    if(g_prof.arcCount>=PROFILE_ARCS_MAX ||
+       g_prof.sampleCount+PROFILE_ARC_SAMPLES>PROFILE_SAMPLES_MAX){ full=true; break; }
+    ProfileArc &arc=g_prof.arcs[g_prof.arcCount];
+    int n=sampleProfileArc(*ps.sat,ps.site,g_prof.passes[g_prof.passIdx],g_prof.base,arc,
+                           g_prof.samples+g_prof.sampleCount,PROFILE_SAMPLES_MAX-g_prof.sampleCount,
+                           &g_prof.calls);
+    g_prof.passIdx++;
+    if(n==0) continue;   // SGP4 selhala (zánik)
+    arc.first=(uint16_t)g_prof.sampleCount;
+    g_prof.sampleCount+=n;
+    g_prof.arcCount++;
+  }
+  g_prof.busyMs+=millis()-ms0;
+  if(!g_prof.sampling || (!full && g_prof.passIdx<ps.outCount)) return;
+
+  // plný pool: zbytek úseku až po uvolnění místa
+  if(full) g_prof.cover[si]=g_prof.passes[g_prof.passIdx].aos-1;
+  else g_prof.cover[si]=(ps.overflowAos!=0)?ps.overflowAos-1:g_prof.chunkEnd;
+  g_prof.satIdx=-1;
+}
 
-    if(above && g_passCount<MAX_PASSES && lastAboveTime>aos){
-      g_passes[g_passCount]={aos,lastAboveTime,tMax,maxEl,aosAz,maxAz,lastAboveAz,(uint8_t)si};
-      g_passCount++;
+// Passes above minEl of arc a that the table would hold: AOS before the
+// satellite's cover, LOS after nowUtc. Returns the count.
+int profileArcPasses(int a, float minEl, time_t nowUtc, PassInfo* out){
+  const ProfileArc &arc=g_prof.arcs[a];
+  int n=profilePasses(arc,g_prof.samples,g_prof.base,minEl,out,PASS_JOB_MAX);
+  int kept=0;
+  for(int i=0;i<n;i++)
+    if(out[i].los>nowUtc && out[i].aos<g_prof.cover[arc.satIdx]) out[kept++]=out[i];
+  return kept;
+}
+
+// Applies g_minElDeg from the profiles: satellites with a usable profile
+// get their passes up to their cover without SGP4, the others and the rest
+// of the window are searched by a normal extension. False when there is
+// no profile for this QTH yet (the caller recomputes).
+bool rethresholdPasses(time_t nowUtc){
+  static bool use[MAX_SATS_TOTAL];
+  if(g_minElDeg<0) g_minElDeg=0;
+  if(g_minElDeg>90) g_minElDeg=90;
+  if(!g_prof.arcs || g_prof.qthKey!=profileQthKey() || g_minElDeg<PROFILE_BASE_EL_DEG) return false;
+  int sats=0;
+  for(int si=0;si<MAX_SATS_TOTAL;si++){
+    use[si]=si<SAT_COUNT && g_sats[si].enabled && g_sats[si].tle.valid && profileCovers(si);
+    if(use[si]) sats++;
+  }
+  if(sats==0) return false;
+
+  uint32_t ms0=millis();
+  finishPrediction();
+  g_passCount=0;
+  g_passBase=g_prof.base;
+  opticalReset();
+  for(int si=0;si<MAX_SATS_TOTAL;si++) g_satHorizon[si]=use[si]?g_prof.cover[si]:nowUtc-PASS_LOOKBACK;
+  memset(g_satStats,0,sizeof(g_satStats));
+
+  int count=0;
+  for(int a=0;a<g_prof.arcCount;a++){
+    int si=g_prof.arcs[a].satIdx;
+    if(!use[si]) continue;
+    PassInfo p[PASS_JOB_MAX];
+    int n=profileArcPasses(a,g_minElDeg,nowUtc,p);
+    for(int i=0;i<n;i++){
+      PassInfo ev; ev.satIdx=0xFF;
+      if(!storePass(p[i],&ev)){
+        // plno: najde se znovu, až bude místo
+        if(g_satHorizon[si]>p[i].aos-1) g_satHorizon[si]=p[i].aos-1;
+        continue;
+      }
+      g_satStats[si].passes++;
+      count++;
+      if(ev.satIdx!=0xFF){ g_satStats[ev.satIdx].passes--; count--; }
     }
   }
+  // oblouky nejsou seřazené: co je za posunutým horizontem, najde rozšíření
+  int kept=0;
+  for(int i=0;i<g_passCount;i++){
+    int si=g_passes[i].satIdx;
+    if(passAos(i)<g_satHorizon[si]) g_passes[kept++]=g_passes[i];
+    else { g_satStats[si].passes--; count--; }
+  }
+  g_passCount=kept;
+  Serial.printf("[PROF] min. elev %.1f: %d passes of %d satellites from profiles, no SGP4, %lu ms\n",
+                g_minElDeg,count,sats,(unsigned long)(millis()-ms0));
+  g_lastPassListMinute=-1;
 
-  sortPassesByAos();
-  for(int i=0;i<g_passCount;i++) refinePassMax(g_passes[i]);
+  extendPasses(nowUtc,true);
+  if(!predictBusy()) savePassCache();   // nic nezbylo k hledání
+  return true;
+}
+
+float sgp4PoolHitPct(){
+  uint32_t n=g_sgp4PoolHits+g_sgp4PoolMisses;
+  return n?100.0f*g_sgp4PoolHits/n:0.0f;
+}
+
+void printPredStats(){
+  Serial.println("[PRED] sat          ms   SGP4  jobs passes orbit");
+  for(int si=0;si<SAT_COUNT;si++){
+    const SatPredStats &st=g_satStats[si];
+    if(st.jobs==0) continue;
+    Serial.printf("[PRED] %-10s %5lu %6lu %5u %6u %s\n",g_sats[si].shortName,
+                  (unsigned long)(st.us/1000),(unsigned long)st.calls,st.jobs,st.passes,
+                  orbitRegimeName(orbitRegime(g_sats[si].tle)));
+  }
+  Serial.printf("[SGP4] pool %d x %u B, %lu hits, %lu init (%.1f %% hits); %d sats x %u B TLE\n",
+                SGP4_POOL_SIZE,(unsigned)sizeof(Sgp4Slot),(unsigned long)g_sgp4PoolHits,
+                (unsigned long)g_sgp4PoolMisses,sgp4PoolHitPct(),SAT_COUNT,(unsigned)sizeof(TleRecord));
+  int ready=0;
+  float errKm=0.0f;
+  for(const EphemSlot &sl:g_ephem){
+    if(!sl.ready) continue;
+    ready++;
+    if(sl.e.errKm>errKm) errKm=sl.e.errKm;
+  }
+  Serial.printf("[EPHEM] %d/%d slots x %d segs (%u B), max err %.3f km; %lu fits, %lu SGP4; "
+                "%lu live/trail evals, %lu SGP4\n",
+                ready,EPHEM_SLOTS,EPHEM_SEGS,(unsigned)(EPHEM_SEGS*sizeof(ChebSeg)),errKm,
+                (unsigned long)g_ephemFits,(unsigned long)g_ephemFitCalls,
+                (unsigned long)g_ephemEvals,(unsigned long)g_propCalls);
+  int profSats=0;
+  for(int si=0;si<SAT_COUNT;si++) if(profileCovers(si)) profSats++;
+  Serial.printf("[PROF] %d arcs, %d/%d samples (%u B), %d satellites covered; %lu SGP4, %lu ms\n",
+                g_prof.arcCount,g_prof.sampleCount,PROFILE_SAMPLES_MAX,
+                (unsigned)(PROFILE_SAMPLES_MAX*sizeof(ProfileSample)+PROFILE_ARCS_MAX*sizeof(ProfileArc)),
+                profSats,(unsigned long)g_prof.calls,(unsigned long)g_prof.busyMs);
+  Serial.printf("[OPT] %d/%d windows (%u B), %d passes pending; %lu SGP4, %lu ephemeris evals, %lu ms\n",
+                g_optCount,OPT_CACHE_MAX,(unsigned)sizeof(g_opt),opticalPending(time(nullptr)),
+                (unsigned long)g_optCalls,(unsigned long)g_optEvals,(unsigned long)g_optMs);
+  Serial.printf("[TRACK] %s, %lu samples at %lu ms, %lu SGP4 anchors %.0f s apart\n",
+                g_trackSat>=0?g_sats[g_trackSat].shortName:"-",(unsigned long)g_trackSamples,
+                (unsigned long)TRACK_RATE_MS,(unsigned long)g_track.anchors,TRACK_ANCHOR_S);
+}
+
+// Same kernels as the native benchmark (pio run -e bench), same synthetic
+// satellites and QTH, so the JSON line compares directly. Blocks loop()
+// for tens of seconds ("bench quick": a few seconds).
+void runDeviceBench(bool quick){
+  static BenchResult res[BENCH_MAX_RESULTS];
+  static char json[6144];
+  BenchConfig cfg;
+  benchDefaults(cfg,quick);
+  Serial.printf("[BENCH] running (%s)...\n",quick?"quick":"full");
+  int n=runBenchSuite(cfg,res,BENCH_MAX_RESULTS);
+  benchJson(json,sizeof(json),res,n,nullptr);
+  Serial.println(json);
+}
+
+// float coarse scan vs all-double, 12 satellites over 24 h
+void runDevicePrecisionCheck(){
+  static char json[768];
+  static PrecisionReport rep;
+  BenchConfig cfg;
+  benchDefaults(cfg,false);
+  Serial.println("[BENCH] precision check...");
+  runPrecisionCheck(cfg,12,rep);
+  precisionJson(json,sizeof(json),rep,nullptr);
+  Serial.println(json);
+}
+
+// sgp4Propagate() vs the built-in Vallado vectors
+void runDeviceSgp4Verify(){
+  static char json[512];
+  const char* const* l1;
+  const char* const* l2;
+  const Sgp4Vector* vec;
+  int nVec;
+  int nTle=sgp4VerBuiltin(l1,l2,vec,nVec);
+  Sgp4VerifyReport rep;
+  runSgp4Verify(l1,l2,nTle,vec,nVec,rep);
+  sgp4VerifyJson(json,sizeof(json),rep,nullptr);
+  Serial.println(json);
 }
 
 // ====================== SERIAL CMD ======================
@@ -716,6 +1900,27 @@ void processCommand(const String &cmd){
     time_t nowUtc=time(nullptr);
     predictPasses(nowUtc);
   }
+  else if(cmd.equalsIgnoreCase("prefilter on")||cmd.equalsIgnoreCase("prefilter off")){
+    g_passPrefilter=cmd.endsWith("on");
+    Serial.printf("[PRED] prefilter %s\n",g_passPrefilter?"on":"off");
+    predictPasses(time(nullptr));
+  }
+  else if(cmd.equalsIgnoreCase("stats")){
+    printPredStats();
+  }
+  else if(cmd.equalsIgnoreCase("bench")||cmd.equalsIgnoreCase("bench quick")){
+    runDeviceBench(cmd.endsWith("quick"));
+  }
+  else if(cmd.equalsIgnoreCase("bench precision")){
+    runDevicePrecisionCheck();
+  }
+  else if(cmd.equalsIgnoreCase("bench sgp4")){
+    runDeviceSgp4Verify();
+  }
+  else if(cmd.equalsIgnoreCase("track on")||cmd.equalsIgnoreCase("track off")){
+    g_trackLog=cmd.endsWith("on");
+    Serial.printf("[TRACK] serial output %s\n",g_trackLog?"on":"off");
+  }
 }
 
 // ====================== TRAIL ======================
@@ -725,28 +1930,45 @@ void computePassTrack(int passIdx){
   clearTrail();
   if(passIdx<0||passIdx>=g_passCount) return;
 
-  const PassInfo &p=g_passes[passIdx];
-  int si=p.satIdx;
-  time_t aos=p.aos, los=p.los, dur=los-aos;
-  if(dur<=0) return;
-
-  double step=dur/(double)TRAIL_LEN; if(step<5) step=5;
-
+  const PassInfo p=passAt(passIdx);
+  float azs[TRAIL_LEN], els[TRAIL_LEN];
   int n=0;
-  for(int i=0;i<TRAIL_LEN;i++){
-    time_t t=aos+(time_t)(i*step);
-    if(t>los) break;
-    SatState s=computeSatellite(si,t);
-    double r=constrain(90-s.el,0,90);
-    double az=radians(s.az);
+  const ChebEphem* e=satEphem(p.satIdx);
+  if(e && chebCovers(*e,(double)p.aos) && chebCovers(*e,(double)p.los)){
+    n=samplePassTrack(*e,g_qthFrame,p.aos,p.los,azs,els,TRAIL_LEN);
+    g_ephemEvals+=n;
+  } else if(const Sgp4Elements* sat=satPropagator(p.satIdx)){
+    n=samplePassTrack(*sat,g_qthFrame,p.aos,p.los,azs,els,TRAIL_LEN);
+    g_propCalls+=n;
+  }
+
+  for(int i=0;i<n;i++){
+    double r=constrain(90-els[i],0,90);
+    double az=radians(azs[i]);
     double kr=(r/90.0)*RADAR_R;
     int x=RADAR_CX+(int)(kr*sin(az));
     int y=RADAR_CY-(int)(kr*cos(az));
-    g_trail[i]={x,y,true}; n++;
+    g_trail[i]={x,y,true};
   }
   g_trailCount=n; g_trailPassIdx=passIdx;
 }
 
+void drawGeoMarks(){
+  tft.setTextFont(1);
+  tft.setTextColor(TFT_MAGENTA,TFT_BLACK);
+  for(int k=0;k<g_geoMarkCount;k++){
+    const GeoMark &m=g_geoMarks[k];
+    double r=constrain(90-m.el,0,90);
+    double az=radians(m.az);
+    double kr=(r/90.0)*RADAR_R;
+    int x=RADAR_CX+(int)(kr*sin(az));
+    int y=RADAR_CY-(int)(kr*cos(az));
+    tft.drawRect(x-3,y-3,7,7,TFT_MAGENTA);
+    tft.setCursor(x+5,y-3);
+    tft.print(g_sats[m.satIdx].shortName);
+  }
+}
+
 void drawTrail(){
   tft.setTextFont(1);
   for(int i=1;i<g_trailCount;i++)
@@ -755,6 +1977,10 @@ void drawTrail(){
 }
 
 // ====================== DISPLAY BASE ======================
+// tečka sledovaného satelitu na radaru, viz drawTrackDot()
+int  g_dotX = 0, g_dotY = 0;
+bool g_dotShown = false;
+
 void drawRadarBase(){
   tft.drawCircle(RADAR_CX,RADAR_CY,RADAR_R,DARKGREY);
   tft.drawCircle(RADAR_CX,RADAR_CY,RADAR_R*2/3,DARKGREY);
@@ -808,6 +2034,7 @@ void drawStaticFrame(){
   tft.setTextColor(TFT_CYAN,TFT_BLACK);
   tft.setCursor(10,10);
   tft.print("SAT TRACKER");
+  g_dotShown=false;
   drawRadarBase();
   drawIpFsFooter();
 }
@@ -834,7 +2061,7 @@ void drawPassList(time_t nowUtc){
 
   int y=90, shown=0;
   for(int i=0;i<g_passCount && shown<7;i++){
-    const PassInfo &p=g_passes[i];
+    const PassInfo p=passAt(i);
     if(p.los<=nowUtc) continue;
 
     tm a,l; localtime_r(&p.aos,&a); localtime_r(&p.los,&l);
@@ -850,10 +2077,20 @@ void drawPassList(time_t nowUtc){
     y+=13; shown++;
   }
 
+  // GEO: stálé nasměrování místo průletů
+  for(int k=0;k<g_geoMarkCount && shown<8;k++){
+    const GeoMark &m=g_geoMarks[k];
+    tft.setTextColor(TFT_MAGENTA,TFT_BLACK);
+    tft.setCursor(10,y);
+    tft.printf("  %s GEO az %3.0f° el %2.0f°",g_sats[m.satIdx].shortName,m.az,m.el);
+    y+=13; shown++;
+  }
+
   if(shown==0){
     tft.setCursor(10,y);
     useFontMedium();
     if(g_gpsEnabled && !g_gpsHasFix) tft.print("Waiting for GPS...");
+    else if(predictBusy()) tft.print("Computing passes...");
     else tft.print("No passes.");
   }
 }
@@ -863,7 +2100,43 @@ float dopplerFactorFromRangeRate(float rangeRateKmS){
   return 1.0f-(rangeRateKmS/C_KM_S);
 }
 
-void drawSatState(int satIdx,const SatState& s,const tm& tmLocal,float rangeRateKmS){
+// radar pixel of az/el; false below minEl (no dot)
+bool radarDotXY(float azDeg,float elDeg,int &x,int &y){
+  if(elDeg<=g_minElDeg) return false;
+  double r=constrain(90-elDeg,0,90);
+  double az=radians(azDeg);
+  double kr=(r/90.0)*RADAR_R;
+  x=RADAR_CX+(int)(kr*sin(az));
+  y=RADAR_CY-(int)(kr*cos(az));
+  return true;
+}
+
+void drawRadarDot(float azDeg,float elDeg){
+  int x,y;
+  if(!radarDotXY(azDeg,elDeg,x,y)) return;
+  tft.fillCircle(x,y,5,TFT_GREEN);
+  g_dotX=x; g_dotY=y; g_dotShown=true;
+}
+
+// Moves the dot between the 1 s redraws of drawSatState(): only when it
+// changes pixel, the old dot is erased and the rings, trail and GEO marks
+// under it drawn again.
+void drawTrackDot(const TrackLook &l){
+  int x,y;
+  bool show=radarDotXY(l.az,l.el,x,y);
+  if(show && g_dotShown && x==g_dotX && y==g_dotY) return;
+  if(!show && !g_dotShown) return;
+  if(g_dotShown){
+    tft.fillCircle(g_dotX,g_dotY,5,TFT_BLACK);
+    g_dotShown=false;
+    drawRadarBase();
+    drawTrail();
+    drawGeoMarks();
+  }
+  if(show) drawRadarDot(l.az,l.el);
+}
+
+void drawSatState(int satIdx,SatState& s,time_t nowUtc,const tm& tmLocal,float rangeRateKmS){
   tft.fillRect(50,60,140,120,TFT_BLACK);
   useFontMedium();
   tft.setTextColor(TFT_GREEN,TFT_BLACK);
@@ -874,9 +2147,10 @@ void drawSatState(int satIdx,const SatState& s,const tm& tmLocal,float rangeRate
   tft.setTextColor(TFT_WHITE,TFT_BLACK);
   tft.setCursor(50,100); tft.printf("%.0f km",s.distKm);
   tft.setCursor(50,120);
-  if(s.vis==-2) tft.print("BELOW");
-  else if(s.vis==-1) tft.print("DAY");
-  else if(s.vis==0) tft.print("DIM");
+  int vis=satStateVis(satIdx,nowUtc,s);
+  if(vis==SAT_VIS_BELOW) tft.print("BELOW");
+  else if(vis==SAT_VIS_DAY) tft.print("DAY");
+  else if(vis==SAT_VIS_ECLIPSED) tft.print("DIM");
   else tft.print("BRIGHT");
 
   tft.fillRect(50,140,140,20,TFT_BLACK);
@@ -894,17 +2168,11 @@ void drawSatState(int satIdx,const SatState& s,const tm& tmLocal,float rangeRate
   tft.print(g_sats[satIdx].name);
 
   tft.fillCircle(RADAR_CX,RADAR_CY,RADAR_R-2,TFT_BLACK);
+  g_dotShown=false;
   drawRadarBase();
   drawTrail();
-
-  if(s.el>g_minElDeg){
-    double r=constrain(90-s.el,0,90);
-    double az=radians(s.az);
-    double kr=(r/90.0)*RADAR_R;
-    int x=RADAR_CX+(int)(kr*sin(az));
-    int y=RADAR_CY-(int)(kr*cos(az));
-    tft.fillCircle(x,y,5,TFT_GREEN);
-  }
+  drawGeoMarks();
+  drawRadarDot(s.az,s.el);
 
   float dopRx=1.0f,dopTx=1.0f;
   if(g_dopplerEnabled){
@@ -1080,19 +2348,13 @@ void handleAddSat(){
   SatConfig &s = g_sats[SAT_COUNT];
   memset(&s,0,sizeof(SatConfig));
 
-  String id = makeCustomId();
-  id.toCharArray(g_customIdBuf[SAT_COUNT],sizeof(g_customIdBuf[SAT_COUNT]));
-  name.toCharArray(g_customShortBuf[SAT_COUNT],sizeof(g_customShortBuf[SAT_COUNT]));
-  name.toCharArray(g_customDefBuf[SAT_COUNT],sizeof(g_customDefBuf[SAT_COUNT]));
-  tle.toCharArray(g_customUrlBuf[SAT_COUNT],sizeof(g_customUrlBuf[SAT_COUNT]));
-
-  s.id = g_customIdBuf[SAT_COUNT];
-  s.shortName = g_customShortBuf[SAT_COUNT];
-  s.defaultName = g_customDefBuf[SAT_COUNT];
-  s.tleUrl = g_customUrlBuf[SAT_COUNT];
+  if(!setCustomText(SAT_COUNT,makeCustomId(),name,name,tle)){
+    server.send(500,"text/plain","Out of memory.");
+    return;
+  }
 
   strncpy(s.name, s.defaultName, sizeof(s.name));
-  s.l1[0]='\0'; s.l2[0]='\0';
+  s.tle.valid=false;
   s.rxFreqMHz = rx;
   s.txFreqMHz = tx;
   s.enabled   = false;
@@ -1172,7 +2434,20 @@ void handleGpsPos(){
   server.send(200, "application/json", json);
 }
 
+// handleRoot() posílá stránku po částech (se 128 satelity by se celá
+// nevešla do jednoho Stringu)
+const unsigned HTML_CHUNK = 2048;
+
+void sendHtmlChunk(String &html, bool force=false){
+  if(!force && html.length()<HTML_CHUNK) return;
+  if(html.length()>0) server.sendContent(html);
+  html="";
+}
+
 void handleRoot(){
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200,"text/html","");
+
   String html=F(
     "<!DOCTYPE html><html><head><meta charset='utf-8'>"
     "<title>Sat Tracker</title><style>"
@@ -1180,7 +2455,9 @@ void handleRoot(){
     "h1{color:#0ff;}label{display:inline-block;width:110px;}"
     ".box{border:1px solid #444;padding:10px;margin-bottom:15px;border-radius:6px;background:#181818;}"
     "input[type=text]{width:140px;background:#222;border:1px solid #555;color:#eee;padding:2px 4px;}"
-    ".satlist label{width:auto;margin-right:10px;}"
+    ".satlist table{border-collapse:collapse;}"
+    ".satlist td,.satlist th{padding:1px 8px;text-align:left;}"
+    ".satlist th{color:#0aa;font-weight:normal;}"
     "button{padding:6px 12px;border-radius:4px;border:1px solid #0aa;background:#033;color:#0ff;cursor:pointer;}"
     "button:hover{background:#055;}"
     "select{background:#222;border:1px solid #555;color:#eee;padding:2px 4px;}"
@@ -1200,7 +2477,13 @@ void handleRoot(){
   html+=String(g_qthAlt,1); html+=F("'> m<br>");
 
   html+=F("<label>Min. elev:</label><input type='text' name='minel' value='");
-  html+=String(g_minElDeg,1); html+=F("'> &deg;<br>");
+  html+=String(g_minElDeg,1);
+  html+=F("'> &deg; <button type='button' "
+          "onclick=\"location='/passes?minel='+encodeURIComponent(this.form.minel.value)\">"
+          "Preview</button><br>");
+
+  html+=F("<label>Pass window:</label><input type='text' name='window' value='");
+  html+=String(g_passWindowH); html+=F("'> h (max 168)<br>");
 
   html+=F("<label>WiFi SSID:</label><input type='text' name='wifi_ssid' value='");
   html+=htmlEscape(String(g_wifiSsid)); html+=F("'><br>");
@@ -1243,30 +2526,73 @@ void handleRoot(){
   else html+=F("OK");
   html+=F("</p>");
 
+  int enabledCount=enabledSatCount();
+
   html+=F("</div><div class='box'><h2>Satellites</h2><div class='satlist'>");
+  html+=F("<p>Enabled: <b id='satcnt'>"); html+=String(enabledCount);
+  html+=F("</b> / "); html+=String(MAX_SATS_SELECTED);
+  html+=F(" &nbsp;<button type='button' onclick='satAll(true)'>All</button>"
+          " <button type='button' onclick='satAll(false)'>None</button>");
+  if(predictBusy()) html+=F(" &nbsp;<i>computing passes...</i>");
+  html+=F("</p><table><tr><th></th><th>Satellite</th><th>RX MHz</th><th>TX MHz</th>"
+          "<th>Passes</th><th>CPU ms</th><th>SGP4 calls</th><th></th></tr>");
 
   for(int i=0;i<SAT_COUNT;i++){
-    html+="<label><input type='checkbox' name='sat_"; html+=g_sats[i].id; html+="'";
+    const SatPredStats &st=g_satStats[i];
+    html+="<tr><td><input type='checkbox' class='sat' name='sat_"; html+=g_sats[i].id; html+="'";
     if(g_sats[i].enabled) html+=" checked";
-    html+="> "; html+=htmlEscape(g_sats[i].shortName);
+    html+="></td><td>"; html+=htmlEscape(g_sats[i].shortName);
     html+=" ("; html+=htmlEscape(g_sats[i].defaultName); html+=")";
-    html+=" RX:"; html+=(g_sats[i].rxFreqMHz>0)?String(g_sats[i].rxFreqMHz,3):"-";
-    html+="MHz TX:"; html+=(g_sats[i].txFreqMHz>0)?String(g_sats[i].txFreqMHz,3):"-";
-    html+="MHz</label>";
-
+    if(!g_sats[i].tle.valid) html+=" <i>no TLE</i>";
+    html+="</td><td>"; html+=(g_sats[i].rxFreqMHz>0)?String(g_sats[i].rxFreqMHz,3):"-";
+    html+="</td><td>"; html+=(g_sats[i].txFreqMHz>0)?String(g_sats[i].txFreqMHz,3):"-";
+    html+="</td>";
+    if(st.jobs>0){
+      html+="<td>"+String(st.passes)+"</td><td>"+String(st.us/1000.0f,1)+"</td><td>"+String((unsigned long)st.calls)+"</td>";
+    } else {
+      html+="<td>-</td><td>-</td><td>-</td>";
+    }
+    html+="<td>";
     if(g_sats[i].isCustom){
-      html+=" <button type='submit' name='i' value='"+String(i)+"' "
-            "formaction='/sat/del' formmethod='POST' "
-            "style='margin-left:6px'>Delete</button>";
+      html+="<button type='submit' name='i' value='"+String(i)+"' "
+            "formaction='/sat/del' formmethod='POST'>Delete</button>";
     }
-    html+="<br>";
-  }
-
-  int enabledCount=0;
-  for(int i=0;i<SAT_COUNT;i++) if(g_sats[i].enabled) enabledCount++;
-  if(enabledCount>MAX_SATS_SELECTED){
-    html+=F("<p style='color:#f66'>Warning: more than 4 satellites selected, extra will be disabled on save.</p>");
+    html+="</td></tr>";
+    sendHtmlChunk(html);
   }
+  html+=F("</table>");
+  html+=F("<p>SGP4 pool: "); html+=String(SGP4_POOL_SIZE);
+  html+=F(" propagators, "); html+=String(sgp4PoolHitPct(),1);
+  html+=F(" % hits ("); html+=String((unsigned long)g_sgp4PoolHits);
+  html+=F(" / "); html+=String((unsigned long)g_sgp4PoolMisses);
+  html+=F(" init)</p>");
+  int ephemReady=0;
+  for(const EphemSlot &sl:g_ephem) if(sl.ready) ephemReady++;
+  html+=F("<p>Ephemeris: "); html+=String(ephemReady);
+  html+=F(" / "); html+=String(EPHEM_SLOTS);
+  html+=F(" satellites fitted, "); html+=String((unsigned long)g_ephemEvals);
+  html+=F(" live/trail + "); html+=String((unsigned long)g_optEvals);
+  html+=F(" optical evaluations without SGP4</p>");
+  int profSats=0;
+  for(int si=0;si<SAT_COUNT;si++) if(g_sats[si].enabled && profileCovers(si)) profSats++;
+  html+=F("<p>Elevation profiles: "); html+=String(profSats);
+  html+=F(" satellites, "); html+=String(g_prof.arcCount);
+  html+=F(" passes in "); html+=String(g_prof.sampleCount);
+  html+=F(" / "); html+=String(PROFILE_SAMPLES_MAX);
+  html+=F(" samples (Min. elev changes without recalculation)</p>");
+
+  // varování podle zaškrtnutých boxů, stejné pravidlo jako enforceSatCap()
+  html+=F("<p id='satwarn' style='color:#f66;display:");
+  html+=enabledCount>MAX_SATS_SELECTED?F("block"):F("none");
+  html+=F("'>Warning: more than "); html+=String(MAX_SATS_SELECTED);
+  html+=F(" satellites selected, extra will be disabled on save.</p>");
+  html+=F("<script>var satMax="); html+=String(MAX_SATS_SELECTED);
+  html+=F(";function satCnt(){var n=document.querySelectorAll('input.sat:checked').length;"
+          "document.getElementById('satcnt').textContent=n;"
+          "document.getElementById('satwarn').style.display=n>satMax?'block':'none';}"
+          "function satAll(v){document.querySelectorAll('input.sat').forEach(c=>c.checked=v);satCnt();}"
+          "document.querySelectorAll('input.sat').forEach(c=>c.addEventListener('change',satCnt));"
+          "</script>");
 
   html+=F("</div></div><button type='submit'>Save &amp; recalculate</button></form>");
 
@@ -1290,7 +2616,7 @@ void handleRoot(){
     int shown=0;
     time_t nowUtc=time(nullptr);
     for(int i=0;i<g_passCount && shown<7;i++){
-      const PassInfo &p=g_passes[i];
+      const PassInfo p=passAt(i);
       if(p.los<=nowUtc) continue;
 
       tm a,l; localtime_r(&p.aos,&a); localtime_r(&p.los,&l);
@@ -1309,6 +2635,11 @@ void handleRoot(){
       shown++;
     }
     if(shown==0) html += F("<i>No upcoming passes.</i><br>");
+    html += F("<p><a href='/passes'>All ");
+    html += String(g_passCount);
+    html += F(" passes</a> (next ");
+    html += String(g_passWindowH);
+    html += F(" h) &middot; <a href='/passes?csv=1'>CSV</a></p>");
   } else {
     html += F("<i>Waiting for time / TLE...</i><br>");
   }
@@ -1365,7 +2696,234 @@ void handleRoot(){
   html+=F("<br>WiFi STA SSID: "); html+=htmlEscape(String(g_wifiSsid));
   html+=F("</div></body></html>");
 
-  server.send(200,"text/html",html);
+  sendHtmlChunk(html,true);
+  server.sendContent("");
+}
+
+// Full pass list for the whole window (up to MAX_PASSES rows), streamed in
+// chunks. ?csv=1 gives UTC times for planning tools.
+// /passes?optical=1: only the visible parts of the stored passes (sunlit
+// satellite, QTH in darkness), from the records of opticalStep().
+void handleOpticalPasses(bool csv){
+  String out;
+  if(csv){
+    out=F("sat,aos_utc,los_utc,vis_start_utc,vis_end_utc,vis_peak_utc,peak_el,peak_mag,class\n");
+  } else {
+    out=F("<!DOCTYPE html><html><head><meta charset='utf-8'><title>Optical passes</title><style>"
+          "body{font-family:sans-serif;background:#111;color:#eee;margin:20px;}"
+          "h1{color:#0ff;}a{color:#0ff;}table{border-collapse:collapse;}"
+          "td,th{padding:2px 10px;text-align:right;}th{color:#0aa;font-weight:normal;}"
+          "td:first-child,th:first-child{text-align:left;}"
+          "</style></head><body><h1>Optical passes</h1><p><a href='/'>Back</a> &middot; "
+          "<a href='/passes'>All passes</a> &middot; <a href='/passes?optical=1&csv=1'>CSV</a></p>");
+    if(predictBusy()) out+=F("<p><i>Computing passes...</i></p>");
+    else if(opticalPending(time(nullptr))>0) out+=F("<p><i>Computing optical windows...</i></p>");
+    out+=F("<table><tr><th>Satellite</th><th>Date</th><th>Visible</th><th>Until</th>"
+           "<th>Peak</th><th>Peak el</th><th>Mag</th><th>Class</th></tr>");
+  }
+
+  time_t nowUtc=time(nullptr);
+  for(int i=0;i<g_passCount;i++){
+    const PassInfo p=passAt(i);
+    if(p.los<=nowUtc) continue;
+    OpticalWindow w[OPT_WINDOWS_MAX];
+    int k=0;
+    for(int r=optFind(g_passes[i].aosOff,p.satIdx);
+        r<g_optCount && k<OPT_WINDOWS_MAX && g_opt[r].aosOff==g_passes[i].aosOff;r++)
+      if(g_opt[r].satIdx==p.satIdx) w[k++]=optRecWindow(g_opt[r]);
+    for(int j=0;j<k;j++){
+      char row[224];
+      if(csv){
+        tm a,l,ws,we,wp;
+        gmtime_r(&p.aos,&a); gmtime_r(&p.los,&l);
+        gmtime_r(&w[j].start,&ws); gmtime_r(&w[j].end,&we); gmtime_r(&w[j].peak,&wp);
+        char sa[24],sl[24],s1[24],s2[24],s3[24];
+        strftime(sa,sizeof(sa),"%Y-%m-%dT%H:%M:%SZ",&a);
+        strftime(sl,sizeof(sl),"%Y-%m-%dT%H:%M:%SZ",&l);
+        strftime(s1,sizeof(s1),"%Y-%m-%dT%H:%M:%SZ",&ws);
+        strftime(s2,sizeof(s2),"%Y-%m-%dT%H:%M:%SZ",&we);
+        strftime(s3,sizeof(s3),"%Y-%m-%dT%H:%M:%SZ",&wp);
+        snprintf(row,sizeof(row),"%s,%s,%s,%s,%s,%s,%.1f,%.1f,%s\n",
+                 g_sats[p.satIdx].id,sa,sl,s1,s2,s3,w[j].peakEl,w[j].peakMag,
+                 opticalClassName(w[j].cls));
+        out+=row;
+      } else {
+        tm ws,we,wp; localtime_r(&w[j].start,&ws); localtime_r(&w[j].end,&we); localtime_r(&w[j].peak,&wp);
+        out+=F("<tr><td>"); out+=htmlEscape(g_sats[p.satIdx].shortName);
+        snprintf(row,sizeof(row),
+                 "</td><td>%02d.%02d.</td><td>%02d:%02d:%02d</td><td>%02d:%02d:%02d</td>"
+                 "<td>%02d:%02d:%02d</td><td>%.0f&deg;</td><td>%.1f</td><td>%s</td></tr>",
+                 ws.tm_mday,ws.tm_mon+1,ws.tm_hour,ws.tm_min,ws.tm_sec,
+                 we.tm_hour,we.tm_min,we.tm_sec,wp.tm_hour,wp.tm_min,wp.tm_sec,
+                 w[j].peakEl,w[j].peakMag,opticalClassName(w[j].cls));
+        out+=row;
+      }
+    }
+    sendHtmlChunk(out);
+  }
+  if(!csv) out+=F("</table></body></html>");
+
+  sendHtmlChunk(out,true);
+  server.sendContent("");
+}
+
+void addPassRow(String &out, const PassInfo &p, bool csv){
+  char row[192];
+  if(csv){
+    tm a,l,m; gmtime_r(&p.aos,&a); gmtime_r(&p.los,&l); gmtime_r(&p.tMax,&m);
+    char sa[24],sl[24],sm[24];
+    strftime(sa,sizeof(sa),"%Y-%m-%dT%H:%M:%SZ",&a);
+    strftime(sl,sizeof(sl),"%Y-%m-%dT%H:%M:%SZ",&l);
+    strftime(sm,sizeof(sm),"%Y-%m-%dT%H:%M:%SZ",&m);
+    snprintf(row,sizeof(row),"%s,%s,%s,%s,%.1f,%.0f,%.0f,%.0f\n",
+             g_sats[p.satIdx].id,sa,sl,sm,p.maxEl,p.aosAz,p.maxAz,p.losAz);
+    out+=row;
+  } else {
+    tm a,l; localtime_r(&p.aos,&a); localtime_r(&p.los,&l);
+    out+=F("<tr><td>"); out+=htmlEscape(g_sats[p.satIdx].shortName);
+    snprintf(row,sizeof(row),
+             "</td><td>%02d.%02d.</td><td>%02d:%02d:%02d</td><td>%02d:%02d:%02d</td>"
+             "<td>%.0f&deg;</td><td>%.0f&deg;</td><td>%.0f&deg;</td><td>%.0f&deg;</td></tr>",
+             a.tm_mday,a.tm_mon+1,a.tm_hour,a.tm_min,a.tm_sec,
+             l.tm_hour,l.tm_min,l.tm_sec,p.maxEl,p.aosAz,p.maxAz,p.losAz);
+    out+=row;
+  }
+}
+
+int cmpPassRecAos(const void* a, const void* b){
+  uint32_t x=((const PassRec*)a)->aosOff, y=((const PassRec*)b)->aosOff;
+  return x<y?-1:(x>y?1:0);
+}
+
+// /passes?minel=X: the pass list at another minEl, derived from the
+// elevation profiles without SGP4. Nothing is saved and the table stays;
+// satellites without a profile yet are left out and counted.
+void handlePreviewPasses(bool csv, float minEl){
+  static bool use[MAX_SATS_TOTAL];
+  time_t nowUtc=time(nullptr);
+  const time_t endUtc=nowUtc+(time_t)g_passWindowH*3600;
+  if(minEl<0) minEl=0;
+  if(minEl>90) minEl=90;
+
+  int sats=0, missing=0, n=0;
+  bool truncated=false;
+  PassRec* list=nullptr;
+  const bool valid=g_prof.arcs && g_prof.qthKey==profileQthKey();
+  if(valid) list=(PassRec*)malloc(MAX_PASSES*sizeof(PassRec));
+  for(int si=0;si<MAX_SATS_TOTAL;si++){
+    use[si]=false;
+    if(si>=SAT_COUNT || !g_sats[si].enabled || !g_sats[si].tle.valid) continue;
+    use[si]=list && profileCovers(si);
+    if(use[si]) sats++; else missing++;
+  }
+  // oblouky nejsou seřazené podle AOS: list je max-halda na AOS, plná
+  // vyhodí nejpozdější průlet, takže zůstane MAX_PASSES nejdřívějších
+  uint32_t us0=micros();
+  for(int a=0;list && a<g_prof.arcCount;a++){
+    if(!use[g_prof.arcs[a].satIdx]) continue;
+    PassInfo p[PASS_JOB_MAX];
+    int k=profileArcPasses(a,minEl,nowUtc,p);
+    for(int i=0;i<k;i++){
+      if(p[i].aos>=endUtc) continue;
+      PassRec r=encodePass(p[i],g_prof.base);
+      int c;
+      if(n<MAX_PASSES){
+        // sift up
+        c=n++;
+        while(c>0 && list[(c-1)/2].aosOff<r.aosOff){ list[c]=list[(c-1)/2]; c=(c-1)/2; }
+      } else {
+        truncated=true;
+        if(r.aosOff>=list[0].aosOff) continue;
+        // nahradí nejpozdější, sift down
+        c=0;
+        while(true){
+          int l=2*c+1;
+          if(l>=n) break;
+          if(l+1<n && list[l+1].aosOff>list[l].aosOff) l++;
+          if(list[l].aosOff<=r.aosOff) break;
+          list[c]=list[l]; c=l;
+        }
+      }
+      list[c]=r;
+    }
+  }
+  if(n>1) qsort(list,n,sizeof(PassRec),cmpPassRecAos);
+  uint32_t us=micros()-us0;
+
+  String out;
+  if(csv){
+    out=F("sat,aos_utc,los_utc,tmax_utc,max_el,aos_az,max_az,los_az\n");
+  } else {
+    char info[160];
+    out=F("<!DOCTYPE html><html><head><meta charset='utf-8'><title>Passes preview</title><style>"
+          "body{font-family:sans-serif;background:#111;color:#eee;margin:20px;}"
+          "h1{color:#0ff;}a{color:#0ff;}table{border-collapse:collapse;}"
+          "td,th{padding:2px 10px;text-align:right;}th{color:#0aa;font-weight:normal;}"
+          "td:first-child,th:first-child{text-align:left;}"
+          "</style></head><body><h1>Passes preview</h1><p><a href='/'>Back</a> &middot; "
+          "<a href='/passes'>Saved passes</a> &middot; <a href='/passes?csv=1&minel=");
+    out+=String(minEl,1);
+    out+=F("'>CSV</a></p><form method='GET' action='/passes'>Min. elev: "
+           "<input type='text' name='minel' size='4' value='");
+    out+=String(minEl,1);
+    out+=F("'> &deg; <button type='submit'>Preview</button></form>");
+    snprintf(info,sizeof(info),"<p>%d passes from the elevation profiles of %d satellites "
+             "in %lu us, not saved.",n,sats,(unsigned long)us);
+    out+=info;
+    if(missing>0){ out+=F(" "); out+=String(missing); out+=F(" satellites have no profile yet."); }
+    if(truncated){ out+=F(" Only the first "); out+=String(MAX_PASSES); out+=F(" shown."); }
+    out+=F("</p><table><tr><th>Satellite</th><th>Date</th><th>AOS</th><th>LOS</th>"
+           "<th>Max</th><th>AOS az</th><th>Max az</th><th>LOS az</th></tr>");
+  }
+  for(int i=0;i<n;i++){
+    addPassRow(out,decodePass(list[i],g_prof.base),csv);
+    sendHtmlChunk(out);
+  }
+  free(list);
+  if(!csv) out+=F("</table></body></html>");
+
+  sendHtmlChunk(out,true);
+  server.sendContent("");
+}
+
+void handlePasses(){
+  const bool csv=server.hasArg("csv");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200,csv?"text/csv":"text/html","");
+  if(server.hasArg("optical")){ handleOpticalPasses(csv); return; }
+  if(server.hasArg("minel")){ handlePreviewPasses(csv,server.arg("minel").toFloat()); return; }
+
+  String out;
+  if(csv){
+    out=F("sat,aos_utc,los_utc,tmax_utc,max_el,aos_az,max_az,los_az\n");
+  } else {
+    out=F("<!DOCTYPE html><html><head><meta charset='utf-8'><title>Passes</title><style>"
+          "body{font-family:sans-serif;background:#111;color:#eee;margin:20px;}"
+          "h1{color:#0ff;}a{color:#0ff;}table{border-collapse:collapse;}"
+          "td,th{padding:2px 10px;text-align:right;}th{color:#0aa;font-weight:normal;}"
+          "td:first-child,th:first-child{text-align:left;}"
+          "</style></head><body><h1>Passes</h1><p><a href='/'>Back</a> &middot; "
+          "<a href='/passes?csv=1'>CSV</a> &middot; <a href='/passes?optical=1'>Optical</a></p>"
+          "<form method='GET' action='/passes'>Preview min. elev: "
+          "<input type='text' name='minel' size='4' value='");
+    out+=String(g_minElDeg,1);
+    out+=F("'> &deg; <button type='submit'>Preview</button></form>");
+    if(predictBusy()) out+=F("<p><i>Computing passes...</i></p>");
+    out+=F("<table><tr><th>Satellite</th><th>Date</th><th>AOS</th><th>LOS</th>"
+           "<th>Max</th><th>AOS az</th><th>Max az</th><th>LOS az</th></tr>");
+  }
+
+  time_t nowUtc=time(nullptr);
+  for(int i=0;i<g_passCount;i++){
+    const PassInfo p=passAt(i);
+    if(p.los<=nowUtc) continue;
+    addPassRow(out,p,csv);
+    sendHtmlChunk(out);
+  }
+  if(!csv) out+=F("</table></body></html>");
+
+  sendHtmlChunk(out,true);
+  server.sendContent("");
 }
 
 void handleConfig(){
@@ -1374,6 +2932,8 @@ void handleConfig(){
   if(server.hasArg("lon")) g_qthLon=server.arg("lon").toFloat();
   if(server.hasArg("alt")) g_qthAlt=server.arg("alt").toFloat();
   if(server.hasArg("minel")) g_minElDeg=server.arg("minel").toFloat();
+  if(server.hasArg("window"))
+    g_passWindowH=(uint16_t)constrain((int)server.arg("window").toInt(),1,(int)PASS_WINDOW_MAX_H);
 
   if(server.hasArg("wifi_ssid")){
     String s=server.arg("wifi_ssid"); s.trim();
@@ -1407,23 +2967,16 @@ void handleConfig(){
     String argName=String("sat_")+g_sats[i].id;
     g_sats[i].enabled=server.hasArg(argName);
   }
-
-  int en=0;
-  for(int i=0;i<SAT_COUNT;i++){
-    if(g_sats[i].enabled){
-      en++;
-      if(en>MAX_SATS_SELECTED){
-        g_sats[i].enabled=false;
-      }
-    }
-  }
+  enforceSatCap();
 
   saveConfig();
   updateSatSites();
   updateLocatorFromQth();
 
+  // stejné QTH: nový práh z profilů, bez SGP4
   if(g_haveTime){
-    predictPasses(time(nullptr));
+    time_t nowUtc=time(nullptr);
+    if(!rethresholdPasses(nowUtc)) predictPasses(nowUtc);
     g_passesInitByTime=true;
   }
 
@@ -1492,7 +3045,7 @@ void setup(){
 
   if(g_haveTime){
     splashStatus("Computing passes...");
-    predictPasses(time(nullptr));
+    restorePasses(time(nullptr));
     g_passesInitByTime=true;
   } else {
     splashStatus("Waiting for time (NTP/GPS)...");
@@ -1505,6 +3058,7 @@ void setup(){
   server.on("/sat/del",HTTP_POST,handleDelSat);
   server.on("/gpsraw",HTTP_GET,handleGpsRaw);
   server.on("/gpspos",HTTP_GET,handleGpsPos);   // NEW
+  server.on("/passes",HTTP_GET,handlePasses);
   server.begin();
 
   splashStatus("Done.");
@@ -1526,10 +3080,19 @@ void loop(){
 
   time_t nowUtc=time(nullptr);
 
+  // rozpracovaný výpočet průletů: jen omezený čas na jeden průchod
+  predictStep(PRED_SLICE_MS);
+  // po něm efemeridy satelitů nejbližších průletů
+  ephemStep(nowUtc,EPHEM_SLICE_MS);
+  // optická okna uložených průletů
+  opticalStep(nowUtc,OPT_SLICE_MS);
+  // a profily elevace pro změnu min. elevace bez přepočtu
+  profileStep(nowUtc,PROFILE_SLICE_MS);
+
   // GPS time -> passes jen když NTP není preferované
   if(g_gpsEnabled && !g_ntpPreferred && g_gpsTimeSet && !g_passesInitByGps){
     Serial.println("[AUTO] GPS time valid -> predict passes.");
-    predictPasses(nowUtc);
+    restorePasses(nowUtc);
     g_passesInitByGps=true;
     g_passesInitByTime=true;
     g_lastPassListMinute=-1;
@@ -1540,7 +3103,7 @@ void loop(){
   if(!g_passesInitByTime && nowUtc>1672531200){
     g_haveTime=true;
     Serial.println("[AUTO] NTP time valid (late) -> predict passes.");
-    predictPasses(nowUtc);
+    restorePasses(nowUtc);
     g_passesInitByTime=true;
     g_lastPassListMinute=-1;
     clearTrail();
@@ -1557,6 +3120,20 @@ void loop(){
     } else if(cmdBuf.length()<64) cmdBuf+=c;
   }
 
+  // běžící průlet: tečka na radaru po TRACK_RATE_MS, zbytek obrazovky po 1 s
+  static int trackSi=-1;
+  static unsigned long lastTrack=0;
+  if(trackSi>=0 && g_displayMode==MODE_TRACKER && millis()-lastTrack>=TRACK_RATE_MS){
+    lastTrack=millis();
+    TrackLook l;
+    if(trackSatellite(trackSi,utcNowPrecise(),l)){
+      drawTrackDot(l);
+      if(g_trackLog)
+        Serial.printf("[TRACK] %.1f az %.2f el %.2f rng %.1f rr %.4f\n",
+                      l.t,l.az,l.el,l.rangeKm,l.rangeRate);
+    }
+  }
+
   static unsigned long last=0;
   if(millis()-last<1000) return;
   last=millis();
@@ -1567,21 +3144,27 @@ void loop(){
 
   int active=-1;
   for(int i=0;i<g_passCount;i++){
-    if(nowUtc>=g_passes[i].aos && nowUtc<=g_passes[i].los){
+    if(nowUtc>=passAos(i) && nowUtc<=passLos(i)){
       active=i; break;
     }
   }
 
   static int prevActive=-1;
   if(prevActive>=0 && active<0 && g_haveTime){
-    Serial.println("[AUTO] Pass ended -> recalculating next passes.");
-    predictPasses(nowUtc);
+    Serial.println("[AUTO] Pass ended -> extending pass window.");
+    extendPasses(nowUtc);
     g_lastPassListMinute=-1;
     clearTrail();
     drawStaticFrame();
   }
   prevActive=active;
 
+  if(g_geoMarkMinute!=tmLocal.tm_min && g_haveTime){
+    updateGeoMarks(nowUtc);
+    g_geoMarkMinute=tmLocal.tm_min;
+    g_lastPassListMinute=-1;
+  }
+
   DisplayMode newMode=(active<0)?MODE_LIST:MODE_TRACKER;
   if(newMode!=g_displayMode){
     g_displayMode=newMode;
@@ -1590,6 +3173,7 @@ void loop(){
     clearTrail();
   }
 
+  trackSi=-1;
   if(g_displayMode==MODE_LIST){
     if(g_lastPassListMinute!=tmLocal.tm_min){
       drawPassList(nowUtc);
@@ -1601,13 +3185,17 @@ void loop(){
       if(g_trailPassIdx!=active) computePassTrack(active);
 
       int si=g_passes[active].satIdx;
-      SatState s=computeSatellite(si,nowUtc);
-
+      trackSi=si;
+      // stejný vzorek jako tečka na radaru, range rate z rychlosti
+      TrackLook l;
+      SatState s;
       float rangeRateKmS=0.0f;
-      if(g_prevDistValid[si]) rangeRateKmS=s.distKm-g_prevDistKm[si];
-      g_prevDistKm[si]=s.distKm; g_prevDistValid[si]=true;
+      if(trackSatellite(si,utcNowPrecise(),l)){
+        s={l.az,l.el,l.rangeKm,SAT_VIS_UNKNOWN};
+        rangeRateKmS=l.rangeRate;
+      } else s=computeSatellite(si,nowUtc);
 
-      drawSatState(si,s,tmLocal,rangeRateKmS);
+      drawSatState(si,s,nowUtc,tmLocal,rangeRateKmS);
     }
   }
 }